@@ -146,6 +146,11 @@ ifeq ($(strip $(AUDIO_ENABLE)), yes)
     MUSIC_ENABLE := 1
     SRC += $(QUANTUM_DIR)/process_keycode/process_audio.c
     SRC += $(QUANTUM_DIR)/audio/audio.c
+    SRC += $(QUANTUM_DIR)/audio/synth.c
+    SRC += $(QUANTUM_DIR)/audio/mixer.c
+    SRC += $(QUANTUM_DIR)/audio/song.c
+    SRC += $(QUANTUM_DIR)/audio/adpcm.c
+    SRC += $(QUANTUM_DIR)/audio/sample.c
     SRC += $(QUANTUM_DIR)/audio/voices.c
     SRC += $(QUANTUM_DIR)/audio/luts.c
 endif
@@ -165,6 +170,18 @@ ifeq ($(strip $(COMBO_ENABLE)), yes)
     SRC += $(QUANTUM_DIR)/process_keycode/process_combo.c
 endif
 
+ifeq ($(strip $(STENO_ENABLE)), yes)
+    OPT_DEFS += -DSTENO_ENABLE
+    SRC += $(QUANTUM_DIR)/process_keycode/process_steno.c
+    CHORDING_ENABLE = yes
+    VIRTSER_ENABLE = yes
+endif
+
+ifeq ($(strip $(CHORDING_ENABLE)), yes)
+    OPT_DEFS += -DCHORDING_ENABLE
+    SRC += $(QUANTUM_DIR)/process_keycode/process_chording.c
+endif
+
 ifeq ($(strip $(VIRTSER_ENABLE)), yes)
     OPT_DEFS += -DVIRTSER_ENABLE
 endif
@@ -200,8 +217,18 @@ ifeq ($(strip $(RGBLIGHT_ENABLE)), yes)
     OPT_DEFS += -DRGBLIGHT_ENABLE
     SRC += $(QUANTUM_DIR)/light_ws2812.c
     SRC += $(QUANTUM_DIR)/rgblight.c
+    SRC += $(QUANTUM_DIR)/color.c
+    SRC += $(QUANTUM_DIR)/rgblight_effects.c
     CIE1931_CURVE = yes
     LED_BREATHING_TABLE = yes
+    SRC += $(QUANTUM_DIR)/ws2812_encode.c
+    ifeq ($(strip $(RGBLIGHT_SPI)), yes)
+        OPT_DEFS += -DWS2812_SPI
+    endif
+    ifeq ($(strip $(RGBLIGHT_REACTIVE)), yes)
+        OPT_DEFS += -DRGBLIGHT_REACTIVE
+        SRC += $(QUANTUM_DIR)/rgblight_reactive.c
+    endif
 endif
 
 ifeq ($(strip $(TAP_DANCE_ENABLE)), yes)
@@ -229,6 +256,11 @@ ifneq ($(strip $(MAX_VARIABLE_TRACE_SIZE)),)
 endif
 endif
 
+ifeq ($(strip $(BACKLIGHT_ENABLE)), yes)
+    SRC += $(QUANTUM_DIR)/backlight_pwm.c
+    CIE1931_CURVE = yes
+endif
+
 ifeq ($(strip $(LCD_ENABLE)), yes)
     CIE1931_CURVE = yes
 endif
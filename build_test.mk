@@ -43,6 +43,11 @@ VPATH += $(COMMON_VPATH)
 
 include $(TMK_PATH)/common.mk
 include $(QUANTUM_PATH)/serial_link/tests/rules.mk
+include $(TMK_PATH)/common/tests/rules.mk
+include $(TMK_PATH)/protocol/vusb/tests/rules.mk
+include $(TMK_PATH)/protocol/midi/tests/rules.mk
+include $(QUANTUM_PATH)/tests/rules.mk
+include keyboards/ergodox/infinity/drivers/gdisp/IS31FL3731C/tests/rules.mk
 
 $(TEST_OBJ)/$(TEST)_SRC := $($(TEST)_SRC)
 $(TEST_OBJ)/$(TEST)_INC := $($(TEST)_INC) $(VPATH) $(GTEST_INC)
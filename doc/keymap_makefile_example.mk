@@ -14,7 +14,8 @@ AUDIO_ENABLE = no           # Audio output on port C6
 UNICODE_ENABLE = no         # Unicode
 BLUETOOTH_ENABLE = no       # Enable Bluetooth with the Adafruit EZ-Key HID
 RGBLIGHT_ENABLE = no        # Enable WS2812 RGB underlight.  Do not enable this with audio at the same time.
-SLEEP_LED_ENABLE = no       # Breathing sleep LED during USB suspend
+RGBLIGHT_SPI = no           # Send the underlight from SPI on MOSI (B2 on the ATmega32U4), SS and SCK (B0, B1) can't be used for the matrix then
+SLEEP_LED_ENABLE = no       # Breathing sleep LED during USB suspend, uses timer 1 like a backlight that breathes or is not on B5, B6 or B7
 
 ifndef QUANTUM_DIR
 	include ../../../../Makefile
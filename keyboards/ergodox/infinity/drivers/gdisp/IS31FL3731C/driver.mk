@@ -1,2 +1,3 @@
 GFXINC += drivers/gdisp/IS31FL3731C
 GFXSRC += drivers/gdisp/IS31FL3731C/gdisp_IS31FL3731C.c
+GFXSRC += drivers/gdisp/IS31FL3731C/frames_IS31FL3731C.c
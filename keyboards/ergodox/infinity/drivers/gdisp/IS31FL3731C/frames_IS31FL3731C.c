@@ -0,0 +1,84 @@
+/*
+Copyright 2016 Fred Sundvik <fsundvik@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#include <string.h>
+#include "frames_IS31FL3731C.h"
+
+uint8_t is31_dirty_ranges(const uint8_t* old, const uint8_t* next, uint8_t size, is31_range_t* ranges, uint8_t max) {
+    uint8_t count = 0;
+    for (uint8_t i = 0; i < size; i++) {
+        if (old[i] == next[i])
+            continue;
+        if (count) {
+            is31_range_t* last = &ranges[count - 1];
+            uint8_t end = last->start + last->length;
+            // out of ranges, the last one takes the rest
+            if (i - end < IS31_RANGE_GAP || count == max) {
+                last->length = i + 1 - last->start;
+                continue;
+            }
+        }
+        if (!max)
+            break;
+        ranges[count].start = i;
+        ranges[count].length = 1;
+        count++;
+    }
+    return count;
+}
+
+void is31_frames_init(is31_frames_t* frames) {
+    memset(frames, 0, sizeof(*frames));
+}
+
+static void write_page(is31_write_t write, void* ctx, uint8_t page) {
+    uint8_t tx[2] __attribute__((aligned(2)));
+    tx[0] = IS31_COMMANDREGISTER;
+    tx[1] = page;
+    write(ctx, tx, 2);
+}
+
+void is31_frames_flush(is31_frames_t* frames, const uint8_t* pwm, is31_write_t write, void* ctx) {
+    if (!memcmp(frames->pwm[frames->shown] + 1, pwm, IS31_PWM_SIZE))
+        return;
+
+    uint8_t page = frames->shown ^ 1;
+    uint8_t* frame = frames->pwm[page];
+    is31_range_t ranges[IS31_MAX_RANGES];
+    uint8_t count = is31_dirty_ranges(frame + 1, pwm, IS31_PWM_SIZE, ranges, IS31_MAX_RANGES);
+
+    memcpy(frame + 1, pwm, IS31_PWM_SIZE);
+    if (count) {
+        write_page(write, ctx, page);
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        // the byte before the range holds the register address while sending
+        uint8_t* tx = frame + ranges[i].start;
+        uint8_t saved = *tx;
+        *tx = IS31_PWM_REG + ranges[i].start;
+        write(ctx, tx, ranges[i].length + 1);
+        *tx = saved;
+    }
+
+    uint8_t tx[2] __attribute__((aligned(2)));
+    tx[0] = IS31_REG_PICTDISP;
+    tx[1] = page;
+    write_page(write, ctx, IS31_FUNCTIONREG);
+    write(ctx, tx, 2);
+    frames->shown = page;
+}
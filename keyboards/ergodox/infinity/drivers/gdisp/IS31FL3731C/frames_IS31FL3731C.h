@@ -0,0 +1,70 @@
+/*
+Copyright 2016 Fred Sundvik <fsundvik@gmail.com>
+
+This program is free software: you can redistribute it and/or modify
+it under the terms of the GNU General Public License as published by
+the Free Software Foundation, either version 2 of the License, or
+(at your option) any later version.
+
+This program is distributed in the hope that it will be useful,
+but WITHOUT ANY WARRANTY; without even the implied warranty of
+MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+GNU General Public License for more details.
+
+You should have received a copy of the GNU General Public License
+along with this program.  If not, see <http://www.gnu.org/licenses/>.
+*/
+
+
+#ifndef _FRAMES_IS31FL3731C_H
+#define _FRAMES_IS31FL3731C_H
+
+#include <stdint.h>
+
+#define IS31_COMMANDREGISTER 0xFD
+#define IS31_FUNCTIONREG 0x0B    // helpfully called 'page nine'
+#define IS31_REG_PICTDISP 0x01 // D2:D0 frame select for picture mode
+
+#define IS31_PWM_REG 0x24
+#define IS31_PWM_SIZE 0x90
+
+/*
+ * The driver draws into two of the eight frames of the chip in turn and
+ * shows the finished one with a single write to IS31_REG_PICTDISP, so
+ * a half written frame is never on display.
+ *
+ * A copy of the PWM registers of both frames is kept, and only the
+ * registers that differ from the frame being drawn are sent. Changed
+ * registers closer together than IS31_RANGE_GAP are sent as one range,
+ * that's cheaper than the register address and I2C address of another
+ * transfer.
+ */
+#ifndef IS31_RANGE_GAP
+#define IS31_RANGE_GAP 3
+#endif
+#ifndef IS31_MAX_RANGES
+#define IS31_MAX_RANGES 8
+#endif
+
+typedef struct {
+    uint8_t start;
+    uint8_t length;
+} is31_range_t;
+
+typedef struct {
+    // byte 0 is room for the register address when sending from 1 up
+    uint8_t pwm[2][1 + IS31_PWM_SIZE];
+    uint8_t shown;
+} is31_frames_t;
+
+typedef void (*is31_write_t)(void* ctx, uint8_t* data, uint16_t length);
+
+/* the ranges of size bytes where old and next differ, at most max of them */
+uint8_t is31_dirty_ranges(const uint8_t* old, const uint8_t* next, uint8_t size, is31_range_t* ranges, uint8_t max);
+
+/* the chip has frame 0 on display, and all frames are zero */
+void is31_frames_init(is31_frames_t* frames);
+/* sends the changes of pwm and shows it, nothing if it's on display already */
+void is31_frames_flush(is31_frames_t* frames, const uint8_t* pwm, is31_write_t write, void* ctx);
+
+#endif /* _FRAMES_IS31FL3731C_H */
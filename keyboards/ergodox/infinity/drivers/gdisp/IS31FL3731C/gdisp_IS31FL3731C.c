@@ -24,6 +24,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "src/gdisp/gdisp_driver.h"
 
 #include "board_IS31FL3731C.h"
+#include "frames_IS31FL3731C.h"
 
 
 // Can't include led_tables from here
@@ -57,8 +58,6 @@ extern const uint8_t CIE1931_CURVE[];
 #define IS31_REG_CONFIG_AUDIOPLAYMODE 0x18
 // D2:D0 bits are starting frame for autoplay mode
 
-#define IS31_REG_PICTDISP 0x01 // D2:D0 frame select for picture mode
-
 #define IS31_REG_AUTOPLAYCTRL1 0x02
 // D6:D4 number of loops (000=infty)
 // D2:D0 number of frames to be used
@@ -90,15 +89,10 @@ extern const uint8_t CIE1931_CURVE[];
 #define IS31_REG_AGCCTRL 0x0B
 #define IS31_REG_ADCRATE 0x0C
 
-#define IS31_COMMANDREGISTER 0xFD
-#define IS31_FUNCTIONREG 0x0B    // helpfully called 'page nine'
 #define IS31_FUNCTIONREG_SIZE 0xD
 
 #define IS31_FRAME_SIZE 0xB4
 
-#define IS31_PWM_REG 0x24
-#define IS31_PWM_SIZE 0x90
-
 #define IS31_LED_MASK_SIZE 0x12
 #define IS31_SCREEN_WIDTH 16
 
@@ -112,7 +106,7 @@ typedef struct{
     uint8_t write_buffer_offset;
     uint8_t write_buffer[IS31_FRAME_SIZE];
     uint8_t frame_buffer[GDISP_SCREEN_HEIGHT * GDISP_SCREEN_WIDTH];
-    uint8_t page;
+    is31_frames_t frames;
 }__attribute__((__packed__)) PrivData;
 
 // Some common routines and macros
@@ -143,11 +137,15 @@ static GFXINLINE void write_ram(GDisplay *g, uint8_t page, uint16_t offset, uint
     write_data(g, (uint8_t*)PRIV(g), length + 1);
 }
 
+static void frames_write(void* ctx, uint8_t* data, uint16_t length) {
+    write_data((GDisplay*)ctx, data, length);
+}
+
 LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
 	// The private area is the display surface.
 	g->priv = gfxAlloc(sizeof(PrivData));
     __builtin_memset(PRIV(g), 0, sizeof(PrivData));
-	PRIV(g)->page = 0;
+	is31_frames_init(&PRIV(g)->frames);
 
 	// Initialise the board interface
 	init_board(g);
@@ -195,12 +193,8 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
 		if (!(g->flags & GDISP_FLG_NEEDFLUSH))
 			return;
 
-		PRIV(g)->page++;
-		PRIV(g)->page %= 2;
-		// TODO: some smarter algorithm for this
-		// We should run only one physical page at a time
-		// This way we don't need to send so much data, and
-		// we could use slightly less memory
+		// the write buffer isn't needed after init, the new PWM
+		// registers go there
 		uint8_t* src = PRIV(g)->frame_buffer;
 		for (int y=0;y<GDISP_SCREEN_HEIGHT;y++) {
 		    for (int x=0;x<GDISP_SCREEN_WIDTH;x++) {
@@ -208,9 +202,7 @@ LLDSPEC bool_t gdisp_lld_init(GDisplay *g) {
 		        ++src;
 		    }
 		}
-        write_ram(g, PRIV(g)->page, IS31_PWM_REG, IS31_PWM_SIZE);
-        gfxSleepMilliseconds(1);
-        write_register(g, IS31_FUNCTIONREG, IS31_REG_PICTDISP, PRIV(g)->page);
+		is31_frames_flush(&PRIV(g)->frames, PRIV(g)->write_buffer, frames_write, g);
 
 		g->flags &= ~GDISP_FLG_NEEDFLUSH;
 	}
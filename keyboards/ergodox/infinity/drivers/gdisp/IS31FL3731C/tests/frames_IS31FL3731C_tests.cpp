@@ -0,0 +1,178 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string.h>
+#include <vector>
+extern "C" {
+#include "frames_IS31FL3731C.h"
+}
+
+using testing::ElementsAre;
+typedef std::vector<uint8_t> bytes_t;
+
+/* The I2C bus, keeps what the chip would do with the writes: the
+ * command register selects the page the next writes go to, the first
+ * byte of a write is the register address and auto increments. */
+class Is31Frames : public ::testing::Test {
+public:
+    Is31Frames() {
+        is31_frames_init(&frames);
+        memset(chip, 0, sizeof(chip));
+        memset(pwm, 0, sizeof(pwm));
+    }
+
+    static void write(void* ctx, uint8_t* data, uint16_t length) {
+        Is31Frames* t = (Is31Frames*)ctx;
+        t->writes.push_back(bytes_t(data, data + length));
+        t->traffic += length + 1;  // and the I2C address
+        if (data[0] == IS31_COMMANDREGISTER) {
+            t->page = data[1];
+            return;
+        }
+        for (uint16_t i = 1; i < length; i++) {
+            t->chip[t->page][data[0] + i - 1] = data[i];
+        }
+    }
+
+    void flush() {
+        writes.clear();
+        traffic = 0;
+        is31_frames_flush(&frames, pwm, write, this);
+    }
+
+    uint8_t shown() {
+        return chip[IS31_FUNCTIONREG][IS31_REG_PICTDISP];
+    }
+
+    bool showing(const uint8_t* expected) {
+        return !memcmp(&chip[shown()][IS31_PWM_REG], expected, IS31_PWM_SIZE);
+    }
+
+    is31_frames_t frames;
+    uint8_t pwm[IS31_PWM_SIZE];
+    uint8_t chip[12][256];
+    uint8_t page = 0;
+    std::vector<bytes_t> writes;
+    unsigned traffic = 0;
+};
+
+TEST(Is31DirtyRanges, finds_nothing_in_equal_frames) {
+    uint8_t a[16] = {1, 2, 3};
+    is31_range_t ranges[4];
+    EXPECT_EQ(is31_dirty_ranges(a, a, 16, ranges, 4), 0);
+}
+
+TEST(Is31DirtyRanges, finds_separate_ranges) {
+    uint8_t a[16] = {0};
+    uint8_t b[16] = {0};
+    b[0] = 1;
+    b[5] = 1; b[6] = 1;
+    b[15] = 1;
+    is31_range_t ranges[4];
+    ASSERT_EQ(is31_dirty_ranges(a, b, 16, ranges, 4), 3);
+    EXPECT_EQ(ranges[0].start, 0);  EXPECT_EQ(ranges[0].length, 1);
+    EXPECT_EQ(ranges[1].start, 5);  EXPECT_EQ(ranges[1].length, 2);
+    EXPECT_EQ(ranges[2].start, 15); EXPECT_EQ(ranges[2].length, 1);
+}
+
+TEST(Is31DirtyRanges, merges_small_gaps) {
+    uint8_t a[16] = {0};
+    uint8_t b[16] = {0};
+    b[2] = 1;
+    b[2 + IS31_RANGE_GAP] = 1;
+    b[2 + 2 * IS31_RANGE_GAP + 1] = 1;
+    is31_range_t ranges[4];
+    ASSERT_EQ(is31_dirty_ranges(a, b, 16, ranges, 4), 2);
+    EXPECT_EQ(ranges[0].start, 2);
+    EXPECT_EQ(ranges[0].length, IS31_RANGE_GAP + 1);
+    EXPECT_EQ(ranges[1].start, 2 + 2 * IS31_RANGE_GAP + 1);
+}
+
+TEST(Is31DirtyRanges, extends_the_last_range_when_out_of_ranges) {
+    uint8_t a[32] = {0};
+    uint8_t b[32] = {0};
+    for (int i = 0; i < 32; i += 8) {
+        b[i] = 1;
+    }
+    is31_range_t ranges[2];
+    ASSERT_EQ(is31_dirty_ranges(a, b, 32, ranges, 2), 2);
+    EXPECT_EQ(ranges[0].start, 0);  EXPECT_EQ(ranges[0].length, 1);
+    EXPECT_EQ(ranges[1].start, 8);  EXPECT_EQ(ranges[1].length, 17);
+}
+
+TEST_F(Is31Frames, draws_into_the_hidden_frame_and_switches) {
+    pwm[0x10] = 0x80;
+    flush();
+    EXPECT_EQ(shown(), 1);
+    EXPECT_TRUE(showing(pwm));
+    EXPECT_THAT(writes, ElementsAre(
+        bytes_t{IS31_COMMANDREGISTER, 1},
+        bytes_t{IS31_PWM_REG + 0x10, 0x80},
+        bytes_t{IS31_COMMANDREGISTER, IS31_FUNCTIONREG},
+        bytes_t{IS31_REG_PICTDISP, 1}));
+    // the frame on display is never written to
+    for (auto& w : writes) {
+        if (w[0] == IS31_COMMANDREGISTER) {
+            EXPECT_NE(w[1], 0);
+        }
+    }
+}
+
+TEST_F(Is31Frames, does_nothing_when_the_frame_is_on_display) {
+    flush();
+    EXPECT_TRUE(writes.empty());
+    pwm[3] = 1;
+    flush();
+    flush();
+    EXPECT_TRUE(writes.empty());
+}
+
+TEST_F(Is31Frames, only_switches_back_to_a_frame_that_is_still_there) {
+    pwm[3] = 1;
+    flush();
+    pwm[3] = 0;
+    flush();
+    EXPECT_EQ(shown(), 0);
+    pwm[3] = 1;
+    flush();
+    EXPECT_EQ(shown(), 1);
+    EXPECT_THAT(writes, ElementsAre(
+        bytes_t{IS31_COMMANDREGISTER, IS31_FUNCTIONREG},
+        bytes_t{IS31_REG_PICTDISP, 1}));
+}
+
+TEST_F(Is31Frames, keeps_the_buffer_intact) {
+    for (int i = 0; i < IS31_PWM_SIZE; i++) {
+        pwm[i] = i;
+    }
+    flush();
+    for (int i = 0; i < IS31_PWM_SIZE; i += 7) {
+        pwm[i] = 255 - i;
+    }
+    flush();
+    EXPECT_TRUE(showing(pwm));
+    for (int i = 0; i < IS31_PWM_SIZE; i += 7) {
+        pwm[i] = i;
+    }
+    flush();
+    EXPECT_TRUE(showing(pwm));
+}
+
+/* a moving dot on 7x7 LEDs like the ergodox infinity, mostly the same
+ * as the last two frames */
+TEST_F(Is31Frames, sends_less_than_the_whole_frame) {
+    uint32_t seed = 1;
+    unsigned total = 0;
+    const int count = 1000;
+    for (int frame = 0; frame < count; frame++) {
+        memset(pwm, 0, sizeof(pwm));
+        pwm[(frame % 7) * 16 + (frame / 7) % 7] = 255;
+        seed = seed * 1103515245 + 12345;
+        pwm[(seed >> 16) % 5 * 16] = seed >> 24;
+        flush();
+        ASSERT_TRUE(showing(pwm));
+        total += traffic;
+    }
+    unsigned full = 2 + 1 + IS31_PWM_SIZE + 1 + 3 + 3;
+    printf("%u bytes per frame, %u for the whole frame\n", total / count, full);
+    EXPECT_LT(total / count, full / 4);
+}
@@ -0,0 +1,6 @@
+IS31FL3731C_PATH := keyboards/ergodox/infinity/drivers/gdisp/IS31FL3731C
+
+is31fl3731c_frames_SRC :=\
+	$(IS31FL3731C_PATH)/tests/frames_IS31FL3731C_tests.cpp \
+	$(IS31FL3731C_PATH)/frames_IS31FL3731C.c
+is31fl3731c_frames_INC := $(IS31FL3731C_PATH)
@@ -0,0 +1,2 @@
+TEST_LIST +=\
+	is31fl3731c_frames
@@ -174,15 +174,15 @@ const uint16_t PROGMEM keymaps[][MATRIX_ROWS][MATRIX_COLS] = {
 
 #ifdef AUDIO_ENABLE
 
-float tone_startup[][2]    = SONG(STARTUP_SOUND);
-float tone_qwerty[][2]     = SONG(QWERTY_SOUND);
-float tone_dvorak[][2]     = SONG(DVORAK_SOUND);
-float tone_colemak[][2]    = SONG(COLEMAK_SOUND);
-float tone_plover[][2]     = SONG(PLOVER_SOUND);
-float tone_plover_gb[][2]  = SONG(PLOVER_GOODBYE_SOUND);
-float music_scale[][2]     = SONG(MUSIC_SCALE_SOUND);
+const uint8_t PROGMEM tone_startup[]    = SONG_DATA(STARTUP_SOUND);
+const uint8_t PROGMEM tone_qwerty[]     = SONG_DATA(QWERTY_SOUND);
+const uint8_t PROGMEM tone_dvorak[]     = SONG_DATA(DVORAK_SOUND);
+const uint8_t PROGMEM tone_colemak[]    = SONG_DATA(COLEMAK_SOUND);
+const uint8_t PROGMEM tone_plover[]     = SONG_DATA(PLOVER_SOUND);
+const uint8_t PROGMEM tone_plover_gb[]  = SONG_DATA(PLOVER_GOODBYE_SOUND);
+const uint8_t PROGMEM music_scale[]     = SONG_DATA(MUSIC_SCALE_SOUND);
 
-float tone_goodbye[][2] = SONG(GOODBYE_SOUND);
+const uint8_t PROGMEM tone_goodbye[] = SONG_DATA(GOODBYE_SOUND);
 #endif
 
 
@@ -196,7 +196,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
     case QWERTY:
       if (record->event.pressed) {
         #ifdef AUDIO_ENABLE
-          PLAY_NOTE_ARRAY(tone_qwerty, false, 0);
+          PLAY_SONG(tone_qwerty, false, 0);
         #endif
         persistent_default_layer_set(1UL<<_QWERTY);
       }
@@ -205,7 +205,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
     case COLEMAK:
       if (record->event.pressed) {
         #ifdef AUDIO_ENABLE
-          PLAY_NOTE_ARRAY(tone_colemak, false, 0);
+          PLAY_SONG(tone_colemak, false, 0);
         #endif
         persistent_default_layer_set(1UL<<_COLEMAK);
       }
@@ -214,7 +214,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
     case DVORAK:
       if (record->event.pressed) {
         #ifdef AUDIO_ENABLE
-          PLAY_NOTE_ARRAY(tone_dvorak, false, 0);
+          PLAY_SONG(tone_dvorak, false, 0);
         #endif
         persistent_default_layer_set(1UL<<_DVORAK);
       }
@@ -255,7 +255,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
       if (record->event.pressed) {
         #ifdef AUDIO_ENABLE
           stop_all_notes();
-          PLAY_NOTE_ARRAY(tone_plover, false, 0);
+          PLAY_SONG(tone_plover, false, 0);
         #endif
         layer_off(_RAISE);
         layer_off(_LOWER);
@@ -273,7 +273,7 @@ bool process_record_user(uint16_t keycode, keyrecord_t *record) {
     case EXT_PLV:
       if (record->event.pressed) {
         #ifdef AUDIO_ENABLE
-          PLAY_NOTE_ARRAY(tone_plover_gb, false, 0);
+          PLAY_SONG(tone_plover_gb, false, 0);
         #endif
         layer_off(_PLOVER);
       }
@@ -294,12 +294,12 @@ void matrix_init_user(void) {
 void startup_user()
 {
     _delay_ms(20); // gets rid of tick
-    PLAY_NOTE_ARRAY(tone_startup, false, 0);
+    PLAY_SONG(tone_startup, false, 0);
 }
 
 void shutdown_user()
 {
-    PLAY_NOTE_ARRAY(tone_goodbye, false, 0);
+    PLAY_SONG(tone_goodbye, false, 0);
     _delay_ms(150);
     stop_all_notes();
 }
@@ -311,7 +311,7 @@ void music_on_user(void)
 
 void music_scale_user(void)
 {
-    PLAY_NOTE_ARRAY(music_scale, false, 0);
+    PLAY_SONG(music_scale, false, 0);
 }
 
 #endif
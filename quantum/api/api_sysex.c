@@ -17,56 +17,48 @@
 #include "sysex_tools.h"
 #include "print.h"
 
+/* Sysex goes out in midi packets of 3 bytes, only the last one may be shorter */
+typedef struct {
+    uint8_t data[3];
+    uint8_t length;
+} sysex_packet_t;
+
+static void send_packet_bytes(sysex_packet_t * packet, const uint8_t * bytes, uint8_t length) {
+    for (uint8_t i = 0; i < length; i++) {
+        packet->data[packet->length++] = bytes[i];
+        if (packet->length == sizeof(packet->data)) {
+            midi_send_array(&midi_device, packet->length, packet->data);
+            packet->length = 0;
+        }
+    }
+}
+
 void send_bytes_sysex(uint8_t message_type, uint8_t data_type, uint8_t * bytes, uint16_t length) {
     // SEND_STRING("\nTX: ");
     // for (uint8_t i = 0; i < length; i++) {
     //     send_byte(bytes[i]);
     //     SEND_STRING(" ");
     // }
-    if (length > API_SYSEX_MAX_SIZE) {
-        xprintf("Sysex msg too big %d %d %d", message_type, data_type, length);
-        return;
-    }
-
 
-    // The buffer size required is calculated as the following
-    // API_SYSEX_MAX_SIZE is the maximum length
-    // In addition to that we have a two byte message header consisting of the message_type and data_type
-    // This has to be encoded with an additional overhead of one byte for every starting 7 bytes
-    // We just add one extra byte in case it's not divisible by 7
-    // Then we have an unencoded header consisting of 4 bytes
-    // Plus a one byte terminator
-    const unsigned message_header = 2;
-    const unsigned unencoded_message = API_SYSEX_MAX_SIZE + message_header;
-    const unsigned encoding_overhead = unencoded_message / 7 + 1;
-    const unsigned encoded_size = unencoded_message + encoding_overhead;
-    const unsigned unencoded_header = 4;
-    const unsigned terminator = 1;
-    const unsigned buffer_size = encoded_size + unencoded_header + terminator;
-    uint8_t buffer[encoded_size + unencoded_header + terminator];
-    // The unencoded header
-    buffer[0] = 0xF0;
-    buffer[1] = 0x00;
-    buffer[2] = 0x00;
-    buffer[3] = 0x00;
+    // The message is encoded and sent 7 bytes at a time, so only one encoded group of 8 bytes is
+    // held at any time and the length is not limited by a buffer
+    const uint8_t unencoded_header[] = {0xF0, 0x00, 0x00, 0x00};
+    const uint8_t message_header[] = {message_type, data_type};
+    const uint8_t terminator = 0xF7;
+    sysex_packet_t packet = {.length = 0};
+    sysex_encoder_t encoder;
+    uint8_t encoded[8];
 
-    // We copy the message to the end of the array, this way we can do an inplace encoding, using the same
-    // buffer for both input and output
-    const unsigned message_size = length + message_header;
-    uint8_t* unencoded_start = buffer + buffer_size - message_size;
-    uint8_t* ptr = unencoded_start;
-    *(ptr++) = message_type;
-    *(ptr++) = data_type;
-    memcpy(ptr, bytes, length);
-
-    unsigned encoded_length = sysex_encode(buffer + unencoded_header, unencoded_start, message_size);
-    unsigned final_size = unencoded_header + encoded_length + terminator;
-    buffer[final_size - 1] = 0xF7;
-    midi_send_array(&midi_device, final_size, buffer);
-
-    // SEND_STRING("\nTD: ");
-    // for (uint8_t i = 0; i < encoded_length + 5; i++) {
-    //     send_byte(buffer[i]);
-    //     SEND_STRING(" ");
-    // }
+    send_packet_bytes(&packet, unencoded_header, sizeof(unencoded_header));
+    sysex_encoder_init(&encoder);
+    send_packet_bytes(&packet, encoded, sysex_encode_chunk(&encoder, encoded, message_header, sizeof(message_header)));
+    for (uint16_t i = 0; i < length; i += 7) {
+        uint8_t chunk = length - i < 7 ? length - i : 7;
+        send_packet_bytes(&packet, encoded, sysex_encode_chunk(&encoder, encoded, bytes + i, chunk));
+    }
+    send_packet_bytes(&packet, encoded, sysex_encode_finish(&encoder, encoded));
+    send_packet_bytes(&packet, &terminator, 1);
+    if (packet.length) {
+        midi_send_array(&midi_device, packet.length, packet.data);
+    }
 }
@@ -0,0 +1,58 @@
+#include "adpcm.h"
+#include "progmem.h"
+
+static const uint16_t PROGMEM step_lut[ADPCM_STEPS] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17,
+    19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118,
+    130, 143, 157, 173, 190, 209, 230, 253, 279, 307,
+    337, 371, 408, 449, 494, 544, 598, 658, 724, 796,
+    876, 963, 1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066,
+    2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358,
+    5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487, 12635, 13899,
+    15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767
+};
+
+/* step index change of the code without its sign bit */
+static const int8_t PROGMEM index_lut[8] = {
+    -1, -1, -1, -1, 2, 4, 6, 8
+};
+
+void adpcm_init(adpcm_state_t *state) {
+    state->predictor = 0;
+    state->index = 0;
+}
+
+int16_t adpcm_decode(adpcm_state_t *state, uint8_t code) {
+    uint16_t step = pgm_read_word(&step_lut[state->index]);
+
+    // (code + 0.5) * step / 4 in shifts
+    int32_t diff = step >> 3;
+    if (code & 4) {
+        diff += step;
+    }
+    if (code & 2) {
+        diff += step >> 1;
+    }
+    if (code & 1) {
+        diff += step >> 2;
+    }
+
+    int32_t predictor = state->predictor + (code & 8 ? -diff : diff);
+    if (predictor > INT16_MAX) {
+        predictor = INT16_MAX;
+    } else if (predictor < INT16_MIN) {
+        predictor = INT16_MIN;
+    }
+    state->predictor = predictor;
+
+    int8_t index = state->index + (int8_t)pgm_read_byte(&index_lut[code & 7]);
+    if (index < 0) {
+        index = 0;
+    } else if (index >= ADPCM_STEPS) {
+        index = ADPCM_STEPS - 1;
+    }
+    state->index = index;
+
+    return state->predictor;
+}
@@ -0,0 +1,26 @@
+#ifndef ADPCM_H
+#define ADPCM_H
+
+#include <stdint.h>
+
+/*
+ * IMA-ADPCM decoder.
+ *
+ * Each 4 bit code is a step up or down from the last sample, in a step
+ * size that grows and shrinks with the codes, so a 16 bit sample takes
+ * a quarter of the space. util/sample_convert.py encodes WAV files with
+ * the same state, starting from a predictor and step index of 0.
+ */
+
+#define ADPCM_STEPS 89
+
+typedef struct {
+    int16_t predictor;
+    uint8_t index;
+} adpcm_state_t;
+
+void adpcm_init(adpcm_state_t *state);
+/* next sample of the code in the low 4 bits */
+int16_t adpcm_decode(adpcm_state_t *state, uint8_t code);
+
+#endif
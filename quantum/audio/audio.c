@@ -16,21 +16,28 @@
 #include <stdio.h>
 #include <string.h>
 //#include <math.h>
+#if defined(__AVR__)
 #include <avr/pgmspace.h>
 #include <avr/interrupt.h>
 #include <avr/io.h>
+#endif
 #include "print.h"
 #include "audio.h"
+#include "synth.h"
+#include "mixer.h"
 #include "keymap.h"
 
 #include "eeconfig.h"
 
-#define CPU_PRESCALER 8
+// Timer period while resting, the interrupt only counts the time
+#define REST_PERIOD 0x7FF
 
 // -----------------------------------------------------------------------------
 // Timer Abstractions
 // -----------------------------------------------------------------------------
 
+#if defined(__AVR__)
+
 // TIMSK3 - Timer/Counter #3 Interrupt Mask Register
 // Turn on/off 3A interputs, stopping/enabling the ISR calls
 #define ENABLE_AUDIO_COUNTER_3_ISR TIMSK3 |= _BV(OCIE3A)
@@ -45,47 +52,101 @@
 #define TIMER_3_PERIOD     ICR3
 #define TIMER_3_DUTY_CYCLE OCR3A
 
+#define AUDIO_INTERRUPT ISR(TIMER3_COMPA_vect)
+
+static void audio_timer_init(void)
+{
+    // Set port PC6 (OC3A and /OC4A) as output
+    DDRC |= _BV(PORTC6);
+
+    DISABLE_AUDIO_COUNTER_3_ISR;
+
+    // TCCR3A / TCCR3B: Timer/Counter #3 Control Registers
+    // Compare Output Mode (COM3An) = 0b00 = Normal port operation, OC3A disconnected from PC6
+    // Waveform Generation Mode (WGM3n) = 0b1110 = Fast PWM Mode 14 (Period = ICR3, Duty Cycle = OCR3A)
+    // Clock Select (CS3n) = 0b010 = Clock / 8
+    TCCR3A = (0 << COM3A1) | (0 << COM3A0) | (1 << WGM31) | (0 << WGM30);
+    TCCR3B = (1 << WGM33)  | (1 << WGM32)  | (0 << CS32)  | (1 << CS31) | (0 << CS30);
+}
+
+#elif defined(AUDIO_HOST)
+
+// Rendered by audio_host_render() in the host tests
+#include "audio_host.h"
+
+#define ENABLE_AUDIO_COUNTER_3_ISR audio_host.isr = true
+#define DISABLE_AUDIO_COUNTER_3_ISR audio_host.isr = false
+
+#define ENABLE_AUDIO_COUNTER_3_OUTPUT audio_host.output = true;
+#define DISABLE_AUDIO_COUNTER_3_OUTPUT audio_host.output = false;
+
+#define TIMER_3_PERIOD     audio_host.period
+#define TIMER_3_DUTY_CYCLE audio_host.duty
+
+#define AUDIO_INTERRUPT void audio_host_interrupt(void)
+
+static void audio_timer_init(void)
+{
+    DISABLE_AUDIO_COUNTER_3_ISR;
+}
+
+#else
+#error "audio.c has no timer backend for this platform"
+#endif
+
 // -----------------------------------------------------------------------------
 
 
-int voices = 0;
-int voice_place = 0;
-float frequency = 0;
+uint8_t voice_place = 0;
+pitch_t glide_pitch = SYNTH_REST;
 int volume = 0;
 long position = 0;
 
-float frequencies[8] = {0, 0, 0, 0, 0, 0, 0, 0};
-int volumes[8] = {0, 0, 0, 0, 0, 0, 0, 0};
 bool sliding = false;
 
-float place = 0;
+// timer ticks the current voice has played for
+uint32_t place = 0;
 
 uint8_t * sample;
 uint16_t sample_length = 0;
 
+// Lengths and positions are in timer ticks
 bool     playing_notes = false;
 bool     playing_note = false;
-float    note_frequency = 0;
-float    note_length = 0;
+bool     playing_sample = false;
+pitch_t  note_pitch = SYNTH_REST;
+uint32_t note_length = 0;
 uint8_t  note_tempo = TEMPO_DEFAULT;
-float    note_timbre = TIMBRE_DEFAULT;
-uint16_t note_position = 0;
+uint16_t note_timbre = TIMBRE_FIXED(TIMBRE_DEFAULT);
+uint32_t note_position = 0;
 float (* notes_pointer)[][2];
 uint16_t notes_count;
 bool     notes_repeat;
-float    notes_rest;
+uint32_t notes_rest;
 bool     note_resting = false;
+bool     notes_song = false;
+song_reader_t song;
 
-uint8_t current_note = 0;
+// next note of notes_pointer
+uint16_t current_note = 0;
 uint8_t rest_counter = 0;
 
 #ifdef VIBRATO_ENABLE
-float vibrato_counter = 0;
 float vibrato_strength = .5;
 float vibrato_rate = 0.125;
+synth_vibrato_t vibrato = {
+    .rate = 0.125 * 256,
+#ifdef VIBRATO_STRENGTH_ENABLE
+    .strength = .5 * 256,
+#else
+    .strength = 256,
+#endif
+};
 #endif
 
 float polyphony_rate = 0;
+// timer ticks each voice plays for when cycling, 0 when off
+uint32_t polyphony_slice = 0;
 
 static bool audio_initialized = false;
 
@@ -104,17 +165,9 @@ void audio_init()
     }
     audio_config.raw = eeconfig_read_audio();
 
-    // Set port PC6 (OC3A and /OC4A) as output
-    DDRC |= _BV(PORTC6);
-
-    DISABLE_AUDIO_COUNTER_3_ISR;
+    audio_timer_init();
 
-    // TCCR3A / TCCR3B: Timer/Counter #3 Control Registers
-    // Compare Output Mode (COM3An) = 0b00 = Normal port operation, OC3A disconnected from PC6
-    // Waveform Generation Mode (WGM3n) = 0b1110 = Fast PWM Mode 14 (Period = ICR3, Duty Cycle = OCR3A)
-    // Clock Select (CS3n) = 0b010 = Clock / 8
-    TCCR3A = (0 << COM3A1) | (0 << COM3A0) | (1 << WGM31) | (0 << WGM30);
-    TCCR3B = (1 << WGM33)  | (1 << WGM32)  | (0 << CS32)  | (1 << CS31) | (0 << CS30);
+    mixer_clear();
 
     audio_initialized = true;
 }
@@ -126,21 +179,18 @@ void stop_all_notes()
     if (!audio_initialized) {
         audio_init();
     }
-    voices = 0;
 
     DISABLE_AUDIO_COUNTER_3_ISR;
     DISABLE_AUDIO_COUNTER_3_OUTPUT;
 
     playing_notes = false;
     playing_note = false;
-    frequency = 0;
+    playing_sample = false;
+    glide_pitch = SYNTH_REST;
     volume = 0;
 
-    for (uint8_t i = 0; i < 8; i++)
-    {
-        frequencies[i] = 0;
-        volumes[i] = 0;
-    }
+    mixer_clear();
+    sample_stop();
 }
 
 void stop_note(float freq)
@@ -151,155 +201,139 @@ void stop_note(float freq)
         if (!audio_initialized) {
             audio_init();
         }
-        for (int i = 7; i >= 0; i--) {
-            if (frequencies[i] == freq) {
-                frequencies[i] = 0;
-                volumes[i] = 0;
-                for (int j = i; (j < 7); j++) {
-                    frequencies[j] = frequencies[j+1];
-                    frequencies[j+1] = 0;
-                    volumes[j] = volumes[j+1];
-                    volumes[j+1] = 0;
-                }
-                break;
-            }
-        }
-        voices--;
-        if (voices < 0)
-            voices = 0;
-        if (voice_place >= voices) {
-            voice_place = 0;
-        }
-        if (voices == 0) {
-            DISABLE_AUDIO_COUNTER_3_ISR;
+        DISABLE_AUDIO_COUNTER_3_ISR;
+        mixer_note_off(synth_pitch(freq));
+        if (mixer_active() == 0) {
             DISABLE_AUDIO_COUNTER_3_OUTPUT;
-            frequency = 0;
+            glide_pitch = SYNTH_REST;
             volume = 0;
             playing_note = false;
+        } else {
+            ENABLE_AUDIO_COUNTER_3_ISR;
         }
     }
 }
 
 #ifdef VIBRATO_ENABLE
+    #define with_vibrato(pitch) (vibrato.strength > 0 ? synth_vibrato(&vibrato, (pitch)) : (pitch))
+#else
+    #define with_vibrato(pitch) (pitch)
+#endif
 
-float mod(float a, int b)
+static void play_pitch(pitch_t pitch)
 {
-    float r = fmod(a, b);
-    return r < 0 ? r + b : r;
+    uint16_t period = synth_period(pitch);
+
+    TIMER_3_PERIOD = period;
+    TIMER_3_DUTY_CYCLE = ((uint32_t)period * note_timbre) >> 8;
 }
 
-float vibrato(float average_freq) {
-    #ifdef VIBRATO_STRENGTH_ENABLE
-        float vibrated_freq = average_freq * pow(vibrato_lut[(int)vibrato_counter], vibrato_strength);
-    #else
-        float vibrated_freq = average_freq * vibrato_lut[(int)vibrato_counter];
-    #endif
-    vibrato_counter = mod((vibrato_counter + vibrato_rate * (1.0 + 440.0/average_freq)), VIBRATO_LUT_LENGTH);
-    return vibrated_freq;
+static bool has_next_note(void)
+{
+    if (notes_song) {
+        return song_more(&song);
+    }
+    return current_note < notes_count;
 }
 
-#endif
+static void rewind_notes(void)
+{
+    if (notes_song) {
+        song_start(&song, song.data, song.length);
+    } else {
+        current_note = 0;
+    }
+}
 
-ISR(TIMER3_COMPA_vect)
+static void next_note(void)
 {
-    float freq;
+    if (notes_song) {
+        song_note_t note;
+        if (song_next(&song, &note)) {
+            note_pitch = song_pitch(note.note);
+            note_length = song_ticks(note.duration, note_tempo);
+        } else {
+            note_pitch = SYNTH_REST;
+            note_length = 0;
+        }
+    } else if (current_note < notes_count) {
+        // beats / 4 * tempo / 100 of 0xFFFF ticks
+        note_pitch = synth_pitch((*notes_pointer)[current_note][0]);
+        note_length = synth_mul((*notes_pointer)[current_note][1], (uint32_t)0xFFFF * note_tempo / 400);
+        current_note++;
+    } else {
+        note_pitch = SYNTH_REST;
+        note_length = 0;
+    }
+}
+
+AUDIO_INTERRUPT
+{
+    pitch_t pitch;
+
+    if (playing_sample) {
+        uint8_t duty;
+        if (sample_pop(&duty)) {
+            TIMER_3_DUTY_CYCLE = duty;
+        } else {
+            DISABLE_AUDIO_COUNTER_3_ISR;
+            DISABLE_AUDIO_COUNTER_3_OUTPUT;
+            playing_sample = false;
+        }
+        return;
+    }
 
     if (playing_note) {
-        if (voices > 0) {
-            if (polyphony_rate > 0) {
-                if (voices > 1) {
-                    voice_place %= voices;
-                    if (place++ > (frequencies[voice_place] / polyphony_rate / CPU_PRESCALER)) {
-                        voice_place = (voice_place + 1) % voices;
-                        place = 0.0;
-                    }
+        uint8_t newest = mixer_newest();
+        if (newest != MIXER_NO_VOICE) {
+            if (polyphony_slice > 0) {
+                place += TIMER_3_PERIOD;
+                if (place > polyphony_slice || mixer_voices[voice_place].pitch == SYNTH_REST) {
+                    voice_place = mixer_next(voice_place);
+                    place = 0;
                 }
 
-                #ifdef VIBRATO_ENABLE
-                    if (vibrato_strength > 0) {
-                        freq = vibrato(frequencies[voice_place]);
-                    } else {
-                        freq = frequencies[voice_place];
-                    }
-                #else
-                    freq = frequencies[voice_place];
-                #endif
+                pitch = with_vibrato(mixer_voices[voice_place].pitch);
             } else {
                 if (glissando) {
-                    if (frequency != 0 && frequency < frequencies[voices - 1] && frequency < frequencies[voices - 1] * pow(2, -440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, 440/frequency/12/2);
-                    } else if (frequency != 0 && frequency > frequencies[voices - 1] && frequency > frequencies[voices - 1] * pow(2, 440/frequencies[voices - 1]/12/2)) {
-                        frequency = frequency * pow(2, -440/frequency/12/2);
-                    } else {
-                        frequency = frequencies[voices - 1];
-                    }
+                    glide_pitch = synth_glide(glide_pitch, mixer_voices[newest].pitch);
                 } else {
-                    frequency = frequencies[voices - 1];
+                    glide_pitch = mixer_voices[newest].pitch;
                 }
 
-                #ifdef VIBRATO_ENABLE
-                    if (vibrato_strength > 0) {
-                        freq = vibrato(frequency);
-                    } else {
-                        freq = frequency;
-                    }
-                #else
-                    freq = frequency;
-                #endif
+                pitch = with_vibrato(glide_pitch);
             }
 
             if (envelope_index < 65535) {
                 envelope_index++;
             }
 
-            freq = voice_envelope(freq);
-
-            if (freq < 30.517578125) {
-                freq = 30.52;
-            }
-
-            TIMER_3_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_3_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            play_pitch(voice_envelope(pitch));
         }
     }
 
     if (playing_notes) {
-        if (note_frequency > 0) {
-            #ifdef VIBRATO_ENABLE
-                if (vibrato_strength > 0) {
-                    freq = vibrato(note_frequency);
-                } else {
-                    freq = note_frequency;
-                }
-            #else
-                    freq = note_frequency;
-            #endif
+        if (note_pitch != SYNTH_REST) {
+            pitch = with_vibrato(note_pitch);
 
             if (envelope_index < 65535) {
                 envelope_index++;
             }
-            freq = voice_envelope(freq);
 
-            TIMER_3_PERIOD = (uint16_t)(((float)F_CPU) / (freq * CPU_PRESCALER));
-            TIMER_3_DUTY_CYCLE = (uint16_t)((((float)F_CPU) / (freq * CPU_PRESCALER)) * note_timbre);
+            play_pitch(voice_envelope(pitch));
         } else {
-            TIMER_3_PERIOD = 0;
+            TIMER_3_PERIOD = REST_PERIOD;
             TIMER_3_DUTY_CYCLE = 0;
         }
 
-        note_position++;
-        bool end_of_note = false;
-        if (TIMER_3_PERIOD > 0) {
-            end_of_note = (note_position >= (note_length / TIMER_3_PERIOD * 0xFFFF));
-        } else {
-            end_of_note = (note_position >= (note_length * 0x7FF));
-        }
-
-        if (end_of_note) {
-            current_note++;
-            if (current_note >= notes_count) {
+        note_position += TIMER_3_PERIOD;
+        if (note_position >= note_length) {
+            // what the last period ran over goes to the next note, so
+            // songs keep time whatever their pitches
+            note_position -= note_length;
+            if (!has_next_note()) {
                 if (notes_repeat) {
-                    current_note = 0;
+                    rewind_notes();
                 } else {
                     DISABLE_AUDIO_COUNTER_3_ISR;
                     DISABLE_AUDIO_COUNTER_3_OUTPUT;
@@ -309,17 +343,13 @@ ISR(TIMER3_COMPA_vect)
             }
             if (!note_resting && (notes_rest > 0)) {
                 note_resting = true;
-                note_frequency = 0;
+                note_pitch = SYNTH_REST;
                 note_length = notes_rest;
-                current_note--;
             } else {
                 note_resting = false;
                 envelope_index = 0;
-                note_frequency = (*notes_pointer)[current_note][0];
-                note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
+                next_note();
             }
-
-            note_position = 0;
         }
     }
 
@@ -337,22 +367,19 @@ void play_note(float freq, int vol) {
         audio_init();
     }
 
-    if (audio_config.enable && voices < 8) {
+    if (audio_config.enable) {
         DISABLE_AUDIO_COUNTER_3_ISR;
 
         // Cancel notes if notes are playing
-        if (playing_notes)
+        if (playing_notes || playing_sample)
             stop_all_notes();
 
         playing_note = true;
 
         envelope_index = 0;
 
-        if (freq > 0) {
-            frequencies[voices] = freq;
-            volumes[voices] = vol;
-            voices++;
-        }
+        // takes over the oldest note when all voices are playing
+        mixer_note_on(synth_pitch(freq), vol, note_timbre);
 
         ENABLE_AUDIO_COUNTER_3_ISR;
         ENABLE_AUDIO_COUNTER_3_OUTPUT;
@@ -360,40 +387,82 @@ void play_note(float freq, int vol) {
 
 }
 
-void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat, float n_rest)
+static bool stop_for_notes(void)
 {
-
     if (!audio_initialized) {
         audio_init();
     }
 
-    if (audio_config.enable) {
+    if (!audio_config.enable) {
+        return false;
+    }
 
-        DISABLE_AUDIO_COUNTER_3_ISR;
+    DISABLE_AUDIO_COUNTER_3_ISR;
 
-        // Cancel note if a note is playing
-        if (playing_note)
-            stop_all_notes();
+    // Cancel note if a note is playing
+    if (playing_note || playing_sample)
+        stop_all_notes();
 
-        playing_notes = true;
+    return true;
+}
 
+static void start_notes(bool n_repeat, float n_rest)
+{
+    playing_notes = true;
+
+    notes_repeat = n_repeat;
+    // as long as a note of n_rest beats * 4 at tempo 100
+    notes_rest = synth_mul(n_rest, 0xFFFF);
+
+    place = 0;
+    note_resting = false;
+
+    next_note();
+    note_position = 0;
+
+    ENABLE_AUDIO_COUNTER_3_ISR;
+    ENABLE_AUDIO_COUNTER_3_OUTPUT;
+}
+
+void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat, float n_rest)
+{
+    if (stop_for_notes()) {
+        notes_song = false;
         notes_pointer = np;
         notes_count = n_count;
-        notes_repeat = n_repeat;
-        notes_rest = n_rest;
-
-        place = 0;
         current_note = 0;
+        start_notes(n_repeat, n_rest);
+    }
+}
+
+void play_song(const uint8_t *song_data, uint16_t length, bool repeat, float rest)
+{
+    if (stop_for_notes()) {
+        notes_song = true;
+        song_start(&song, song_data, length);
+        start_notes(repeat, rest);
+    }
+}
+
+void play_sample(const audio_sample_t *sample, bool repeat)
+{
+    if (!audio_initialized) {
+        audio_init();
+    }
+
+    if (audio_config.enable) {
+        stop_all_notes();
 
-        note_frequency = (*notes_pointer)[current_note][0];
-        note_length = ((*notes_pointer)[current_note][1] / 4) * (((float)note_tempo) / 100);
-        note_position = 0;
+        sample_play(sample, repeat);
+        playing_sample = true;
 
+        // one sample a period, the duty is the level
+        TIMER_3_PERIOD = SAMPLE_PERIOD - 1;
+        TIMER_3_DUTY_CYCLE = SAMPLE_PERIOD / 2;
 
         ENABLE_AUDIO_COUNTER_3_ISR;
         ENABLE_AUDIO_COUNTER_3_OUTPUT;
     }
-
 }
 
 bool is_playing_notes(void) {
@@ -426,30 +495,44 @@ void audio_off(void) {
 
 // Vibrato rate functions
 
+static void update_vibrato_rate(void) {
+    vibrato.rate = vibrato_rate < 0 ? 0 : (vibrato_rate >= 1 ? 255 : vibrato_rate * 256);
+}
+
 void set_vibrato_rate(float rate) {
     vibrato_rate = rate;
+    update_vibrato_rate();
 }
 
 void increase_vibrato_rate(float change) {
     vibrato_rate *= change;
+    update_vibrato_rate();
 }
 
 void decrease_vibrato_rate(float change) {
     vibrato_rate /= change;
+    update_vibrato_rate();
 }
 
 #ifdef VIBRATO_STRENGTH_ENABLE
 
+static void update_vibrato_strength(void) {
+    vibrato.strength = vibrato_strength < 0 ? 0 : (vibrato_strength >= 4 ? 1024 : vibrato_strength * 256);
+}
+
 void set_vibrato_strength(float strength) {
     vibrato_strength = strength;
+    update_vibrato_strength();
 }
 
 void increase_vibrato_strength(float change) {
     vibrato_strength *= change;
+    update_vibrato_strength();
 }
 
 void decrease_vibrato_strength(float change) {
     vibrato_strength /= change;
+    update_vibrato_strength();
 }
 
 #endif  /* VIBRATO_STRENGTH_ENABLE */
@@ -458,30 +541,40 @@ void decrease_vibrato_strength(float change) {
 
 // Polyphony functions
 
+static void update_polyphony_slice(void) {
+    // the voices change polyphony_rate * SYNTH_PRESCALER times a second
+    polyphony_slice = polyphony_rate > 0 ? SYNTH_CLOCK / (polyphony_rate * SYNTH_PRESCALER) : 0;
+}
+
 void set_polyphony_rate(float rate) {
     polyphony_rate = rate;
+    update_polyphony_slice();
 }
 
 void enable_polyphony() {
     polyphony_rate = 5;
+    update_polyphony_slice();
 }
 
 void disable_polyphony() {
     polyphony_rate = 0;
+    update_polyphony_slice();
 }
 
 void increase_polyphony_rate(float change) {
     polyphony_rate *= change;
+    update_polyphony_slice();
 }
 
 void decrease_polyphony_rate(float change) {
     polyphony_rate /= change;
+    update_polyphony_slice();
 }
 
 // Timbre function
 
 void set_timbre(float timbre) {
-    note_timbre = timbre;
+    note_timbre = timbre < 0 ? 0 : (timbre > 1 ? 256 : TIMBRE_FIXED(timbre));
 }
 
 // Tempo functions
@@ -18,10 +18,14 @@
 
 #include <stdint.h>
 #include <stdbool.h>
+#if defined(__AVR__)
 #include <avr/io.h>
 #include <util/delay.h>
+#endif
 #include "musical_notes.h"
 #include "song_list.h"
+#include "song.h"
+#include "sample.h"
 #include "voices.h"
 #include "quantum.h"
 
@@ -80,13 +84,12 @@ void decrease_tempo(uint8_t tempo_change);
 
 void audio_init(void);
 
-#ifdef PWM_AUDIO
-void play_sample(uint8_t * s, uint16_t l, bool r);
-#endif
+void play_sample(const audio_sample_t *sample, bool repeat);
 void play_note(float freq, int vol);
 void stop_note(float freq);
 void stop_all_notes(void);
 void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat, float n_rest);
+void play_song(const uint8_t *song, uint16_t length, bool repeat, float rest);
 
 #define SCALE (int8_t []){ 0 + (12*0), 2 + (12*0), 4 + (12*0), 5 + (12*0), 7 + (12*0), 9 + (12*0), 11 + (12*0), \
                            0 + (12*1), 2 + (12*1), 4 + (12*1), 5 + (12*1), 7 + (12*1), 9 + (12*1), 11 + (12*1), \
@@ -99,6 +102,8 @@ void play_notes(float (*np)[][2], uint16_t n_count, bool n_repeat, float n_rest)
 // The global float array for the song must be used here.
 #define NOTE_ARRAY_SIZE(x) ((int16_t)(sizeof(x) / (sizeof(x[0]))))
 #define PLAY_NOTE_ARRAY(note_array, note_repeat, note_rest_style) play_notes(&note_array, NOTE_ARRAY_SIZE((note_array)), (note_repeat), (note_rest_style));
+// Plays a PROGMEM array of SONG_DATA, see song.h.
+#define PLAY_SONG(song, song_repeat, song_rest_style) play_song((song), sizeof(song), (song_repeat), (song_rest_style));
 
 
 bool is_playing_notes(void);
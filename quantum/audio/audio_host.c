@@ -0,0 +1,78 @@
+#include "audio_host.h"
+#include "synth.h"
+
+audio_host_t audio_host;
+
+static uint64_t period_start;
+static uint64_t period_end;
+static uint64_t rendered;
+
+void audio_host_reset(void) {
+    audio_host = (audio_host_t){ 0 };
+    period_start = 0;
+    period_end = 1;
+    rendered = 0;
+}
+
+static uint64_t min_tick(uint64_t a, uint64_t b) {
+    return a < b ? a : b;
+}
+
+void audio_host_render(int16_t *samples, uint32_t count) {
+    for (uint32_t i = 0; i < count; i++) {
+        uint64_t start = audio_host.ticks;
+        uint64_t end = ++rendered * SYNTH_CLOCK / AUDIO_HOST_SAMPLE_RATE;
+        // high ticks less low ticks
+        int64_t level = 0;
+
+        while (audio_host.ticks < end) {
+            uint64_t until = min_tick(period_end, end);
+            if (audio_host.output) {
+                uint64_t high_end = min_tick(period_start + audio_host.duty, until);
+                uint64_t high = high_end > audio_host.ticks ? high_end - audio_host.ticks : 0;
+                level += 2 * (int64_t)high - (int64_t)(until - audio_host.ticks);
+            }
+            audio_host.ticks = until;
+
+            if (audio_host.ticks == period_end) {
+                if (audio_host.isr) {
+                    audio_host.interrupts++;
+                    audio_host_interrupt();
+                }
+                period_start = period_end;
+                period_end = period_start + audio_host.period + 1;
+            }
+        }
+
+        samples[i] = end > start ? level * AUDIO_HOST_AMPLITUDE / (int64_t)(end - start) : 0;
+    }
+}
+
+static bool write_le(FILE *file, uint32_t value, uint8_t bytes) {
+    for (uint8_t i = 0; i < bytes; i++) {
+        if (fputc((value >> (8 * i)) & 0xFF, file) == EOF) {
+            return false;
+        }
+    }
+    return true;
+}
+
+bool audio_host_write_wav(FILE *file, const int16_t *samples, uint32_t count) {
+    uint32_t data_size = count * 2;
+    bool ok = fwrite("RIFF", 4, 1, file) == 1
+        && write_le(file, 36 + data_size, 4)
+        && fwrite("WAVEfmt ", 8, 1, file) == 1
+        && write_le(file, 16, 4)                            // format size
+        && write_le(file, 1, 2)                             // PCM
+        && write_le(file, 1, 2)                             // mono
+        && write_le(file, AUDIO_HOST_SAMPLE_RATE, 4)
+        && write_le(file, AUDIO_HOST_SAMPLE_RATE * 2, 4)    // bytes per second
+        && write_le(file, 2, 2)                             // bytes per frame
+        && write_le(file, 16, 2)                            // bits per sample
+        && fwrite("data", 4, 1, file) == 1
+        && write_le(file, data_size, 4);
+    for (uint32_t i = 0; ok && i < count; i++) {
+        ok = write_le(file, (uint16_t)samples[i], 2);
+    }
+    return ok;
+}
@@ -0,0 +1,50 @@
+#ifndef AUDIO_HOST_H
+#define AUDIO_HOST_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include <stdio.h>
+
+/*
+ * Stand-in for timer 3 when audio.c is built for the host.
+ *
+ * audio.c drives the registers through the timer macros at its top, which
+ * set these fields instead when built with -DAUDIO_HOST. audio_host_render() runs the timer
+ * at SYNTH_CLOCK in virtual time: the output is high for duty ticks of each
+ * period + 1, and the audio interrupt runs at the end of each period while
+ * enabled, like TIMER3_COMPA_vect. Samples average the output over their
+ * span, so songs, clicky, vibrato, glissando and music mode can be heard
+ * and checked without a board.
+ *
+ * interrupts counts the interrupt runs, interrupts per sample is the
+ * interrupt load of a synthesis option.
+ */
+
+#ifndef AUDIO_HOST_SAMPLE_RATE
+#define AUDIO_HOST_SAMPLE_RATE 44100
+#endif
+
+/* level of a high output, a low one is the negative */
+#define AUDIO_HOST_AMPLITUDE 0x3FFF
+
+typedef struct {
+    bool isr;
+    bool output;
+    uint16_t period;
+    uint16_t duty;
+    /* timer ticks since audio_host_reset() */
+    uint64_t ticks;
+    uint32_t interrupts;
+} audio_host_t;
+
+extern audio_host_t audio_host;
+
+/* the audio interrupt of audio.c */
+void audio_host_interrupt(void);
+
+void audio_host_reset(void);
+void audio_host_render(int16_t *samples, uint32_t count);
+/* 16 bit mono WAV at AUDIO_HOST_SAMPLE_RATE, false when writing fails */
+bool audio_host_write_wav(FILE *file, const int16_t *samples, uint32_t count);
+
+#endif
@@ -0,0 +1,180 @@
+#include "mixer.h"
+
+#define MAP_NOTES 128
+#define MAP_EMPTY 0xF
+
+#ifdef MIXER_RENDER
+/* phase increment of period 1, 2^32 * SYNTH_CLOCK / MIXER_SAMPLE_RATE,
+ * shifted down to a 32 bit division */
+#define INCREMENT_SHIFT 8
+#define INCREMENT_BASE ((uint32_t)(((uint64_t)SYNTH_CLOCK << (32 - INCREMENT_SHIFT)) / MIXER_SAMPLE_RATE))
+#endif
+
+mixer_voice_t mixer_voices[MIXER_VOICES];
+
+/* voice of each semitone, two to a byte */
+static uint8_t note_map[MAP_NOTES / 2];
+static uint16_t note_ons = 0;
+static uint8_t newest = MIXER_NO_VOICE;
+static uint8_t active = 0;
+
+static uint8_t note_of(pitch_t pitch) {
+    uint16_t note = (pitch + SYNTH_SEMITONE / 2) / SYNTH_SEMITONE;
+    return note < MAP_NOTES ? note : MAP_NOTES - 1;
+}
+
+static uint8_t map_get(uint8_t note) {
+    uint8_t pair = note_map[note / 2];
+    return note & 1 ? pair >> 4 : pair & 0xF;
+}
+
+static void map_set(uint8_t note, uint8_t voice) {
+    uint8_t *pair = &note_map[note / 2];
+    if (note & 1) {
+        *pair = (*pair & 0x0F) | (voice << 4);
+    } else {
+        *pair = (*pair & 0xF0) | voice;
+    }
+}
+
+void mixer_clear(void) {
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        mixer_voices[i] = (mixer_voice_t){ 0 };
+    }
+    for (uint8_t i = 0; i < MAP_NOTES / 2; i++) {
+        note_map[i] = (MAP_EMPTY << 4) | MAP_EMPTY;
+    }
+    newest = MIXER_NO_VOICE;
+    active = 0;
+}
+
+static uint8_t find(pitch_t pitch) {
+    uint8_t voice = map_get(note_of(pitch));
+    if (voice != MAP_EMPTY && mixer_voices[voice].pitch == pitch) {
+        return voice;
+    }
+    // a note sharing the semitone took the map entry
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        if (mixer_voices[i].pitch == pitch) {
+            return i;
+        }
+    }
+    return MIXER_NO_VOICE;
+}
+
+static void release(uint8_t voice) {
+    uint8_t note = note_of(mixer_voices[voice].pitch);
+    if (map_get(note) == voice) {
+        map_set(note, MAP_EMPTY);
+    }
+    mixer_voices[voice].pitch = SYNTH_REST;
+    active--;
+}
+
+/* playing voice started last, or first when oldest */
+static uint8_t by_age(bool oldest) {
+    uint8_t found = MIXER_NO_VOICE;
+    uint16_t found_age = 0;
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        if (mixer_voices[i].pitch == SYNTH_REST) {
+            continue;
+        }
+        uint16_t age = note_ons - mixer_voices[i].started;
+        if (found == MIXER_NO_VOICE || (oldest ? age > found_age : age < found_age)) {
+            found = i;
+            found_age = age;
+        }
+    }
+    return found;
+}
+
+uint8_t mixer_note_on(pitch_t pitch, uint8_t volume, uint16_t timbre) {
+    if (pitch == SYNTH_REST) {
+        return MIXER_NO_VOICE;
+    }
+
+    uint8_t voice = find(pitch);
+    if (voice == MIXER_NO_VOICE) {
+        for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+            if (mixer_voices[i].pitch == SYNTH_REST) {
+                voice = i;
+                break;
+            }
+        }
+        if (voice == MIXER_NO_VOICE) {
+            voice = by_age(true);
+            release(voice);
+        }
+        active++;
+    }
+
+    mixer_voice_t *v = &mixer_voices[voice];
+    v->pitch = pitch;
+    v->volume = volume > MIXER_VOLUME_MAX ? MIXER_VOLUME_MAX : volume;
+    v->started = ++note_ons;
+#ifdef MIXER_RENDER
+    v->phase = 0;
+    v->increment = (INCREMENT_BASE / synth_period(pitch)) << INCREMENT_SHIFT;
+    v->duty = timbre >= 256 ? UINT32_MAX : (uint32_t)timbre << 24;
+#else
+    (void)timbre;
+#endif
+    map_set(note_of(pitch), voice);
+    newest = voice;
+    return voice;
+}
+
+bool mixer_note_off(pitch_t pitch) {
+    if (pitch == SYNTH_REST) {
+        return false;
+    }
+    uint8_t voice = find(pitch);
+    if (voice == MIXER_NO_VOICE) {
+        return false;
+    }
+    release(voice);
+    if (voice == newest) {
+        newest = by_age(false);
+    }
+    return true;
+}
+
+uint8_t mixer_active(void) {
+    return active;
+}
+
+uint8_t mixer_newest(void) {
+    return newest;
+}
+
+uint8_t mixer_next(uint8_t voice) {
+    for (uint8_t i = 1; i <= MIXER_VOICES; i++) {
+        uint8_t next = (voice + i) % MIXER_VOICES;
+        if (mixer_voices[next].pitch != SYNTH_REST) {
+            return next;
+        }
+    }
+    return MIXER_NO_VOICE;
+}
+
+#ifdef MIXER_RENDER
+int16_t mixer_sample(void) {
+    int16_t sample = 0;
+    for (uint8_t i = 0; i < MIXER_VOICES; i++) {
+        mixer_voice_t *v = &mixer_voices[i];
+        if (v->pitch == SYNTH_REST) {
+            continue;
+        }
+        int16_t level = v->volume * MIXER_AMPLITUDE;
+        sample += v->phase < v->duty ? level : -level;
+        v->phase += v->increment;
+    }
+    return sample;
+}
+
+void mixer_render_dac(uint16_t *buffer, uint16_t count) {
+    for (uint16_t i = 0; i < count; i++) {
+        buffer[i] = (uint16_t)(mixer_sample() + 0x8000) >> (16 - MIXER_DAC_BITS);
+    }
+}
+#endif
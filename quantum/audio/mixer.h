@@ -0,0 +1,79 @@
+#ifndef MIXER_H
+#define MIXER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "synth.h"
+
+/*
+ * Voice allocator and mixer.
+ *
+ * Notes get one of MIXER_VOICES fixed slots. A note already playing is
+ * restarted in its slot, and when all slots are taken the note that
+ * started first is stolen. A map from the semitone of a pitch to its
+ * slot finds the voice to stop without searching.
+ *
+ * With MIXER_RENDER the mixer sums a square wave of each voice from a
+ * phase accumulator into one sample, so a DAC output could play all voices
+ * at once in the same time whatever the number of notes. No audio output
+ * has a DAC yet, only the tests build it: the PWM output of audio.c plays
+ * one voice at a time and uses the allocator alone.
+ */
+
+#ifndef MIXER_VOICES
+#define MIXER_VOICES 8
+#endif
+#if MIXER_VOICES > 15
+#error MIXER_VOICES has to fit the 4 bits of the note map
+#endif
+
+#define MIXER_NO_VOICE 0xFF
+/* loudest volume, play_note() volumes go up to 0xF */
+#define MIXER_VOLUME_MAX 15
+
+#ifdef MIXER_RENDER
+#ifndef MIXER_SAMPLE_RATE
+#define MIXER_SAMPLE_RATE 22050
+#endif
+
+/* a full volume voice, all of them at once reach INT16_MAX */
+#define MIXER_AMPLITUDE (INT16_MAX / (MIXER_VOLUME_MAX * MIXER_VOICES))
+
+#ifndef MIXER_DAC_BITS
+#define MIXER_DAC_BITS 12
+#endif
+#endif
+
+typedef struct {
+    pitch_t pitch;       // SYNTH_REST: the slot is free
+    uint8_t volume;
+    uint16_t started;    // order of the note ons, oldest is stolen first
+#ifdef MIXER_RENDER
+    uint32_t phase;
+    uint32_t increment;  // phase per sample
+    uint32_t duty;       // phase where the square wave goes low
+#endif
+} mixer_voice_t;
+
+extern mixer_voice_t mixer_voices[MIXER_VOICES];
+
+void mixer_clear(void);
+/* timbre is the duty cycle in 1/256, returns the voice playing the note */
+uint8_t mixer_note_on(pitch_t pitch, uint8_t volume, uint16_t timbre);
+/* false when the note wasn't playing */
+bool mixer_note_off(pitch_t pitch);
+
+uint8_t mixer_active(void);
+/* voice of the last note started, MIXER_NO_VOICE when all are free */
+uint8_t mixer_newest(void);
+/* next playing voice after voice, round the slots */
+uint8_t mixer_next(uint8_t voice);
+
+#ifdef MIXER_RENDER
+/* one signed sample of all voices */
+int16_t mixer_sample(void);
+/* count unsigned MIXER_DAC_BITS samples, silence is the middle */
+void mixer_render_dac(uint16_t *buffer, uint16_t count);
+#endif
+
+#endif
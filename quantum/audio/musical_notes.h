@@ -64,6 +64,8 @@
 #define TIMBRE_50       0.500
 #define TIMBRE_75       0.750
 #define TIMBRE_DEFAULT  TIMBRE_50
+// The duty cycle in 1/256 of the period, as the audio interrupt uses it
+#define TIMBRE_FIXED(timbre) ((uint16_t)((timbre) * 256))
 
 
 // Notes - # = Octave
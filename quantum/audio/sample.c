@@ -0,0 +1,119 @@
+#include "sample.h"
+
+#if F_CPU / SYNTH_PRESCALER / AUDIO_SAMPLE_RATE > 256
+#error "AUDIO_SAMPLE_RATE is too low for an 8 bit PWM duty of the audio timer"
+#endif
+
+void sample_start(sample_reader_t *reader, const audio_sample_t *sample, bool repeat) {
+    reader->sample = sample;
+    reader->position = 0;
+    reader->repeat = repeat;
+    adpcm_init(&reader->adpcm);
+}
+
+bool sample_more(const sample_reader_t *reader) {
+    const audio_sample_t *sample = reader->sample;
+    return sample && sample->count > 0 && (reader->repeat || reader->position < sample->count);
+}
+
+int16_t sample_read(sample_reader_t *reader) {
+    if (!sample_more(reader)) {
+        return 0;
+    }
+    const audio_sample_t *sample = reader->sample;
+    if (reader->position == sample->count) {
+        reader->position = 0;
+        adpcm_init(&reader->adpcm);
+    }
+
+    uint32_t position = reader->position++;
+    if (sample->format == SAMPLE_ADPCM) {
+        uint8_t codes = pgm_read_byte(&sample->data[position / 2]);
+        return adpcm_decode(&reader->adpcm, position & 1 ? codes >> 4 : codes & 0xF);
+    }
+    return ((int16_t)pgm_read_byte(&sample->data[position]) - 0x80) * 256;
+}
+
+sample_output_t sample_output(int16_t sample) {
+    return ((uint32_t)(uint16_t)(sample + 0x8000) * SAMPLE_PERIOD) >> 16;
+}
+
+static sample_reader_t reader;
+static volatile bool playing = false;
+
+/* false when the sample was over before, the output is silence then */
+static bool fill(sample_output_t *output, uint16_t count) {
+    bool more = sample_more(&reader);
+    for (uint16_t i = 0; i < count; i++) {
+        output[i] = sample_output(sample_read(&reader));
+    }
+    return more;
+}
+
+bool sample_playing(void) {
+    return playing;
+}
+
+static sample_output_t buffer[2][SAMPLE_BUFFER_SIZE];
+/* set by sample_task() once a half is decoded, cleared by the interrupt
+ * once it has played it */
+static volatile bool ready[2];
+static volatile uint8_t half;
+static uint8_t offset;
+static volatile bool decoded;
+
+void sample_play(const audio_sample_t *sample, bool repeat) {
+    sample_start(&reader, sample, repeat);
+    half = 0;
+    offset = 0;
+    ready[0] = false;
+    ready[1] = false;
+    decoded = false;
+    playing = true;
+    sample_task();
+}
+
+void sample_stop(void) {
+    playing = false;
+}
+
+void sample_task(void) {
+    if (!playing) {
+        return;
+    }
+    // the half that plays next first
+    uint8_t next = half;
+    for (uint8_t i = 0; i < 2 && !decoded; i++) {
+        uint8_t h = next ^ i;
+        if (!ready[h]) {
+            if (fill(buffer[h], SAMPLE_BUFFER_SIZE)) {
+                ready[h] = true;
+            } else {
+                decoded = true;
+            }
+        }
+    }
+}
+
+bool sample_pop(sample_output_t *output) {
+    if (!playing) {
+        return false;
+    }
+    if (!ready[half]) {
+        if (decoded) {
+            playing = false;
+            return false;
+        }
+        // sample_task() fell behind
+        *output = SAMPLE_PERIOD / 2;
+        return true;
+    }
+
+    *output = buffer[half][offset];
+    if (++offset == SAMPLE_BUFFER_SIZE) {
+        offset = 0;
+        ready[half] = false;
+        half ^= 1;
+    }
+    return true;
+}
@@ -0,0 +1,79 @@
+#ifndef SAMPLE_H
+#define SAMPLE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "progmem.h"
+#include "adpcm.h"
+
+/*
+ * Sample playback from flash.
+ *
+ * Samples are PROGMEM arrays of unsigned 8 bit PCM or of IMA-ADPCM codes,
+ * two to a byte with the first in the low bits, at AUDIO_SAMPLE_RATE.
+ * util/sample_convert.py makes them from WAV files:
+ *
+ *   static const uint8_t PROGMEM click_data[] = { ... };
+ *   static const audio_sample_t click = SAMPLE(click_data, SAMPLE_ADPCM, 1024);
+ *   play_sample(&click, false);
+ *
+ * Playback decodes into one half of a double buffer while the other half
+ * plays, so the output only copies a value per sample.
+ *
+ * The audio.c timer 3 interrupt takes a PWM duty from the buffer each
+ * sample period and sample_task() refills the halves it is done with from
+ * the matrix scan, so SAMPLE_BUFFER_SIZE samples have to last a scan.
+ */
+
+#ifndef AUDIO_SAMPLE_RATE
+#define AUDIO_SAMPLE_RATE 8000
+#endif
+
+/* samples in each half of the buffer */
+#ifndef SAMPLE_BUFFER_SIZE
+#define SAMPLE_BUFFER_SIZE 64
+#endif
+
+#define SAMPLE_PCM8  0
+#define SAMPLE_ADPCM 1
+
+typedef struct {
+    const uint8_t *data;
+    uint32_t count;
+    uint8_t format;
+} audio_sample_t;
+
+#define SAMPLE(data, format, count) { (data), (count), (format) }
+
+/* SAMPLE_ADPCM data is half a byte a sample */
+#define SAMPLE_BYTES(format, count) ((format) == SAMPLE_ADPCM ? ((count) + 1) / 2 : (count))
+
+typedef struct {
+    const audio_sample_t *sample;
+    uint32_t position;
+    adpcm_state_t adpcm;
+    bool repeat;
+} sample_reader_t;
+
+void sample_start(sample_reader_t *reader, const audio_sample_t *sample, bool repeat);
+bool sample_more(const sample_reader_t *reader);
+/* next sample, silence at the end */
+int16_t sample_read(sample_reader_t *reader);
+
+#include "synth.h"
+/* PWM duty in timer ticks of SAMPLE_PERIOD */
+typedef uint8_t sample_output_t;
+#define SAMPLE_PERIOD (SYNTH_CLOCK / AUDIO_SAMPLE_RATE)
+
+sample_output_t sample_output(int16_t sample);
+
+/* starts decoding, audio.c play_sample() starts the output */
+void sample_play(const audio_sample_t *sample, bool repeat);
+void sample_stop(void);
+bool sample_playing(void);
+void sample_task(void);
+
+/* next output value for the timer interrupt, false once the sample is over */
+bool sample_pop(sample_output_t *output);
+
+#endif
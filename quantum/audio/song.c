@@ -0,0 +1,40 @@
+#include "song.h"
+
+void song_start(song_reader_t *reader, const uint8_t *data, uint16_t length) {
+    reader->data = data;
+    reader->length = length;
+    reader->position = 0;
+    reader->duration = 0;
+}
+
+bool song_more(const song_reader_t *reader) {
+    return reader->position < reader->length;
+}
+
+bool song_next(song_reader_t *reader, song_note_t *note) {
+    if (!song_more(reader)) {
+        return false;
+    }
+    uint8_t byte = pgm_read_byte(&reader->data[reader->position++]);
+    if (!(byte & SONG_SAME_DURATION)) {
+        if (!song_more(reader)) {
+            return false;
+        }
+        reader->duration = pgm_read_byte(&reader->data[reader->position++]);
+    }
+    note->note = byte & ~SONG_SAME_DURATION;
+    note->duration = reader->duration;
+    return true;
+}
+
+pitch_t song_pitch(uint8_t note) {
+    if (note == SONG_NOTE_REST) {
+        return SYNTH_REST;
+    }
+    return synth_transpose(synth_pitch(440.0f), ((int16_t)note - SONG_NOTE_A4) * SYNTH_SEMITONE);
+}
+
+uint32_t song_ticks(uint8_t duration, uint8_t tempo) {
+    // duration / 4 * tempo / 100 of 0xFFFF ticks
+    return duration * ((uint32_t)0xFFFF * tempo / 400);
+}
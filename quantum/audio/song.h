@@ -0,0 +1,51 @@
+#ifndef SONG_H
+#define SONG_H
+
+#include <stdint.h>
+#include <stdbool.h>
+#include "progmem.h"
+#include "synth.h"
+#include "song_data.h"
+
+/*
+ * Compact songs, kept in PROGMEM and read a note at a time.
+ *
+ * A note is its MIDI number, 0 for a rest, then its duration in the units
+ * of the float songs (64 is a whole note), 2 bytes instead of 8. A note
+ * with the top bit set takes the duration of the note before it and is
+ * only one byte.
+ *
+ * util/song_convert.py turns the songs of song_list.h into song_data.h:
+ *
+ *   const uint8_t PROGMEM tone_startup[] = SONG_DATA(STARTUP_SOUND);
+ *   PLAY_SONG(tone_startup, false, 0);
+ */
+
+#define SONG_SAME_DURATION 0x80
+#define SONG_NOTE_REST 0
+#define SONG_NOTE_A4 69
+
+#define SONG_DATA(song) { song##_DATA }
+
+typedef struct {
+    uint8_t note;
+    uint8_t duration;
+} song_note_t;
+
+typedef struct {
+    const uint8_t *data;
+    uint16_t length;
+    uint16_t position;
+    uint8_t duration;
+} song_reader_t;
+
+void song_start(song_reader_t *reader, const uint8_t *data, uint16_t length);
+bool song_more(const song_reader_t *reader);
+/* false at the end of the song */
+bool song_next(song_reader_t *reader, song_note_t *note);
+
+pitch_t song_pitch(uint8_t note);
+/* timer ticks of a duration at tempo, like the float songs */
+uint32_t song_ticks(uint8_t duration, uint8_t tempo);
+
+#endif
@@ -0,0 +1,85 @@
+/* Generated by util/song_convert.py from song_list.h, do not edit */
+#ifndef SONG_DATA_H
+#define SONG_DATA_H
+
+#define COIN_SOUND_DATA \
+    0x51, 0x08, 0x58, 0x30
+
+#define ODE_TO_JOY_DATA \
+    0x40, 0x10, 0xC0, 0xC1, 0xC3, 0xC3, 0xC1, 0xC0, 0xBE, 0xBC, 0xBC, 0xBE,\
+    0xC0, 0x40, 0x18, 0x3E, 0x08, 0x3E, 0x20
+
+#define ROCK_A_BYE_BABY_DATA \
+    0x47, 0x18, 0x3E, 0x08, 0x53, 0x10, 0x51, 0x20, 0x4F, 0x10, 0x47, 0x18,\
+    0x4A, 0x08, 0x4F, 0x10, 0x4E, 0x20
+
+#define CLOSE_ENCOUNTERS_5_NOTE_DATA \
+    0x4A, 0x10, 0xCC, 0xC8, 0xBC, 0xC3
+
+#define DOE_A_DEER_DATA \
+    0x3C, 0x18, 0x3E, 0x08, 0x40, 0x18, 0x3C, 0x08, 0x40, 0x10, 0xBC, 0xC0
+
+#define IN_LIKE_FLINT_DATA \
+    0x46, 0x08, 0xC6, 0x47, 0x18, 0x46, 0x08, 0xC7, 0x3D, 0x18, 0x47, 0x08,\
+    0xBD, 0x3F, 0x18, 0x3D, 0x08, 0xC7, 0x46, 0x18, 0x46, 0x08, 0xC6, 0x47,\
+    0x18
+
+#define GOODBYE_SOUND_DATA \
+    0x64, 0x08, 0xDD, 0x58, 0x0C
+
+#define STARTUP_SOUND_DATA \
+    0x64, 0x0C, 0x61, 0x08, 0xD8, 0xDD, 0x61, 0x14
+
+#define QWERTY_SOUND_DATA \
+    0x5C, 0x08, 0xDD, 0x00, 0x04, 0x64, 0x10
+
+#define COLEMAK_SOUND_DATA \
+    0x5C, 0x08, 0xDD, 0x00, 0x04, 0x64, 0x0C, 0x00, 0x04, 0x68, 0x0C
+
+#define DVORAK_SOUND_DATA \
+    0x5C, 0x08, 0xDD, 0x00, 0x04, 0x64, 0x08, 0x00, 0x04, 0x66, 0x08, 0x00,\
+    0x04, 0x64, 0x08
+
+#define PLOVER_SOUND_DATA \
+    0x5C, 0x08, 0xDD, 0x00, 0x04, 0x64, 0x0C, 0x00, 0x04, 0x69, 0x0C
+
+#define PLOVER_GOODBYE_SOUND_DATA \
+    0x5C, 0x08, 0xDD, 0x00, 0x04, 0x69, 0x0C, 0x00, 0x04, 0x64, 0x0C
+
+#define MUSIC_SCALE_SOUND_DATA \
+    0x51, 0x08, 0xD3, 0xD5, 0xD6, 0xD8, 0xDA, 0xDC, 0xDD
+
+#define CAPS_LOCK_ON_SOUND_DATA \
+    0x39, 0x08, 0xBB
+
+#define CAPS_LOCK_OFF_SOUND_DATA \
+    0x3B, 0x08, 0xB9
+
+#define SCROLL_LOCK_ON_SOUND_DATA \
+    0x3E, 0x08, 0xC0
+
+#define SCROLL_LOCK_OFF_SOUND_DATA \
+    0x40, 0x08, 0xBE
+
+#define NUM_LOCK_ON_SOUND_DATA \
+    0x4A, 0x08, 0xCC
+
+#define NUM_LOCK_OFF_SOUND_DATA \
+    0x4C, 0x08, 0xCA
+
+#define UNICODE_WINDOWS_DATA \
+    0x53, 0x08, 0x58, 0x04
+
+#define UNICODE_LINUX_DATA \
+    0x58, 0x08, 0x53, 0x04
+
+#define ONE_UP_SOUND_DATA \
+    0x58, 0x10, 0xDB, 0xE4, 0xE0, 0xE2, 0xE7
+
+#define SONIC_RING_DATA \
+    0x58, 0x08, 0xDB, 0x60, 0x30
+
+#define ZELDA_PUZZLE_DATA \
+    0x4F, 0x10, 0xCE, 0xCB, 0xC5, 0xC4, 0xCC, 0xD0, 0x54, 0x30
+
+#endif
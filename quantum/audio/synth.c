@@ -0,0 +1,226 @@
+#include "progmem.h"
+#include "synth.h"
+
+#define PERIOD_STEPS 192  // per octave
+#define LOG_STEPS 64
+
+/* 0xFFFF * 2^(-i/192), an octave down from period 0xFFFF in 1/16 semitones */
+static const uint16_t PROGMEM period_lut[PERIOD_STEPS + 1] = {
+    65535, 65299, 65064, 64829, 64595, 64363, 64131, 63900,
+    63669, 63440, 63211, 62984, 62757, 62530, 62305, 62081,
+    61857, 61634, 61412, 61190, 60970, 60750, 60531, 60313,
+    60096, 59879, 59664, 59449, 59234, 59021, 58808, 58596,
+    58385, 58175, 57965, 57756, 57548, 57341, 57134, 56928,
+    56723, 56519, 56315, 56112, 55910, 55708, 55507, 55307,
+    55108, 54910, 54712, 54515, 54318, 54122, 53927, 53733,
+    53539, 53346, 53154, 52963, 52772, 52582, 52392, 52203,
+    52015, 51828, 51641, 51455, 51269, 51085, 50901, 50717,
+    50534, 50352, 50171, 49990, 49810, 49630, 49452, 49273,
+    49096, 48919, 48743, 48567, 48392, 48218, 48044, 47871,
+    47698, 47526, 47355, 47184, 47014, 46845, 46676, 46508,
+    46340, 46173, 46007, 45841, 45676, 45511, 45347, 45184,
+    45021, 44859, 44697, 44536, 44376, 44216, 44056, 43898,
+    43739, 43582, 43425, 43268, 43112, 42957, 42802, 42648,
+    42494, 42341, 42188, 42036, 41885, 41734, 41584, 41434,
+    41284, 41136, 40987, 40840, 40693, 40546, 40400, 40254,
+    40109, 39965, 39821, 39677, 39534, 39392, 39250, 39108,
+    38967, 38827, 38687, 38548, 38409, 38270, 38132, 37995,
+    37858, 37722, 37586, 37450, 37315, 37181, 37047, 36913,
+    36780, 36648, 36516, 36384, 36253, 36122, 35992, 35862,
+    35733, 35604, 35476, 35348, 35221, 35094, 34968, 34842,
+    34716, 34591, 34466, 34342, 34218, 34095, 33972, 33850,
+    33728, 33606, 33485, 33364, 33244, 33124, 33005, 32886,
+    32768,
+};
+
+/* 3072 * log2(1 + i/64), the pitch of a float mantissa */
+static const uint16_t PROGMEM log_lut[LOG_STEPS + 1] = {
+    0, 69, 136, 203, 269, 333, 397, 460,
+    522, 583, 643, 703, 762, 820, 877, 933,
+    989, 1044, 1098, 1152, 1205, 1258, 1309, 1361,
+    1411, 1461, 1511, 1560, 1608, 1656, 1704, 1751,
+    1797, 1843, 1888, 1933, 1978, 2022, 2066, 2109,
+    2152, 2194, 2236, 2278, 2319, 2360, 2400, 2440,
+    2480, 2520, 2559, 2597, 2636, 2674, 2711, 2749,
+    2786, 2823, 2859, 2895, 2931, 2967, 3002, 3037,
+    3072,
+};
+
+/* 3072 * log2(vibrato_lut[i]) */
+static const int8_t PROGMEM vibrato_pitch_lut[20] = {
+    10, 19, 26, 30, 32, 30, 26, 19, 10, 0,
+    -10, -19, -26, -30, -32, -30, -26, -19, -10, 0,
+};
+#define VIBRATO_LENGTH (sizeof(vibrato_pitch_lut) * SYNTH_VIBRATO_STEP)
+
+/* glissando moves 440 / 2 semitones a second, a step of
+ * 220 * 256 / frequency pitch per interrupt, which is period * GLIDE_STEP >> 16 */
+#define GLIDE_STEP ((uint32_t)(220UL * 256 * 65536 / SYNTH_CLOCK))
+/* 440 / frequency is period * VIBRATO_440 with a 24 bit fraction */
+#define VIBRATO_440 ((uint32_t)(440ULL * (1UL << 24) / SYNTH_CLOCK))
+
+uint16_t synth_period(pitch_t pitch) {
+    uint8_t octave = 0;
+    while (pitch >= SYNTH_OCTAVE) {
+        pitch -= SYNTH_OCTAVE;
+        octave++;
+    }
+    if (octave > 15) {
+        return 1;
+    }
+    uint8_t i = pitch >> 4;
+    uint8_t frac = pitch & 15;
+    uint16_t a = pgm_read_word(&period_lut[i]);
+    uint16_t b = pgm_read_word(&period_lut[i + 1]);
+    uint16_t period = a - (((a - b) * frac + 8) >> 4);
+    if (octave) {
+        period = ((uint32_t)period + (1 << (octave - 1))) >> octave;
+    }
+    return period ? period : 1;
+}
+
+pitch_t synth_pitch_of_period(uint16_t period) {
+    if (!period) {
+        return 0xFFFF;
+    }
+    uint32_t pitch = 0;
+    while (period < 0x8000) {
+        period <<= 1;
+        pitch += SYNTH_OCTAVE;
+    }
+    // last entry at or above period
+    uint8_t lo = 0, hi = PERIOD_STEPS;
+    while (hi - lo > 1) {
+        uint8_t mid = (lo + hi) / 2;
+        if (pgm_read_word(&period_lut[mid]) >= period) {
+            lo = mid;
+        } else {
+            hi = mid;
+        }
+    }
+    uint16_t a = pgm_read_word(&period_lut[lo]);
+    uint16_t b = pgm_read_word(&period_lut[hi]);
+    pitch += lo * 16;
+    if (a > period) {
+        pitch += ((a - period) * 16 + (a - b) / 2) / (a - b);
+    }
+    if (pitch > 0xFFFF) {
+        return 0xFFFF;
+    }
+    return pitch ? pitch : 1;
+}
+
+typedef union {
+    float f;
+    uint32_t bits;
+} float_bits_t;
+
+/* 3072 * log2(x) for x > 0 */
+static int32_t log_pitch(float x) {
+    float_bits_t v = { .f = x };
+    int16_t exponent = (int16_t)((v.bits >> 23) & 0xFF) - 127;
+    uint32_t mantissa = v.bits & 0x7FFFFF;
+    uint8_t i = mantissa >> 17;
+    uint32_t frac = mantissa & 0x1FFFF;
+    uint16_t a = pgm_read_word(&log_lut[i]);
+    uint16_t b = pgm_read_word(&log_lut[i + 1]);
+    return (int32_t)exponent * SYNTH_OCTAVE + a + (((b - a) * frac + 0x10000) >> 17);
+}
+
+static bool is_positive(float x) {
+    float_bits_t v = { .f = x };
+    // sign clear and not zero or denormal
+    return !(v.bits & 0x80000000) && (v.bits & 0x7F800000);
+}
+
+pitch_t synth_pitch(float frequency) {
+    if (!is_positive(frequency)) {
+        return SYNTH_REST;
+    }
+    int32_t pitch = log_pitch(frequency) - log_pitch((float)SYNTH_CLOCK / 0xFFFF);
+    if (pitch < 1) {
+        return 1;
+    }
+    if (pitch > 0xFFFF) {
+        return 0xFFFF;
+    }
+    return pitch;
+}
+
+uint32_t synth_mul(float x, uint16_t k) {
+    if (!is_positive(x)) {
+        return 0;
+    }
+    float_bits_t v = { .f = x };
+    int16_t exponent = (int16_t)((v.bits >> 23) & 0xFF) - 127;
+    // x = mantissa * 2^(exponent - 15), with 16 bits of mantissa
+    uint32_t mantissa = ((v.bits & 0x7FFFFF) | 0x800000) >> 8;
+    uint32_t product = mantissa * k;
+    int16_t shift = exponent - 15;
+    if (shift >= 0) {
+        if (shift > 15) {
+            return UINT32_MAX;
+        }
+        return product << shift;
+    }
+    if (shift < -31) {
+        return 0;
+    }
+    return product >> -shift;
+}
+
+pitch_t synth_transpose(pitch_t pitch, int16_t offset) {
+    if (pitch == SYNTH_REST) {
+        return SYNTH_REST;
+    }
+    int32_t moved = (int32_t)pitch + offset;
+    if (moved < 1) {
+        return 1;
+    }
+    if (moved > 0xFFFF) {
+        return 0xFFFF;
+    }
+    return moved;
+}
+
+static uint16_t glide_step(pitch_t pitch) {
+    uint16_t step = ((uint32_t)synth_period(pitch) * GLIDE_STEP + 0x8000) >> 16;
+    return step ? step : 1;
+}
+
+pitch_t synth_glide(pitch_t pitch, pitch_t target) {
+    if (pitch == SYNTH_REST || target == SYNTH_REST) {
+        return target;
+    }
+    // moves by its own step until it is within a step of target from target
+    uint16_t near = glide_step(target);
+    if (pitch < target && target - pitch > near) {
+        return synth_transpose(pitch, glide_step(pitch));
+    }
+    if (pitch > target && pitch - target > near) {
+        return synth_transpose(pitch, -glide_step(pitch));
+    }
+    return target;
+}
+
+int8_t synth_vibrato_offset(uint8_t index) {
+    return pgm_read_byte(&vibrato_pitch_lut[index % sizeof(vibrato_pitch_lut)]);
+}
+
+pitch_t synth_vibrato(synth_vibrato_t *vibrato, pitch_t pitch) {
+    if (pitch == SYNTH_REST) {
+        return SYNTH_REST;
+    }
+    int16_t offset = (int8_t)pgm_read_byte(&vibrato_pitch_lut[vibrato->phase / SYNTH_VIBRATO_STEP]);
+    offset = ((int32_t)offset * vibrato->strength) / 256;
+
+    // rate * (1 + 440 / frequency) entries, faster for low notes
+    uint32_t per_440 = ((uint32_t)synth_period(pitch) * VIBRATO_440) >> 13;
+    uint32_t phase = vibrato->phase + ((uint16_t)vibrato->rate << 3) + ((per_440 * vibrato->rate + 0x80) >> 8);
+    while (phase >= VIBRATO_LENGTH) {
+        phase -= VIBRATO_LENGTH;
+    }
+    vibrato->phase = phase;
+
+    return synth_transpose(pitch, offset);
+}
@@ -0,0 +1,57 @@
+#ifndef SYNTH_H
+#define SYNTH_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/*
+ * Integer synthesis core for the audio timer interrupt.
+ *
+ * Notes are kept as pitches, 1/256 semitone steps above the lowest
+ * frequency the 16-bit timer can play, so glissando and vibrato are
+ * additions and the timer period is a lookup in a PROGMEM table of one
+ * octave. Floats only come in with the frequencies of the songs and the
+ * keymap API, synth_pitch() and synth_mul() turn them into integers from
+ * their bits without any floating point maths.
+ */
+
+#ifndef SYNTH_PRESCALER
+#define SYNTH_PRESCALER 8
+#endif
+/* timer ticks per second */
+#define SYNTH_CLOCK ((uint32_t)F_CPU / SYNTH_PRESCALER)
+
+#define SYNTH_SEMITONE 256
+#define SYNTH_OCTAVE (12 * SYNTH_SEMITONE)
+
+/* pitch 0 is period 0xFFFF, SYNTH_CLOCK / 0xFFFF Hz, and means a rest */
+typedef uint16_t pitch_t;
+#define SYNTH_REST 0
+
+/* phase steps of one vibrato_lut entry */
+#define SYNTH_VIBRATO_STEP 2048
+
+typedef struct {
+    uint16_t phase;     // vibrato_lut entry in SYNTH_VIBRATO_STEPs
+    uint8_t  rate;      // entries per interrupt with an 8 bit fraction, * (1 + 440 / frequency)
+    uint16_t strength;  // 256 is the depth of vibrato_lut
+} synth_vibrato_t;
+
+/* timer ticks of a period */
+uint16_t synth_period(pitch_t pitch);
+pitch_t synth_pitch_of_period(uint16_t period);
+/* 0 and negative frequencies are rests */
+pitch_t synth_pitch(float frequency);
+/* x * k rounded down, 0 for negative x */
+uint32_t synth_mul(float x, uint16_t k);
+
+/* pitch moved up or down by offset, kept in range, rests stay rests */
+pitch_t synth_transpose(pitch_t pitch, int16_t offset);
+/* one interrupt of glissando towards target, at 220 semitones a second */
+pitch_t synth_glide(pitch_t pitch, pitch_t target);
+/* vibrato_lut entry as a pitch offset */
+int8_t synth_vibrato_offset(uint8_t index);
+/* pitch with vibrato, moves the vibrato on by one interrupt */
+pitch_t synth_vibrato(synth_vibrato_t *vibrato, pitch_t pitch);
+
+#endif
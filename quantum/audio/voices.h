@@ -15,14 +15,17 @@
  */
 #include <stdint.h>
 #include <stdbool.h>
+#if defined(__AVR__)
 #include <avr/io.h>
 #include <util/delay.h>
+#endif
 #include "luts.h"
+#include "synth.h"
 
 #ifndef VOICES_H
 #define VOICES_H
 
-float voice_envelope(float frequency);
+pitch_t voice_envelope(pitch_t pitch);
 
 typedef enum {
     default_voice,
@@ -0,0 +1,36 @@
+#include "backlight_pwm.h"
+#include "progmem.h"
+#include "led_tables.h"
+
+uint16_t backlight_level_duty(uint8_t level, uint8_t levels) {
+  if (!levels || level >= levels) {
+    return level ? BACKLIGHT_DUTY_MAX : 0;
+  }
+  uint8_t lightness = (uint16_t)level * 255 / levels;
+  return pgm_read_byte(&CIE1931_CURVE[lightness]) * 257;
+}
+
+/* Breathing Sleep LED brighness(PWM On period) table
+ * (64[steps] * 4[duration]) / 64[PWM periods/s] = 4 second breath cycle
+ *
+ * http://www.wolframalpha.com/input/?i=%28sin%28+x%2F64*pi%29**8+*+255%2C+x%3D0+to+63
+ * (0..63).each {|x| p ((sin(x/64.0*PI)**8)*255).to_i }
+ */
+static const uint8_t breathing_table[BREATHING_STEPS] PROGMEM = {
+  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   2,   4,   6,  10,
+ 15,  23,  32,  44,  58,  74,  93, 113, 135, 157, 179, 199, 218, 233, 245, 252,
+255, 252, 245, 233, 218, 199, 179, 157, 135, 113,  93,  74,  58,  44,  32,  23,
+ 15,  10,   6,   4,   2,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
+};
+
+bool breathing_next(breathing_t *breathing, uint16_t *duty) {
+  uint8_t step = ((uint8_t)(breathing->index++ >> breathing->speed)) & (BREATHING_STEPS - 1);
+
+  *duty = (uint16_t)(pgm_read_byte(&breathing_table[step]) * 257) >> breathing->intensity;
+  return !((breathing->halt == BREATHING_HALT_ON && step == BREATHING_TOP) ||
+           (breathing->halt == BREATHING_HALT_OFF && step == BREATHING_STEPS - 1));
+}
+
+uint16_t breathing_rescale(uint16_t index, uint8_t old_speed, uint8_t new_speed) {
+  return (((uint8_t)(index >> old_speed)) & (BREATHING_STEPS - 1)) << new_speed;
+}
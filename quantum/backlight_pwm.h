@@ -0,0 +1,40 @@
+#ifndef BACKLIGHT_PWM_H
+#define BACKLIGHT_PWM_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* Duty cycles for the backlight, 0 off to 0xFFFF fully on, for both the
+ * timer 1 PWM and the software PWM on other pins.
+ */
+#define BACKLIGHT_DUTY_MAX 0xFFFF
+
+/* level out of levels through the CIE1931 curve */
+uint16_t backlight_level_duty(uint8_t level, uint8_t levels);
+
+#define BREATHING_NO_HALT  0
+#define BREATHING_HALT_OFF 1
+#define BREATHING_HALT_ON  2
+
+/* The breathing envelope is a 64 step PROGMEM table, index advances
+ * once per PWM period and each step takes 1 << speed periods. The
+ * value is shifted down by intensity.
+ */
+typedef struct {
+  uint16_t index;
+  uint8_t speed;
+  uint8_t intensity;
+  uint8_t halt;
+} breathing_t;
+
+#define BREATHING_STEPS 64
+/* index of the brightest step */
+#define BREATHING_TOP   0x20
+
+/* duty for the next period. false when breathing halts here, the
+ * brightest step for BREATHING_HALT_ON, the last for BREATHING_HALT_OFF */
+bool breathing_next(breathing_t *breathing, uint16_t *duty);
+/* index of the same step at another speed */
+uint16_t breathing_rescale(uint16_t index, uint8_t old_speed, uint8_t new_speed);
+
+#endif
@@ -0,0 +1,32 @@
+/* Copyright 2017 Yang Liu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#ifndef COLOR_H
+#define COLOR_H
+
+#include <stdint.h>
+
+typedef struct {
+  uint8_t r;
+  uint8_t g;
+  uint8_t b;
+} RGB;
+
+/* hue in degrees (0-359), the result is linear, before any CIE1931
+ * correction. Integer multiplies and shifts only, the divisions by 60
+ * are done with reciprocals that give the exact same result. */
+RGB hsv_to_rgb(uint16_t hue, uint8_t sat, uint8_t val);
+
+#endif
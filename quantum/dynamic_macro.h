@@ -19,6 +19,10 @@
 #define DYNAMIC_MACROS_H
 
 #include "action_layer.h"
+#include "timer.h"
+#ifdef DYNAMIC_MACRO_EEPROM
+#include "eeprom.h"
+#endif
 
 #ifndef DYNAMIC_MACRO_SIZE
 /* May be overridden with a custom value. Be aware that the effective
@@ -29,10 +33,27 @@
  * Usually it should be fine to set the macro size to at least 256 but
  * there have been reports of it being too much in some users' cases,
  * so 128 is considered a safe default.
+ *
+ * The buffer takes as much RAM as DYNAMIC_MACRO_SIZE key records used to,
+ * but each event is now stored in 2 bytes (plus 1-3 bytes of timing with
+ * DYNAMIC_MACRO_TIMING), so about three times as many events fit.
  */
 #define DYNAMIC_MACRO_SIZE 128
 #endif
 
+#ifndef DYNAMIC_MACRO_BYTES
+/* Size of the buffer in bytes, define to trade macro length for RAM. */
+#define DYNAMIC_MACRO_BYTES (DYNAMIC_MACRO_SIZE * sizeof(keyrecord_t))
+#endif
+
+#if defined(DYNAMIC_MACRO_EEPROM) && !defined(DYNAMIC_MACRO_EEPROM_ADDR)
+/* Where the macros are stored, needs DYNAMIC_MACRO_BYTES + 6 bytes. On
+ * ChibiOS this is the EEPROM emulated in flash. They are written from
+ * the matrix scan after a recording ends, DYNAMIC_MACRO_EEPROM_CHUNK
+ * bytes at a time. */
+#define DYNAMIC_MACRO_EEPROM_ADDR 32
+#endif
+
 /* DYNAMIC_MACRO_RANGE must be set as the last element of user's
  * "planck_keycodes" enum prior to including this header. This allows
  * us to 'extend' it.
@@ -64,6 +85,281 @@ void dynamic_macro_led_blink(void)
 #define DYNAMIC_MACRO_CURRENT_CAPACITY(BEGIN, END2) \
     ((int)(direction * ((END2) - (BEGIN)) + 1))
 
+/* Recorded events are packed into bytes:
+ *
+ *   [P|D|row:6] [col:8] [delay: varint, only if D is set]
+ *
+ * P is set for a key press, D when the time since the previous event is
+ * stored as 7 bits per byte, least significant first, with the high bit
+ * set on all but the last byte.
+ *
+ * Macro 2 is written right-to-left, the bytes of an event are then simply
+ * laid out backwards, reading in the same direction gives them back in
+ * order.
+ */
+#define DYNAMIC_MACRO_PRESSED 0x80
+#define DYNAMIC_MACRO_DELAY   0x40
+#define DYNAMIC_MACRO_ROW     0x3F
+
+static inline void dynamic_macro_put(uint8_t **p, int8_t direction, uint8_t byte)
+{
+    **p = byte;
+    *p += direction;
+}
+
+static inline uint8_t dynamic_macro_get(uint8_t **p, int8_t direction)
+{
+    uint8_t byte = **p;
+    *p += direction;
+    return byte;
+}
+
+/* Number of bytes an event with the given delay takes. */
+static uint8_t dynamic_macro_event_size(uint16_t delay)
+{
+    uint8_t size = 2;
+    if (delay) {
+        do {
+            size++;
+            delay >>= 7;
+        } while (delay);
+    }
+    return size;
+}
+
+static void dynamic_macro_encode(
+    uint8_t **p, int8_t direction, keyrecord_t *record, uint16_t delay)
+{
+    uint8_t head = record->event.key.row & DYNAMIC_MACRO_ROW;
+    if (record->event.pressed) head |= DYNAMIC_MACRO_PRESSED;
+    if (delay) head |= DYNAMIC_MACRO_DELAY;
+    dynamic_macro_put(p, direction, head);
+    dynamic_macro_put(p, direction, record->event.key.col);
+    if (delay) {
+        while (delay >= 0x80) {
+            dynamic_macro_put(p, direction, (delay & 0x7F) | 0x80);
+            delay >>= 7;
+        }
+        dynamic_macro_put(p, direction, delay);
+    }
+}
+
+/* Returns the delay before the decoded event. */
+static uint16_t dynamic_macro_decode(
+    uint8_t **p, int8_t direction, keyrecord_t *record)
+{
+    uint8_t head = dynamic_macro_get(p, direction);
+    uint16_t delay = 0;
+
+    *record = (keyrecord_t){};
+    record->event.key.row = head & DYNAMIC_MACRO_ROW;
+    record->event.key.col = dynamic_macro_get(p, direction);
+    record->event.pressed = head & DYNAMIC_MACRO_PRESSED;
+    if (head & DYNAMIC_MACRO_DELAY) {
+        uint8_t shift = 0;
+        uint8_t byte;
+        do {
+            byte = dynamic_macro_get(p, direction);
+            delay |= (uint16_t)(byte & 0x7F) << shift;
+            shift += 7;
+        } while (byte & 0x80);
+    }
+    return delay;
+}
+
+/* Both macros use the same buffer but read/write on different
+ * ends of it.
+ *
+ * Macro1 is written left-to-right starting from the beginning of
+ * the buffer.
+ *
+ * Macro2 is written right-to-left starting from the end of the
+ * buffer.
+ *
+ * &macro_buffer   macro_end
+ *  v                   v
+ * +------------------------------------------------------------+
+ * |>>>>>> MACRO1 >>>>>>      <<<<<<<<<<<<< MACRO2 <<<<<<<<<<<<<|
+ * +------------------------------------------------------------+
+ *                           ^                                 ^
+ *                         r_macro_end                  r_macro_buffer
+ *
+ * During the recording when one macro encounters the end of the
+ * other macro, the recording is stopped. Apart from this, there
+ * are no arbitrary limits for the macros' length in relation to
+ * each other: for example one can either have two medium sized
+ * macros or one long macro and one short macro. Or even one empty
+ * and one using the whole buffer.
+ */
+static uint8_t macro_buffer[DYNAMIC_MACRO_BYTES];
+
+/* Pointer to the first buffer element after the first macro.
+ * Initially points to the very beginning of the buffer since the
+ * macro is empty. */
+static uint8_t *macro_end = macro_buffer;
+
+/* The other end of the macro buffer. Serves as the beginning of
+ * the second macro. */
+static uint8_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_BYTES - 1;
+
+/* Like macro_end but for the second macro. */
+static uint8_t *r_macro_end = macro_buffer + DYNAMIC_MACRO_BYTES - 1;
+
+/* State of the macro being played back from matrix_scan_dynamic_macro(). */
+static struct {
+    uint8_t *pointer;
+    uint8_t *end;
+    int8_t direction;
+    bool playing;
+    bool has_next;
+    bool started;
+    keyrecord_t next;
+    uint16_t deadline;
+    uint32_t saved_layer_state;
+} dynamic_macro_player;
+
+#ifdef DYNAMIC_MACRO_TIMING
+/* Time of the last recorded event. */
+static uint16_t dynamic_macro_last_time;
+#endif
+
+#ifdef DYNAMIC_MACRO_EEPROM
+#define DYNAMIC_MACRO_EEPROM_MAGIC 0xD7
+
+static uint8_t dynamic_macro_crc8(uint8_t crc, uint8_t byte)
+{
+    crc ^= byte;
+    for (uint8_t i = 0; i < 8; i++) {
+        crc = crc & 0x80 ? (crc << 1) ^ 0x07 : crc << 1;
+    }
+    return crc;
+}
+
+#ifndef DYNAMIC_MACRO_EEPROM_CHUNK
+/* Bytes written on each matrix scan while saving. A changed byte keeps
+ * the AVR busy for about 3.4ms, so saving a whole recording at once
+ * would stall the keyboard for seconds. */
+#define DYNAMIC_MACRO_EEPROM_CHUNK 1
+#endif
+
+/* Layout: magic, macro_end and r_macro_end offsets (little endian),
+ * the buffer, then a CRC-8 over the header and the used ends of the
+ * buffer. The free middle of the buffer is not stored. */
+#define DYNAMIC_MACRO_EEPROM_HEADER 5
+
+/* Saving in progress, a few bytes per matrix scan. */
+static struct {
+    bool pending;
+    uint16_t offset;
+    uint16_t end1;
+    uint16_t end2;
+    uint8_t crc;
+} dynamic_macro_saver;
+
+/* Offset in the layout that comes after offset, skipping the free part
+ * of the buffer. */
+static uint16_t dynamic_macro_eeprom_next(uint16_t offset, uint16_t end1, uint16_t end2)
+{
+    offset++;
+    if (offset == DYNAMIC_MACRO_EEPROM_HEADER + end1) {
+        offset = DYNAMIC_MACRO_EEPROM_HEADER + end2 + 1;
+    }
+    return offset;
+}
+
+/* Starts saving the macros, dynamic_macro_save_task() writes them. */
+void dynamic_macro_save(void)
+{
+    dynamic_macro_saver.end1 = macro_end - macro_buffer;
+    dynamic_macro_saver.end2 = r_macro_end - macro_buffer;
+    dynamic_macro_saver.offset = 0;
+    dynamic_macro_saver.crc = 0;
+    dynamic_macro_saver.pending = true;
+}
+
+bool dynamic_macro_saving(void)
+{
+    return dynamic_macro_saver.pending;
+}
+
+/* Writes the next DYNAMIC_MACRO_EEPROM_CHUNK bytes, the CRC goes last so
+ * a save that was cut short is not loaded. */
+void dynamic_macro_save_task(void)
+{
+    uint8_t *addr = (uint8_t *)DYNAMIC_MACRO_EEPROM_ADDR;
+    uint16_t end1 = dynamic_macro_saver.end1;
+    uint16_t end2 = dynamic_macro_saver.end2;
+    uint8_t header[DYNAMIC_MACRO_EEPROM_HEADER] = {
+        DYNAMIC_MACRO_EEPROM_MAGIC, end1 & 0xFF, end1 >> 8, end2 & 0xFF, end2 >> 8
+    };
+
+    for (uint8_t i = 0; i < DYNAMIC_MACRO_EEPROM_CHUNK && dynamic_macro_saver.pending; i++) {
+        uint16_t offset = dynamic_macro_saver.offset;
+        uint8_t byte;
+
+        if (offset == DYNAMIC_MACRO_EEPROM_HEADER + DYNAMIC_MACRO_BYTES) {
+            eeprom_update_byte(addr + offset, dynamic_macro_saver.crc);
+            dynamic_macro_saver.pending = false;
+            return;
+        }
+        if (offset < DYNAMIC_MACRO_EEPROM_HEADER) {
+            byte = header[offset];
+        } else {
+            byte = macro_buffer[offset - DYNAMIC_MACRO_EEPROM_HEADER];
+        }
+        eeprom_update_byte(addr + offset, byte);
+        dynamic_macro_saver.crc = dynamic_macro_crc8(dynamic_macro_saver.crc, byte);
+        dynamic_macro_saver.offset = dynamic_macro_eeprom_next(offset, end1, end2);
+    }
+}
+
+/* Returns false, leaving the macros empty, if nothing valid was stored. */
+bool dynamic_macro_load(void)
+{
+    uint8_t *addr = (uint8_t *)DYNAMIC_MACRO_EEPROM_ADDR;
+    uint8_t header[DYNAMIC_MACRO_EEPROM_HEADER];
+    uint8_t crc = 0;
+
+    for (uint8_t i = 0; i < sizeof(header); i++) {
+        header[i] = eeprom_read_byte(addr + i);
+        crc = dynamic_macro_crc8(crc, header[i]);
+    }
+    uint16_t end1 = header[1] | (header[2] << 8);
+    uint16_t end2 = header[3] | (header[4] << 8);
+    if (header[0] != DYNAMIC_MACRO_EEPROM_MAGIC ||
+        end1 > DYNAMIC_MACRO_BYTES || end2 >= DYNAMIC_MACRO_BYTES ||
+        end1 > end2 + 1) {
+        return false;
+    }
+    uint16_t offset = dynamic_macro_eeprom_next(DYNAMIC_MACRO_EEPROM_HEADER - 1, end1, end2);
+    while (offset < DYNAMIC_MACRO_EEPROM_HEADER + DYNAMIC_MACRO_BYTES) {
+        uint8_t byte = eeprom_read_byte(addr + offset);
+        macro_buffer[offset - DYNAMIC_MACRO_EEPROM_HEADER] = byte;
+        crc = dynamic_macro_crc8(crc, byte);
+        offset = dynamic_macro_eeprom_next(offset, end1, end2);
+    }
+    if (crc != eeprom_read_byte(addr + offset)) {
+        macro_end = macro_buffer;
+        r_macro_end = r_macro_buffer;
+        return false;
+    }
+    macro_end = macro_buffer + end1;
+    r_macro_end = macro_buffer + end2;
+    return true;
+}
+
+static void dynamic_macro_load_once(void)
+{
+    static bool loaded = false;
+    if (!loaded) {
+        loaded = true;
+        if (dynamic_macro_load()) {
+            dprintln("dynamic macro: loaded from eeprom");
+        }
+    }
+}
+#endif
+
 /**
  * Start recording of the dynamic macro.
  *
@@ -71,7 +367,7 @@ void dynamic_macro_led_blink(void)
  * @param[in]  macro_buffer  The macro buffer used to initialize macro_pointer.
  */
 void dynamic_macro_record_start(
-    keyrecord_t **macro_pointer, keyrecord_t *macro_buffer)
+    uint8_t **macro_pointer, uint8_t *macro_buffer)
 {
     dprintln("dynamic macro recording: started");
 
@@ -80,33 +376,85 @@ void dynamic_macro_record_start(
     clear_keyboard();
     layer_clear();
     *macro_pointer = macro_buffer;
+
+#ifdef DYNAMIC_MACRO_EEPROM
+    /* The buffer is about to change, the save starts over at the end. */
+    dynamic_macro_saver.pending = false;
+#endif
 }
 
 /**
- * Play the dynamic macro.
+ * Start playing the dynamic macro. The events are sent one per matrix
+ * scan, or at their recorded times with DYNAMIC_MACRO_TIMING, from
+ * matrix_scan_dynamic_macro().
  *
  * @param macro_buffer[in] The beginning of the macro buffer being played.
  * @param macro_end[in]    The element after the last macro buffer element.
  * @param direction[in]    Either +1 or -1, which way to iterate the buffer.
  */
 void dynamic_macro_play(
-    keyrecord_t *macro_buffer, keyrecord_t *macro_end, int8_t direction)
+    uint8_t *macro_buffer, uint8_t *macro_end, int8_t direction)
 {
     dprintf("dynamic macro: slot %d playback\n", DYNAMIC_MACRO_CURRENT_SLOT());
 
-    uint32_t saved_layer_state = layer_state;
+    if (dynamic_macro_player.playing) {
+        return;
+    }
+
+    dynamic_macro_player.saved_layer_state = layer_state;
 
     clear_keyboard();
     layer_clear();
 
-    while (macro_buffer != macro_end) {
-        process_record(macro_buffer);
-        macro_buffer += direction;
+    dynamic_macro_player.pointer = macro_buffer;
+    dynamic_macro_player.end = macro_end;
+    dynamic_macro_player.direction = direction;
+    dynamic_macro_player.has_next = false;
+    dynamic_macro_player.started = false;
+    dynamic_macro_player.deadline = timer_read();
+    dynamic_macro_player.playing = true;
+}
+
+/**
+ * Send the next event of the macro being played, if it is due.
+ */
+void dynamic_macro_play_task(void)
+{
+    if (!dynamic_macro_player.playing) {
+        return;
     }
 
-    clear_keyboard();
+    if (!dynamic_macro_player.has_next) {
+        if (dynamic_macro_player.pointer == dynamic_macro_player.end) {
+            clear_keyboard();
+            layer_state = dynamic_macro_player.saved_layer_state;
+            dynamic_macro_player.playing = false;
+            return;
+        }
+        dynamic_macro_player.deadline += dynamic_macro_decode(
+            &dynamic_macro_player.pointer,
+            dynamic_macro_player.direction,
+            &dynamic_macro_player.next);
+        dynamic_macro_player.has_next = true;
+    }
+
+    if ((int16_t)(timer_read() - dynamic_macro_player.deadline) < 0) {
+        return;
+    }
+    /* The delays are kept relative to the first event, whenever the
+     * first scan after the play key came around. */
+    if (!dynamic_macro_player.started) {
+        dynamic_macro_player.deadline = timer_read();
+        dynamic_macro_player.started = true;
+    }
+    dynamic_macro_player.next.event.time = timer_read() | 1;
+    process_record(&dynamic_macro_player.next);
+    dynamic_macro_player.has_next = false;
+}
 
-    layer_state = saved_layer_state;
+bool dynamic_macro_is_playing(void)
+{
+    return dynamic_macro_player.playing;
 }
 
 /**
@@ -119,24 +467,34 @@ void dynamic_macro_play(
  * @param record[in]     The current keypress.
  */
 void dynamic_macro_record_key(
-    keyrecord_t *macro_buffer,
-    keyrecord_t **macro_pointer,
-    keyrecord_t *macro2_end,
+    uint8_t *macro_buffer,
+    uint8_t **macro_pointer,
+    uint8_t *macro2_end,
     int8_t direction,
     keyrecord_t *record)
 {
+    uint16_t delay = 0;
+
     /* If we've just started recording, ignore all the key releases. */
     if (!record->event.pressed && *macro_pointer == macro_buffer) {
         dprintln("dynamic macro: ignoring a leading key-up event");
         return;
     }
 
+#ifdef DYNAMIC_MACRO_TIMING
+    if (*macro_pointer != macro_buffer) {
+        delay = TIMER_DIFF_16(record->event.time, dynamic_macro_last_time);
+    }
+#endif
+
     /* The other end of the other macro is the last buffer element it
      * is safe to use before overwriting the other macro.
      */
-    if (*macro_pointer - direction != macro2_end) {
-        **macro_pointer = *record;
-        *macro_pointer += direction;
+    if (dynamic_macro_event_size(delay) <= direction * (macro2_end - *macro_pointer) + 1) {
+        dynamic_macro_encode(macro_pointer, direction, record, delay);
+#ifdef DYNAMIC_MACRO_TIMING
+        dynamic_macro_last_time = record->event.time;
+#endif
     } else {
         dynamic_macro_led_blink();
     }
@@ -153,21 +511,30 @@ void dynamic_macro_record_key(
  * pointer to the end of the macro.
  */
 void dynamic_macro_record_end(
-    keyrecord_t *macro_buffer,
-    keyrecord_t *macro_pointer,
+    uint8_t *macro_buffer,
+    uint8_t *macro_pointer,
     int8_t direction,
-    keyrecord_t **macro_end)
+    uint8_t **macro_end)
 {
     dynamic_macro_led_blink();
 
     /* Do not save the keys being held when stopping the recording,
-     * i.e. the keys used to access the layer DYN_REC_STOP is on.
+     * i.e. the keys used to access the layer DYN_REC_STOP is on. The
+     * events can't be walked backwards, so cut after the last release.
      */
-    while (macro_pointer != macro_buffer &&
-           (macro_pointer - direction)->event.pressed) {
-        dprintln("dynamic macro: trimming a trailing key-down event");
-        macro_pointer -= direction;
+    uint8_t *p = macro_buffer;
+    uint8_t *last_release_end = macro_buffer;
+    keyrecord_t record;
+    while (p != macro_pointer) {
+        dynamic_macro_decode(&p, direction, &record);
+        if (!record.event.pressed) {
+            last_release_end = p;
+        }
     }
+    if (last_release_end != macro_pointer) {
+        dprintln("dynamic macro: trimming trailing key-down events");
+    }
+    macro_pointer = last_release_end;
 
     dprintf(
         "dynamic macro: slot %d saved, length: %d\n",
@@ -175,6 +542,10 @@ void dynamic_macro_record_end(
         DYNAMIC_MACRO_CURRENT_LENGTH(macro_buffer, macro_pointer));
 
     *macro_end = macro_pointer;
+
+#ifdef DYNAMIC_MACRO_EEPROM
+    dynamic_macro_save();
+#endif
 }
 
 /* Handle the key events related to the dynamic macros. Should be
@@ -189,52 +560,18 @@ void dynamic_macro_record_end(
  */
 bool process_record_dynamic_macro(uint16_t keycode, keyrecord_t *record)
 {
-    /* Both macros use the same buffer but read/write on different
-     * ends of it.
-     *
-     * Macro1 is written left-to-right starting from the beginning of
-     * the buffer.
-     *
-     * Macro2 is written right-to-left starting from the end of the
-     * buffer.
-     *
-     * &macro_buffer   macro_end
-     *  v                   v
-     * +------------------------------------------------------------+
-     * |>>>>>> MACRO1 >>>>>>      <<<<<<<<<<<<< MACRO2 <<<<<<<<<<<<<|
-     * +------------------------------------------------------------+
-     *                           ^                                 ^
-     *                         r_macro_end                  r_macro_buffer
-     *
-     * During the recording when one macro encounters the end of the
-     * other macro, the recording is stopped. Apart from this, there
-     * are no arbitrary limits for the macros' length in relation to
-     * each other: for example one can either have two medium sized
-     * macros or one long macro and one short macro. Or even one empty
-     * and one using the whole buffer.
-     */
-    static keyrecord_t macro_buffer[DYNAMIC_MACRO_SIZE];
-
-    /* Pointer to the first buffer element after the first macro.
-     * Initially points to the very beginning of the buffer since the
-     * macro is empty. */
-    static keyrecord_t *macro_end = macro_buffer;
-
-    /* The other end of the macro buffer. Serves as the beginning of
-     * the second macro. */
-    static keyrecord_t *const r_macro_buffer = macro_buffer + DYNAMIC_MACRO_SIZE - 1;
-
-    /* Like macro_end but for the second macro. */
-    static keyrecord_t *r_macro_end = r_macro_buffer;
-
     /* A persistent pointer to the current macro position (iterator)
      * used during the recording. */
-    static keyrecord_t *macro_pointer = NULL;
+    static uint8_t *macro_pointer = NULL;
 
     /* 0   - no macro is being recorded right now
      * 1,2 - either macro 1 or 2 is being recorded */
     static uint8_t macro_id = 0;
 
+#ifdef DYNAMIC_MACRO_EEPROM
+    dynamic_macro_load_once();
+#endif
+
     if (macro_id == 0) {
         /* No macro recording in progress. */
         if (!record->event.pressed) {
@@ -292,6 +629,16 @@ bool process_record_dynamic_macro(uint16_t keycode, keyrecord_t *record)
     return true;
 }
 
+/* Replaces the weak no-op in quantum.c, runs on every matrix scan. */
+void matrix_scan_dynamic_macro(void)
+{
+#ifdef DYNAMIC_MACRO_EEPROM
+    dynamic_macro_load_once();
+    dynamic_macro_save_task();
+#endif
+    dynamic_macro_play_task();
+}
+
 #undef DYNAMIC_MACRO_CURRENT_SLOT
 #undef DYNAMIC_MACRO_CURRENT_LENGTH
 #undef DYNAMIC_MACRO_CURRENT_CAPACITY
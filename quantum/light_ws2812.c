@@ -201,6 +201,73 @@ void ws2812_sendarray(uint8_t *data,uint16_t datlen)
   ws2812_sendarray_mask(data,datlen,_BV(RGB_DI_PIN & 0xF));
 }
 
+#ifdef WS2812_SPI
+
+/*
+  The strip is on MOSI and clocked out by the SPI peripheral, see
+  ws2812_encode.h. Interrupts stay on: an ISR between two SPI bytes only
+  makes a low phase longer. pinmask is ignored. SS and SCK (B0 and B1 on
+  the ATmega32U4) are outputs while a frame is sent, so they can't be
+  used for anything else, the matrix included.
+*/
+
+#if defined(__AVR_ATmega32U4__) || defined(__AVR_ATmega16U4__) || \
+    defined(__AVR_AT90USB1286__) || defined(__AVR_AT90USB646__)
+#  define WS2812_SPI_DDR  DDRB
+#  define WS2812_SPI_PORT PORTB
+#  define WS2812_SPI_SS   0
+#  define WS2812_SPI_SCK  1
+#  define WS2812_SPI_MOSI 2
+#elif defined(__AVR_ATmega32A__)
+#  define WS2812_SPI_DDR  DDRB
+#  define WS2812_SPI_PORT PORTB
+#  define WS2812_SPI_SS   4
+#  define WS2812_SPI_MOSI 5
+#  define WS2812_SPI_SCK  7
+#else
+#  error "WS2812_SPI: SPI pins of this MCU are unknown"
+#endif
+
+#if F_CPU == 16000000
+#  define WS2812_SPSR 0             // F_CPU / 4
+#elif F_CPU == 8000000
+#  define WS2812_SPSR _BV(SPI2X)    // F_CPU / 2
+#else
+#  error "WS2812_SPI needs F_CPU at 8 or 16MHz for a 4MHz SPI clock"
+#endif
+
+void inline ws2812_sendarray_mask(uint8_t *data,uint16_t datlen,uint8_t maskhi)
+{
+  const uint8_t taken = _BV(WS2812_SPI_SS) | _BV(WS2812_SPI_SCK);
+  uint8_t bits[WS2812_SPI_BYTES];
+  uint8_t spcr_prev = SPCR;
+  uint8_t spsr_prev = SPSR;
+  uint8_t ddr_prev = WS2812_SPI_DDR & taken;
+  uint8_t port_prev = WS2812_SPI_PORT & taken;
+
+  // SS has to be an output to stay master, MOSI idles low. SS and SCK get
+  // their direction and level back after the frame
+  WS2812_SPI_PORT &= ~_BV(WS2812_SPI_MOSI);
+  WS2812_SPI_DDR |= taken | _BV(WS2812_SPI_MOSI);
+  SPCR = _BV(SPE) | _BV(MSTR);
+  SPSR = WS2812_SPSR;
+
+  while (datlen--) {
+    ws2812_encode_byte(*data++, bits);
+    for (uint8_t i = 0; i < WS2812_SPI_BYTES; i++) {
+      SPDR = bits[i];
+      while (!(SPSR & _BV(SPIF)));
+    }
+  }
+
+  SPCR = spcr_prev;
+  SPSR = spsr_prev;
+  WS2812_SPI_PORT = (WS2812_SPI_PORT & ~taken) | port_prev;
+  WS2812_SPI_DDR = (WS2812_SPI_DDR & ~taken) | ddr_prev;
+}
+
+#else
+
 /*
   This routine writes an array of bytes with RGB values to the Dataout pin
   using the fast 800kHz clockless WS2811/2812 protocol.
@@ -340,3 +407,150 @@ w_nop16
 
   SREG=sreg_prev;
 }
+
+/*
+  Parallel output: one port write per bit drives every strip. The bytes of
+  the strips are transposed into 8 port wide slices for the whole frame
+  before interrupts are turned off, so the timing loop only loads them.
+  The port and DDR are the ones of RGB_DI_PIN.
+
+  Loop timing, cycles are counted from the rising edge:
+    rise    -> zeros fall: out + w1
+    rise    -> ones fall : out + w1 + out + w2
+    period               : ld, or, 3 out, dec, brne + w1 + w2 + w3
+  Between bytes the low phase of the last bit is 7 cycles longer (sbiw,
+  brne, ld, or, ldi, less the brne not taken), under 0.5us at 16MHz and
+  shorter than the C loop between the bytes of ws2812_sendarray_mask().
+*/
+#define wp_fixedlow    1
+#define wp_fixedhigh   2
+#define wp_fixedtotal  9
+
+#define wp1 (w_zerocycles-wp_fixedlow)
+#define wp2 (w_onecycles-wp_fixedhigh-wp1)
+#define wp3 (w_totalcycles-wp_fixedtotal-wp1-wp2)
+
+#if wp1>0
+  #define wp1_nops wp1
+#else
+  #define wp1_nops  0
+#endif
+
+#if wp2>0
+  #define wp2_nops wp2
+#else
+  #define wp2_nops  0
+#endif
+
+#if wp3>0
+  #define wp3_nops wp3
+#else
+  #define wp3_nops  0
+#endif
+
+/* bytes of the longest strip, a frame takes WS2812_PARALLEL_RECORD bytes
+ * of RAM for each of them */
+#ifndef WS2812_PARALLEL_MAX_BYTES
+  #ifdef RGBLED_NUM
+    #define WS2812_PARALLEL_MAX_BYTES (RGBLED_NUM * sizeof(LED_TYPE))
+  #else
+    #define WS2812_PARALLEL_MAX_BYTES 48
+  #endif
+#endif
+
+static uint8_t ws2812_parallel_buffer[WS2812_PARALLEL_MAX_BYTES * WS2812_PARALLEL_RECORD];
+
+void ws2812_send_parallel(const ws2812_strip_t *strips, uint8_t count)
+{
+  uint8_t *frame = ws2812_parallel_buffer;
+  uint8_t ctr,tmp,maskhi,allpins,masklo;
+  uint8_t sreg_prev;
+  uint16_t bytes;
+
+  allpins = 0;
+  for (uint8_t i = 0; i < count; i++) {
+    allpins |= _BV(strips[i].pin);
+    if (strips[i].length > WS2812_PARALLEL_MAX_BYTES) {
+      dprintf("ws2812: strip on pin %d cut to WS2812_PARALLEL_MAX_BYTES\n", strips[i].pin);
+    }
+  }
+  bytes = ws2812_parallel_frame(strips, count, frame, WS2812_PARALLEL_MAX_BYTES);
+  if (!bytes) return;
+
+  _SFR_IO8((RGB_DI_PIN >> 4) + 1) |= allpins;
+  masklo = ~allpins&_SFR_IO8((RGB_DI_PIN >> 4) + 2);
+
+  sreg_prev=SREG;
+  cli();
+
+  asm volatile(
+  "byte%=:               \n\t"
+  "       ld    %2,%a3+  \n\t"    //  strips that already ended stay low
+  "       or    %2,%6    \n\t"
+  "       ldi   %0,8     \n\t"
+  "loop%=:               \n\t"
+  "       ld    %1,%a3+  \n\t"
+  "       or    %1,%6    \n\t"
+  "       out   %5,%2    \n\t"    //  [01] - re
+#if (wp1_nops&1)
+w_nop1
+#endif
+#if (wp1_nops&2)
+w_nop2
+#endif
+#if (wp1_nops&4)
+w_nop4
+#endif
+#if (wp1_nops&8)
+w_nop8
+#endif
+#if (wp1_nops&16)
+w_nop16
+#endif
+  "       out   %5,%1    \n\t"    //  [02] - fe-low of the '0' strips
+#if (wp2_nops&1)
+  w_nop1
+#endif
+#if (wp2_nops&2)
+  w_nop2
+#endif
+#if (wp2_nops&4)
+  w_nop4
+#endif
+#if (wp2_nops&8)
+  w_nop8
+#endif
+#if (wp2_nops&16)
+  w_nop16
+#endif
+  "       out   %5,%6    \n\t"    //  [+1] - fe-high of the '1' strips
+#if (wp3_nops&1)
+w_nop1
+#endif
+#if (wp3_nops&2)
+w_nop2
+#endif
+#if (wp3_nops&4)
+w_nop4
+#endif
+#if (wp3_nops&8)
+w_nop8
+#endif
+#if (wp3_nops&16)
+w_nop16
+#endif
+
+  "       dec   %0       \n\t"    //  [+2]
+  "       brne  loop%=   \n\t"    //  [+4], ld and or are [+7]
+  "       sbiw  %4,1     \n\t"    //  next byte, 7 more low cycles
+  "       brne  byte%=   \n\t"
+  :	"=&d" (ctr), "=&r" (tmp), "=&r" (maskhi), "+e" (frame), "+w" (bytes)
+  :	"I" (_SFR_IO_ADDR(_SFR_IO8((RGB_DI_PIN >> 4) + 2))), "r" (masklo)
+  :	"memory"
+  );
+
+  SREG=sreg_prev;
+  _delay_us(50);
+}
+
+#endif
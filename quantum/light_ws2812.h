@@ -23,8 +23,12 @@
 #ifndef LIGHT_WS2812_H_
 #define LIGHT_WS2812_H_
 
+#ifdef __AVR__
 #include <avr/io.h>
 #include <avr/interrupt.h>
+#endif
+#include <stdint.h>
+#include "ws2812_encode.h"
 //#include "ws2812_config.h"
 //#include "i2cmaster.h"
 
@@ -64,6 +68,22 @@ void ws2812_setleds     (LED_TYPE *ledarray, uint16_t number_of_leds);
 void ws2812_setleds_pin (LED_TYPE *ledarray, uint16_t number_of_leds,uint8_t pinmask);
 void ws2812_setleds_rgbw(LED_TYPE *ledarray, uint16_t number_of_leds);
 
+/*
+ * Up to 8 strips on pins of the RGB_DI_PIN port, sent at the same time:
+ * the whole frame takes as long as the longest strip instead of the sum
+ * of all of them. The frame is transposed into RAM first, 9 bytes for
+ * each byte of the longest strip up to WS2812_PARALLEL_MAX_BYTES, by
+ * default a byte for each of RGBLED_NUM LEDs. Not available with
+ * WS2812_SPI.
+ *
+ *   ws2812_strip_t strips[] = {
+ *     { (uint8_t *)left,  LEFT_LEDS * 3,  4 },  // on Px4
+ *     { (uint8_t *)right, RIGHT_LEDS * 3, 5 },  // on Px5
+ *   };
+ *   ws2812_send_parallel(strips, 2);
+ */
+void ws2812_send_parallel(const ws2812_strip_t *strips, uint8_t count);
+
 /*
  * Old interface / Internal functions
  *
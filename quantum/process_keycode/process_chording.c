@@ -15,62 +15,147 @@
  */
 
 #include "process_chording.h"
+#ifdef STENO_ENABLE
+  #include "process_steno.h"
+#endif
 
-bool keys_chord(uint8_t keys[]) {
-  uint8_t keys_size = sizeof(keys)/sizeof(keys[0]);
-  bool pass = true;
-  uint8_t in = 0;
-  for (uint8_t i = 0; i < chord_key_count; i++) {
-    bool found = false;
-    for (uint8_t j = 0; j < keys_size; j++) {
-      if (chord_keys[i] == (keys[j] & 0xFF)) {
-        in++; // detects key in chord
-        found = true;
-        break;
-      }
+static bool chording = false;
+static uint8_t chord_key_down = 0;
+static chord_t chord = 0;
+
+/* outputs waiting to be typed, and the one being typed */
+static const char *queue[CHORD_QUEUE_SIZE];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+static const char *output = NULL;
+
+/* the character key in the last report */
+static uint8_t last_key = 0;
+static bool last_shift = false;
+
+__attribute__ ((weak))
+bool process_chord_user(chord_t chord) {
+  return true;
+}
+
+#ifdef CHORD_COUNT
+static const char *chord_lookup(chord_t chord) {
+  uint16_t lo = 0;
+  uint16_t hi = CHORD_COUNT;
+  while (lo < hi) {
+    uint16_t mid = lo + (hi - lo) / 2;
+    chord_t entry = pgm_read_dword(&chord_dictionary[mid].chord);
+    if (entry == chord) {
+      return pgm_read_ptr(&chord_dictionary[mid].output);
     }
-    if (found)
-      continue;
-    if (chord_keys[i] != 0)  {
-      pass = false; // makes sure rest are blank
+    if (entry < chord) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
     }
   }
-  return (pass && (in == keys_size));
+  return NULL;
 }
+#endif
 
-bool process_chording(uint16_t keycode, keyrecord_t *record) {
-  if (keycode >= QK_CHORDING && keycode <= QK_CHORDING_MAX) {
-    if (record->event.pressed) {
-      if (!chording) {
-        chording = true;
-        for (uint8_t i = 0; i < CHORDING_MAX; i++)
-          chord_keys[i] = 0;
-        chord_key_count = 0;
-        chord_key_down = 0;
-      }
-      chord_keys[chord_key_count] = (keycode & 0xFF);
-      chord_key_count++;
-      chord_key_down++;
-      return false;
-    } else {
-      if (chording) {
-        chord_key_down--;
-        if (chord_key_down == 0) {
-          chording = false;
-          // Chord Dictionary
-          if (keys_chord((uint8_t[]){KC_ENTER, KC_SPACE})) {
-            register_code(KC_A);
-            unregister_code(KC_A);
-            return false;
-          }
-          for (uint8_t i = 0; i < chord_key_count; i++) {
-            register_code(chord_keys[i]);
-            unregister_code(chord_keys[i]);
-            return false;
-          }
+void chording_send_string(const char *str) {
+  if (queue_count == CHORD_QUEUE_SIZE) {
+    dprintf("chording: queue full, see CHORD_QUEUE_SIZE\n");
+    return;
+  }
+  queue[(queue_head + queue_count) % CHORD_QUEUE_SIZE] = str;
+  queue_count++;
+}
+
+static void release_last(void) {
+  del_key(last_key);
+  if (last_shift) {
+    del_weak_mods(MOD_BIT(KC_LSFT));
+  }
+  last_key = 0;
+  last_shift = false;
+}
+
+void matrix_scan_chording(void) {
+  uint8_t c = 0;
+  while (!c) {
+    if (!output) {
+      if (!queue_count) {
+        if (last_key) {
+          release_last();
+          send_keyboard_report();
         }
+        return;
       }
+      output = queue[queue_head];
+      queue_head = (queue_head + 1) % CHORD_QUEUE_SIZE;
+      queue_count--;
+    }
+    c = pgm_read_byte(output);
+    if (!c) {
+      output = NULL;
     }
   }
-  return true;
+
+  uint8_t keycode = pgm_read_byte(&ascii_to_qwerty_keycode_lut[c & 0x7F]);
+  bool shift = pgm_read_byte(&ascii_to_qwerty_shift_lut[c & 0x7F]);
+  if (last_key) {
+    bool same = last_key == keycode || last_shift != shift;
+    release_last();
+    if (same) {
+      // the host wouldn't see a new key press, release first
+      send_keyboard_report();
+      return;
+    }
+  }
+  if (shift) {
+    add_weak_mods(MOD_BIT(KC_LSFT));
+  }
+  add_key(keycode);
+  send_keyboard_report();
+  last_key = keycode;
+  last_shift = shift;
+  output++;
+}
+
+bool chording_busy(void) {
+  return output || queue_count || last_key;
+}
+
+static void chord_stroke(chord_t chord) {
+#ifdef STENO_ENABLE
+  if (steno_send(chord)) {
+    return;
+  }
+#endif
+#ifdef CHORD_COUNT
+  const char *str = chord_lookup(chord);
+  if (str) {
+    chording_send_string(str);
+  }
+#endif
+}
+
+bool process_chording(uint16_t keycode, keyrecord_t *record) {
+  if (keycode < QK_CHORDING || keycode > QK_CHORDING_MAX) {
+    return true;
+  }
+  uint8_t key = keycode & 0xFF;
+  if (record->event.pressed) {
+    if (!chording) {
+      chording = true;
+      chord = 0;
+      chord_key_down = 0;
+    }
+    if (key < sizeof(chord_t) * 8) {
+      chord |= CHORD_BIT(key);
+    }
+    chord_key_down++;
+  } else if (chording && chord_key_down && --chord_key_down == 0) {
+    chording = false;
+    if (process_chord_user(chord)) {
+      chord_stroke(chord);
+    }
+  }
+  return false;
 }
@@ -19,14 +19,68 @@
 
 #include "quantum.h"
 
-// Chording stuff
-#define CHORDING_MAX 4
-bool chording = false;
+/* Chord keys are CH(0) to CH(31). All keys pressed while any of them is
+ * held make up one chord, a bitmask with bit n for CH(n), and when the
+ * last one is released the chord is looked up in chord_dictionary:
+ *
+ *   #define CHORD_COUNT 2   // in config.h
+ *
+ *   CHORD_OUTPUT(the, "the ");
+ *   CHORD_OUTPUT(of, "of ");
+ *
+ *   const chord_entry_t PROGMEM chord_dictionary[CHORD_COUNT] = {
+ *     { STN(TL) | STN(E), the },
+ *     { STN(O) | STN(FR), of },
+ *   };
+ *
+ * The entries must be sorted by chord, lookups are a binary search so a
+ * stroke takes at most a dozen compares even with thousands of entries.
+ * The output is typed from the matrix scan, one keyboard report per scan,
+ * releasing the previous character in the same report as the next one is
+ * pressed where the host can tell them apart.
+ */
+#define CH(n) (QK_CHORDING | (n))
+
+typedef uint32_t chord_t;
+
+#define CHORD_BIT(n) ((chord_t)1 << (n))
+
+/* steno keys in steno order, CH(STN_xx) for the keymap and STN(xx) for
+ * the dictionary */
+enum steno_keys {
+  STN_NUM = 0,
+  STN_SL, STN_TL, STN_KL, STN_PL, STN_WL, STN_HL, STN_RL,
+  STN_A, STN_O, STN_STAR, STN_E, STN_U,
+  STN_FR, STN_RR, STN_PR, STN_BR, STN_LR, STN_GR, STN_TR, STN_SR, STN_DR, STN_ZR,
+  STN_KEYS
+};
 
-uint8_t chord_keys[CHORDING_MAX] = {0};
-uint8_t chord_key_count = 0;
-uint8_t chord_key_down = 0;
+#define STN(key) CHORD_BIT(STN_ ## key)
+
+typedef struct {
+  chord_t chord;
+  const char *output;   // PROGMEM string, see CHORD_OUTPUT
+} chord_entry_t;
+
+#define CHORD_OUTPUT(name, str) static const char name[] PROGMEM = str
+
+#ifdef CHORD_COUNT
+extern const chord_entry_t chord_dictionary[CHORD_COUNT];
+#endif
+
+/* Outputs waiting to be typed, a stroke is dropped when this is full */
+#ifndef CHORD_QUEUE_SIZE
+  #define CHORD_QUEUE_SIZE 8
+#endif
 
 bool process_chording(uint16_t keycode, keyrecord_t *record);
+void matrix_scan_chording(void);
+bool chording_busy(void);
+/* type a PROGMEM string the way dictionary output is typed */
+void chording_send_string(const char *str);
+
+/* Called with every stroke before the dictionary, return false when the
+ * chord was handled */
+bool process_chord_user(chord_t chord);
 
 #endif
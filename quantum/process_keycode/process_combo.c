@@ -16,13 +16,14 @@
 
 #include "process_combo.h"
 #include "print.h"
+#include "deadline.h"
 
 
-#define COMBO_TIMER_ELAPSED -1
+#define COMBO_TIMER_ELAPSED ((uint16_t)-1)
 
 
 __attribute__ ((weak))
-combo_t key_combos[] = {
+combo_t key_combos[COMBO_COUNT] = {
 
 };
 
@@ -33,6 +34,134 @@ void process_combo_event(uint8_t combo_index, bool pressed) {
 
 static uint8_t current_combo_index = 0;
 
+/* Combos waiting for COMBO_TERM, so matrix_scan_combo() can skip the rest */
+static uint8_t combo_timers[(COMBO_COUNT + 7) / 8];
+
+static inline void combo_timer_start(uint8_t index)
+{
+    key_combos[index].timer = timer_read();
+    combo_timers[index / 8] |= 1 << (index % 8);
+    if (!deadline_pending(matrix_scan_combo)) {
+        deadline_in(matrix_scan_combo, COMBO_TERM + 1);
+    }
+}
+
+static inline void combo_timer_stop(uint8_t index, uint16_t timer)
+{
+    key_combos[index].timer = timer;
+    combo_timers[index / 8] &= ~(1 << (index % 8));
+}
+
+#if COMBO_INDEX_SIZE > 0
+#if COMBO_INDEX_SIZE > 255
+typedef uint16_t combo_index_t;
+#else
+typedef uint8_t combo_index_t;
+#endif
+
+/* The combos using combo_keys[k] are combo_refs[combo_starts[k]] up to
+ * combo_refs[combo_starts[k + 1]], combo_keys is sorted.
+ */
+static uint16_t combo_keys[COMBO_INDEX_KEYS];
+static combo_index_t combo_starts[COMBO_INDEX_KEYS + 1];
+static uint8_t combo_refs[COMBO_INDEX_SIZE];
+static uint8_t combo_key_count;
+static bool combo_index_ready;
+static bool combo_index_valid;
+
+/* Position of keycode in combo_keys, or where it would go */
+static uint8_t combo_key_position(uint16_t keycode)
+{
+    uint8_t lo = 0;
+    uint8_t hi = combo_key_count;
+    while (lo < hi) {
+        uint8_t mid = lo + (hi - lo) / 2;
+        if (combo_keys[mid] < keycode) {
+            lo = mid + 1;
+        } else {
+            hi = mid;
+        }
+    }
+    return lo;
+}
+
+/* A combo listing a key twice is only indexed once for it */
+static bool combo_key_repeated(const uint16_t *keys, uint8_t count)
+{
+    uint16_t key = pgm_read_word(&keys[count]);
+    for (uint8_t i = 0; i < count; ++i) {
+        if (pgm_read_word(&keys[i]) == key) return true;
+    }
+    return false;
+}
+
+static bool combo_index_build(void)
+{
+    uint16_t total = 0;
+
+    combo_key_count = 0;
+    for (uint8_t i = 0; i < COMBO_COUNT; ++i) {
+        const uint16_t *keys = key_combos[i].keys;
+        for (uint8_t count = 0; ; ++count) {
+            uint16_t key = pgm_read_word(&keys[count]);
+            if (COMBO_END == key) break;
+            if (combo_key_repeated(keys, count)) continue;
+            if (++total > COMBO_INDEX_SIZE) return false;
+
+            uint8_t k = combo_key_position(key);
+            if (k == combo_key_count || combo_keys[k] != key) {
+                if (combo_key_count == COMBO_INDEX_KEYS) return false;
+                for (uint8_t j = combo_key_count; j > k; --j) {
+                    combo_keys[j] = combo_keys[j - 1];
+                    combo_starts[j + 1] = combo_starts[j];
+                }
+                combo_keys[k] = key;
+                combo_starts[k + 1] = 0;
+                combo_key_count++;
+            }
+            combo_starts[k + 1]++;
+        }
+    }
+
+    /* Counts to positions, each key's refs then get filled in combo order */
+    combo_starts[0] = 0;
+    for (uint8_t k = 0; k < combo_key_count; ++k) {
+        combo_starts[k + 1] += combo_starts[k];
+    }
+    for (uint8_t i = 0; i < COMBO_COUNT; ++i) {
+        const uint16_t *keys = key_combos[i].keys;
+        for (uint8_t count = 0; ; ++count) {
+            uint16_t key = pgm_read_word(&keys[count]);
+            if (COMBO_END == key) break;
+            if (combo_key_repeated(keys, count)) continue;
+            combo_refs[combo_starts[combo_key_position(key)]++] = i;
+        }
+    }
+    for (uint8_t k = combo_key_count; k > 0; --k) {
+        combo_starts[k] = combo_starts[k - 1];
+    }
+    combo_starts[0] = 0;
+    return true;
+}
+#endif
+
+/* Call after changing key_combos at runtime, runs on the first key
+ * event otherwise.
+ */
+void process_combo_init(void)
+{
+    for (uint8_t i = 0; i < sizeof(combo_timers); ++i) {
+        combo_timers[i] = 0;
+    }
+#if COMBO_INDEX_SIZE > 0
+    combo_index_ready = true;
+    combo_index_valid = combo_index_build();
+    if (!combo_index_valid) {
+        dprintln("combo: index too small, see COMBO_INDEX_SIZE");
+    }
+#endif
+}
+
 static inline void send_combo(uint16_t action, bool pressed)
 {
     if (action) {
@@ -50,8 +179,9 @@ static inline void send_combo(uint16_t action, bool pressed)
 #define NO_COMBO_KEYS_ARE_DOWN      (0 == combo->state)
 #define KEY_STATE_DOWN(key)         do{ combo->state |= (1<<key); } while(0)
 #define KEY_STATE_UP(key)           do{ combo->state &= ~(1<<key); } while(0)
-static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *record) 
+static bool process_single_combo(uint8_t combo_index, uint16_t keycode, keyrecord_t *record)
 {
+    combo_t *combo = &key_combos[combo_index];
     uint8_t count = 0;
     uint8_t index = -1;
     /* Find index of keycode and number of combo keys */
@@ -73,9 +203,9 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
         if (is_combo_active) {
             if (ALL_COMBO_KEYS_ARE_DOWN) { /* Combo was pressed */
                 send_combo(combo->keycode, true);
-                combo->timer = COMBO_TIMER_ELAPSED;
+                combo_timer_stop(combo_index, COMBO_TIMER_ELAPSED);
             } else { /* Combo key was pressed */
-                combo->timer = timer_read();
+                combo_timer_start(combo_index);
 #ifdef COMBO_ALLOW_ACTION_KEYS
                 combo->prev_record = *record;
 #else
@@ -99,14 +229,14 @@ static bool process_single_combo(combo_t *combo, uint16_t keycode, keyrecord_t *
             send_keyboard_report();
             unregister_code16(keycode);
 #endif
-            combo->timer = 0;            
+            combo_timer_stop(combo_index, 0);
         }
 
-        KEY_STATE_UP(index);        
+        KEY_STATE_UP(index);
     }
 
     if (NO_COMBO_KEYS_ARE_DOWN) {
-        combo->timer = 0;
+        combo_timer_stop(combo_index, 0);
     }
 
     return is_combo_active;
@@ -116,26 +246,72 @@ bool process_combo(uint16_t keycode, keyrecord_t *record)
 {
     bool is_combo_key = false;
 
-    for (current_combo_index = 0; current_combo_index < COMBO_COUNT; ++current_combo_index) {
-        combo_t *combo = &key_combos[current_combo_index];
-        is_combo_key |= process_single_combo(combo, keycode, record);
-    }    
+#if COMBO_INDEX_SIZE > 0
+    if (!combo_index_ready) {
+        process_combo_init();
+    }
+    if (combo_index_valid) {
+        uint8_t k = combo_key_position(keycode);
+        if (k == combo_key_count || combo_keys[k] != keycode) {
+            return true;
+        }
+        for (combo_index_t r = combo_starts[k]; r < combo_starts[k + 1]; ++r) {
+            current_combo_index = combo_refs[r];
+            is_combo_key |= process_single_combo(current_combo_index, keycode, record);
+        }
+        return !is_combo_key;
+    }
+#endif
+
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        current_combo_index = i;
+        is_combo_key |= process_single_combo(current_combo_index, keycode, record);
+    }
 
     return !is_combo_key;
 }
 
+/* Run matrix_scan_combo() again when the oldest running timer expires */
+static void combo_schedule(void)
+{
+    uint16_t next = UINT16_MAX;
+
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        if (!combo_timers[i / 8]) {
+            i |= 7;
+            continue;
+        }
+        combo_t *combo = &key_combos[i];
+        if (combo->timer && combo->timer != COMBO_TIMER_ELAPSED) {
+            uint16_t elapsed = timer_elapsed(combo->timer);
+            uint16_t left = elapsed > COMBO_TERM ? 0 : COMBO_TERM + 1 - elapsed;
+            if (left < next) next = left;
+        }
+    }
+
+    if (next == UINT16_MAX) {
+        deadline_cancel(matrix_scan_combo);
+    } else {
+        deadline_in(matrix_scan_combo, next);
+    }
+}
+
 void matrix_scan_combo(void)
 {
-    for (int i = 0; i < COMBO_COUNT; ++i) {
+    for (uint16_t i = 0; i < COMBO_COUNT; ++i) {
+        if (!combo_timers[i / 8]) {
+            i |= 7;
+            continue;
+        }
         combo_t *combo = &key_combos[i];
-        if (combo->timer && 
-            combo->timer != COMBO_TIMER_ELAPSED && 
+        if (combo->timer &&
+            combo->timer != COMBO_TIMER_ELAPSED &&
             timer_elapsed(combo->timer) > COMBO_TERM) {
-            
+
             /* This disables the combo, meaning key events for this
-             * combo will be handled by the next processors in the chain 
+             * combo will be handled by the next processors in the chain
              */
-            combo->timer = COMBO_TIMER_ELAPSED;
+            combo_timer_stop(i, COMBO_TIMER_ELAPSED);
 
 #ifdef COMBO_ALLOW_ACTION_KEYS
             process_action(&combo->prev_record, 
@@ -147,4 +323,5 @@ void matrix_scan_combo(void)
 #endif
         }
     }
+    combo_schedule();
 }
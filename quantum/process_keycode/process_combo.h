@@ -52,7 +52,21 @@ typedef struct
 #define COMBO_TERM TAPPING_TERM
 #endif
 
+/* Key events only go to the combos using that key, found through an
+ * index built from key_combos on the first event. COMBO_INDEX_SIZE is
+ * the number of keys of all combos together, COMBO_INDEX_KEYS the number
+ * of different keycodes among them. If the combos don't fit every combo
+ * sees every event again, 0 saves the RAM of the index.
+ */
+#ifndef COMBO_INDEX_SIZE
+#define COMBO_INDEX_SIZE (COMBO_COUNT * 3)
+#endif
+#ifndef COMBO_INDEX_KEYS
+#define COMBO_INDEX_KEYS (COMBO_COUNT * 2 < 64 ? COMBO_COUNT * 2 : 64)
+#endif
+
 bool process_combo(uint16_t keycode, keyrecord_t *record);
+void process_combo_init(void);
 void matrix_scan_combo(void);
 void process_combo_event(uint8_t combo_index, bool pressed);
 
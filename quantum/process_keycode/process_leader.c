@@ -15,6 +15,7 @@
  */
 
 #include "process_leader.h"
+#include "deadline.h"
 
 __attribute__ ((weak))
 void leader_start(void) {}
@@ -26,9 +27,102 @@ void leader_end(void) {}
 bool leading = false;
 uint16_t leader_time = 0;
 
-uint16_t leader_sequence[5] = {0, 0, 0, 0, 0};
+uint16_t leader_sequence[LEADER_MAX_LENGTH] = {0, 0, 0, 0, 0};
 uint8_t leader_sequence_size = 0;
 
+#ifdef LEADER_COUNT
+__attribute__ ((weak))
+void process_leader_event(uint8_t index) {}
+
+// Range of leader_dictionary starting with the keys typed so far
+static uint8_t leader_lo;
+static uint8_t leader_hi;
+
+static uint16_t leader_key(uint8_t index, uint8_t depth) {
+  if (depth >= LEADER_MAX_LENGTH) {
+    return 0;
+  }
+  return pgm_read_word(&leader_dictionary[index].keys[depth]);
+}
+
+#ifndef NO_DEBUG
+static void leader_check_dictionary(void) {
+  static bool checked = false;
+  if (checked) {
+    return;
+  }
+  checked = true;
+  for (uint8_t i = 1; i < LEADER_COUNT; i++) {
+    for (uint8_t d = 0; d < LEADER_MAX_LENGTH; d++) {
+      uint16_t prev = leader_key(i - 1, d);
+      uint16_t key = leader_key(i, d);
+      if (key != prev) {
+        if (key < prev) {
+          dprintf("leader: leader_dictionary[%u] is out of order\n", i);
+        }
+        break;
+      }
+    }
+  }
+}
+#endif
+
+// Narrow [leader_lo, leader_hi) to the entries with key at depth
+static void leader_narrow(uint8_t depth, uint16_t key) {
+  uint8_t lo = leader_lo;
+  uint8_t hi = leader_hi;
+  while (lo < hi) {
+    uint8_t mid = lo + (hi - lo) / 2;
+    if (leader_key(mid, depth) < key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  leader_lo = lo;
+  hi = leader_hi;
+  while (lo < hi) {
+    uint8_t mid = lo + (hi - lo) / 2;
+    if (leader_key(mid, depth) <= key) {
+      lo = mid + 1;
+    } else {
+      hi = mid;
+    }
+  }
+  leader_hi = lo;
+}
+
+static void leader_fire(uint8_t index) {
+  uint16_t keycode = pgm_read_word(&leader_dictionary[index].keycode);
+  if (keycode) {
+    register_code16(keycode);
+    unregister_code16(keycode);
+  } else {
+    process_leader_event(index);
+  }
+}
+
+static void leader_finish(void) {
+  leading = false;
+  deadline_cancel(matrix_scan_leader);
+  leader_end();
+}
+
+void matrix_scan_leader(void) {
+  if (leading && timer_elapsed(leader_time) > LEADER_TIMEOUT) {
+    // The shortest sequence of the range comes first, fire it if it
+    // is the one typed so far
+    if (leader_sequence_size && leader_lo < leader_hi &&
+        !leader_key(leader_lo, leader_sequence_size)) {
+      leader_fire(leader_lo);
+    }
+    leader_finish();
+  }
+}
+#else
+void matrix_scan_leader(void) {}
+#endif
+
 bool process_leader(uint16_t keycode, keyrecord_t *record) {
   // Leader key set-up
   if (record->event.pressed) {
@@ -37,16 +131,39 @@ bool process_leader(uint16_t keycode, keyrecord_t *record) {
       leading = true;
       leader_time = timer_read();
       leader_sequence_size = 0;
-      leader_sequence[0] = 0;
-      leader_sequence[1] = 0;
-      leader_sequence[2] = 0;
-      leader_sequence[3] = 0;
-      leader_sequence[4] = 0;
+      for (uint8_t i = 0; i < LEADER_MAX_LENGTH; i++) {
+        leader_sequence[i] = 0;
+      }
+#ifdef LEADER_COUNT
+#ifndef NO_DEBUG
+      leader_check_dictionary();
+#endif
+      leader_lo = 0;
+      leader_hi = LEADER_COUNT;
+      deadline_in(matrix_scan_leader, LEADER_TIMEOUT + 1);
+#endif
       return false;
     }
+#ifdef LEADER_COUNT
+    if (leading) {
+      matrix_scan_leader();
+    }
+#endif
     if (leading && timer_elapsed(leader_time) < LEADER_TIMEOUT) {
-      leader_sequence[leader_sequence_size] = keycode;
-      leader_sequence_size++;
+      if (leader_sequence_size < LEADER_MAX_LENGTH) {
+        leader_sequence[leader_sequence_size] = keycode;
+        leader_sequence_size++;
+#ifdef LEADER_COUNT
+        leader_narrow(leader_sequence_size - 1, keycode);
+        if (leader_lo == leader_hi) {
+          // Nothing starts with these keys
+          leader_finish();
+        } else if (leader_hi - leader_lo == 1 && !leader_key(leader_lo, leader_sequence_size)) {
+          leader_fire(leader_lo);
+          leader_finish();
+        }
+#endif
+      }
       return false;
     }
   }
@@ -20,6 +20,7 @@
 #include "quantum.h"
 
 bool process_leader(uint16_t keycode, keyrecord_t *record);
+void matrix_scan_leader(void);
 
 void leader_start(void);
 void leader_end(void);
@@ -27,13 +28,52 @@ void leader_end(void);
 #ifndef LEADER_TIMEOUT
   #define LEADER_TIMEOUT 200
 #endif
+
+/* Longest sequence, the SEQ_*_KEYS macros below compare this many keys */
+#define LEADER_MAX_LENGTH 5
+
+#ifdef LEADER_COUNT
+/* With LEADER_COUNT defined the keymap provides a leader_dictionary
+ * instead of checking sequences in matrix_scan_user:
+ *
+ *   const leader_seq_t PROGMEM leader_dictionary[LEADER_COUNT] = {
+ *     LEADER_SEQ(KC_CAPS, KC_C),
+ *     LEADER_ACTION(KC_F, KC_D),
+ *     LEADER_ACTION(KC_F, KC_D, KC_S),
+ *   };
+ *
+ * The entries must be sorted by their keys, like words in a dictionary,
+ * so that all sequences starting with the same keys are next to each
+ * other: each prefix then is a range of the table and every key narrows
+ * that range with a binary search, like walking down a trie.
+ *
+ * A sequence fires as soon as no longer one starts with it, without
+ * waiting for LEADER_TIMEOUT. When one does (KC_F, KC_D above) it fires
+ * on the timeout unless the longer one is typed. Keys no sequence
+ * continues with end the leader right away.
+ *
+ * LEADER_SEQ taps a keycode, LEADER_ACTION calls
+ * process_leader_event() with the index of the entry.
+ */
+typedef struct {
+    uint16_t keys[LEADER_MAX_LENGTH];
+    uint16_t keycode;
+} leader_seq_t;
+
+#define LEADER_SEQ(kc, ...) {.keys = {__VA_ARGS__}, .keycode = (kc)}
+#define LEADER_ACTION(...)  {.keys = {__VA_ARGS__}}
+
+extern const leader_seq_t leader_dictionary[LEADER_COUNT];
+
+void process_leader_event(uint8_t index);
+#endif
 #define SEQ_ONE_KEY(key) if (leader_sequence[0] == (key) && leader_sequence[1] == 0 && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_TWO_KEYS(key1, key2) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == 0 && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_THREE_KEYS(key1, key2, key3) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == 0 && leader_sequence[4] == 0)
 #define SEQ_FOUR_KEYS(key1, key2, key3, key4) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == 0)
 #define SEQ_FIVE_KEYS(key1, key2, key3, key4, key5) if (leader_sequence[0] == (key1) && leader_sequence[1] == (key2) && leader_sequence[2] == (key3) && leader_sequence[3] == (key4) && leader_sequence[4] == (key5))
 
-#define LEADER_EXTERNS() extern bool leading; extern uint16_t leader_time; extern uint16_t leader_sequence[5]; extern uint8_t leader_sequence_size
+#define LEADER_EXTERNS() extern bool leading; extern uint16_t leader_time; extern uint16_t leader_sequence[LEADER_MAX_LENGTH]; extern uint8_t leader_sequence_size
 #define LEADER_DICTIONARY() if (leading && timer_elapsed(leader_time) > LEADER_TIMEOUT)
 
 #endif
@@ -0,0 +1,87 @@
+/* Copyright 2016 Jack Humbert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include "process_chording.h"
+#include "process_steno.h"
+#include "virtser.h"
+
+static steno_mode_t mode = STENO_MODE;
+
+/* key position in the GeminiPR packet, 7 per byte from bit 6 down */
+static const uint8_t gemini_pos[STN_KEYS] PROGMEM = {
+  [STN_NUM] = 1,
+  [STN_SL] = 7, [STN_TL] = 9, [STN_KL] = 10, [STN_PL] = 11,
+  [STN_WL] = 12, [STN_HL] = 13, [STN_RL] = 14,
+  [STN_A] = 15, [STN_O] = 16, [STN_STAR] = 17, [STN_E] = 24, [STN_U] = 25,
+  [STN_FR] = 26, [STN_RR] = 27, [STN_PR] = 28, [STN_BR] = 29,
+  [STN_LR] = 30, [STN_GR] = 31, [STN_TR] = 32, [STN_SR] = 33,
+  [STN_DR] = 34, [STN_ZR] = 41
+};
+
+void steno_set_mode(steno_mode_t new_mode) {
+  mode = new_mode;
+}
+
+steno_mode_t steno_get_mode(void) {
+  return mode;
+}
+
+uint8_t steno_gemini_packet(uint32_t chord, uint8_t packet[GEMINI_PACKET_SIZE]) {
+  for (uint8_t i = 0; i < GEMINI_PACKET_SIZE; i++) {
+    packet[i] = 0;
+  }
+  packet[0] = 0x80;
+  for (uint8_t key = 0; key < STN_KEYS; key++) {
+    if (chord & CHORD_BIT(key)) {
+      uint8_t pos = pgm_read_byte(&gemini_pos[key]);
+      packet[pos / 7] |= 1 << (6 - pos % 7);
+    }
+  }
+  return GEMINI_PACKET_SIZE;
+}
+
+/* TX Bolt has the keys in steno order from S- with # last, so the
+ * chord only needs rotating by one */
+uint8_t steno_bolt_packet(uint32_t chord, uint8_t packet[BOLT_PACKET_SIZE]) {
+  uint32_t keys = (chord >> 1) | ((chord & CHORD_BIT(STN_NUM)) ? (uint32_t)1 << (STN_KEYS - 1) : 0);
+  uint8_t length = 0;
+  for (uint8_t group = 0; group < 4; group++) {
+    uint8_t bits = keys & 0x3F;
+    if (bits) {
+      packet[length++] = (group << 6) | bits;
+    }
+    keys >>= 6;
+  }
+  packet[length++] = 0;
+  return length;
+}
+
+bool steno_send(uint32_t chord) {
+  uint8_t packet[STENO_PACKET_SIZE];
+  uint8_t length;
+  switch (mode) {
+    case STENO_MODE_BOLT:
+      length = steno_bolt_packet(chord, packet);
+      break;
+    case STENO_MODE_GEMINI:
+      length = steno_gemini_packet(chord, packet);
+      break;
+    default:
+      return false;
+  }
+  virtser_send_packet(packet, length);
+  return true;
+}
@@ -0,0 +1,55 @@
+/* Copyright 2016 Jack Humbert
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef PROCESS_STENO_H
+#define PROCESS_STENO_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+/* With STENO_ENABLE, strokes on the steno keys CH(STN_xx) can go to a
+ * steno program like Plover as one serial packet per stroke instead of
+ * being looked up in chord_dictionary:
+ *
+ *   GeminiPR: 6 bytes, 7 keys each, the first byte has bit 7 set.
+ *   TX Bolt:  one byte per group of 6 keys that has any down, the group
+ *             in the top 2 bits, and a 0 ending the stroke.
+ */
+typedef enum {
+  STENO_MODE_DICTIONARY,
+  STENO_MODE_BOLT,
+  STENO_MODE_GEMINI
+} steno_mode_t;
+
+#ifndef STENO_MODE
+  #define STENO_MODE STENO_MODE_GEMINI
+#endif
+
+#define GEMINI_PACKET_SIZE 6
+#define BOLT_PACKET_SIZE   5
+#define STENO_PACKET_SIZE  GEMINI_PACKET_SIZE
+
+void steno_set_mode(steno_mode_t mode);
+steno_mode_t steno_get_mode(void);
+
+/* fill packet for a chord_t, returns its length */
+uint8_t steno_gemini_packet(uint32_t chord, uint8_t packet[GEMINI_PACKET_SIZE]);
+uint8_t steno_bolt_packet(uint32_t chord, uint8_t packet[BOLT_PACKET_SIZE]);
+
+/* send a chord_t in the current mode, false in STENO_MODE_DICTIONARY */
+bool steno_send(uint32_t chord);
+
+#endif
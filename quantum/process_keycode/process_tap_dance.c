@@ -15,12 +15,33 @@
  */
 #include "quantum.h"
 #include "action_tapping.h"
+#include "deadline.h"
 
 uint8_t get_oneshot_mods(void);
 
 static uint16_t last_td;
 static int8_t highest_td = -1;
 
+// Run matrix_scan_tap_dance when the oldest dance reaches TAPPING_TERM
+static void schedule_tap_dance (void) {
+  uint16_t next = UINT16_MAX;
+
+  for (int i = 0; i <= highest_td; i++) {
+    qk_tap_dance_action_t *action = &tap_dance_actions[i];
+    if (action->state.count) {
+      uint16_t elapsed = timer_elapsed (action->state.timer);
+      uint16_t left = elapsed > TAPPING_TERM ? 0 : TAPPING_TERM + 1 - elapsed;
+      if (left < next)
+        next = left;
+    }
+  }
+
+  if (next == UINT16_MAX)
+    deadline_cancel (matrix_scan_tap_dance);
+  else
+    deadline_in (matrix_scan_tap_dance, next);
+}
+
 void qk_tap_dance_pair_finished (qk_tap_dance_state_t *state, void *user_data) {
   qk_tap_dance_pair_t *pair = (qk_tap_dance_pair_t *)user_data;
 
@@ -102,6 +123,7 @@ bool process_tap_dance(uint16_t keycode, keyrecord_t *record) {
       }
 
       last_td = keycode;
+      schedule_tap_dance ();
     }
 
     break;
@@ -139,6 +161,7 @@ for (int i = 0; i <= highest_td; i++) {
       reset_tap_dance (&action->state);
     }
   }
+  schedule_tap_dance ();
 }
 
 void reset_tap_dance (qk_tap_dance_state_t *state) {
@@ -30,6 +30,10 @@ extern backlight_config_t backlight_config;
 #include "fauxclicky.h"
 #endif
 
+#ifdef AUDIO_ENABLE
+#include "sample.h"
+#endif
+
 static void do_code16 (uint16_t code, void (*f) (uint8_t)) {
   switch (code) {
   case QK_MODS ... QK_MODS_MAX:
@@ -97,6 +101,10 @@ void unregister_code16 (uint16_t code) {
   }
 }
 
+/* Defined by dynamic_macro.h when a keymap includes it */
+__attribute__ ((weak))
+void matrix_scan_dynamic_macro(void) {}
+
 __attribute__ ((weak))
 bool process_action_kb(keyrecord_t *record) {
   return true;
@@ -159,6 +167,10 @@ bool process_record_quantum(keyrecord_t *record) {
   #endif
     keycode = keymap_key_to_keycode(layer_switch_get_layer(key), key);
 
+  #ifdef RGBLIGHT_REACTIVE
+    rgblight_reactive_key(key.row, key.col, record->event.pressed);
+  #endif
+
     // This is how you use actions here
     // if (keycode == KC_LEAD) {
     //   action_t action;
@@ -184,7 +196,7 @@ bool process_record_quantum(keyrecord_t *record) {
   #ifndef DISABLE_LEADER
     process_leader(keycode, record) &&
   #endif
-  #ifndef DISABLE_CHORDING
+  #ifdef CHORDING_ENABLE
     process_chording(keycode, record) &&
   #endif
   #ifdef COMBO_ENABLE
@@ -605,18 +617,13 @@ void matrix_init_quantum() {
 void matrix_scan_quantum() {
   #ifdef AUDIO_ENABLE
     matrix_scan_music();
+    sample_task();
   #endif
 
-  #ifdef TAP_DANCE_ENABLE
-    matrix_scan_tap_dance();
-  #endif
-
-  #ifdef COMBO_ENABLE
-    matrix_scan_combo();
-  #endif
+  matrix_scan_dynamic_macro();
 
-  #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
-    backlight_task();
+  #ifdef CHORDING_ENABLE
+    matrix_scan_chording();
   #endif
 
   matrix_scan_kb();
@@ -624,6 +631,8 @@ void matrix_scan_quantum() {
 
 #if defined(BACKLIGHT_ENABLE) && defined(BACKLIGHT_PIN)
 
+#include "backlight_pwm.h"
+
 static const uint8_t backlight_pin = BACKLIGHT_PIN;
 
 #if BACKLIGHT_PIN == B7
@@ -639,10 +648,51 @@ static const uint8_t backlight_pin = BACKLIGHT_PIN;
 #  define NO_BACKLIGHT_CLOCK
 #endif
 
+// sleep_led.c has its own TIMER1_COMPA_vect
+#if defined(SLEEP_LED_ENABLE) && (defined(NO_BACKLIGHT_CLOCK) || defined(BACKLIGHT_BREATHING))
+#  error "SLEEP_LED_ENABLE needs timer 1, which the backlight uses on this pin or for breathing"
+#endif
+
 #ifndef BACKLIGHT_ON_STATE
 #define BACKLIGHT_ON_STATE 0
 #endif
 
+#ifdef NO_BACKLIGHT_CLOCK
+/*
+ * Software PWM for pins without a timer 1 channel. Timer 1 still runs
+ * the PWM period: COMPA starts a period and turns the pin on, COMPB
+ * turns it off at the duty. That's two interrupts per period whatever
+ * the resolution, and brightness doesn't depend on the scan rate.
+ */
+
+// duty from backlight_set(), the interrupt picks it up every period
+static volatile uint16_t soft_pwm_duty = 0;
+// duty of the running period
+static uint16_t soft_pwm_current = 0;
+
+static inline void backlight_pin_on(void)
+{
+  #if BACKLIGHT_ON_STATE == 0
+    // PORTx &= ~n
+    _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
+  #else
+    // PORTx |= n
+    _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
+  #endif
+}
+
+static inline void backlight_pin_off(void)
+{
+  #if BACKLIGHT_ON_STATE == 0
+    // PORTx |= n
+    _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
+  #else
+    // PORTx &= ~n
+    _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
+  #endif
+}
+#endif
+
 __attribute__ ((weak))
 void backlight_init_ports(void)
 {
@@ -674,6 +724,13 @@ void backlight_init_ports(void)
 
     TCCR1A = _BV(COM1x1) | _BV(WGM11); // = 0b00001010;
     TCCR1B = _BV(WGM13) | _BV(WGM12) | _BV(CS10); // = 0b00011001;
+  #else
+    // CTC mode with OCR1A as TOP, clk/1: a 244Hz period at 16MHz
+    OCR1A = BACKLIGHT_DUTY_MAX;
+    OCR1B = 0;
+    TCCR1A = 0;
+    TCCR1B = _BV(WGM12) | _BV(CS10);
+    TIMSK1 |= _BV(OCIE1A) | _BV(OCIE1B);
   #endif
 
   backlight_init();
@@ -694,22 +751,18 @@ void backlight_set(uint8_t level)
   //   _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
   // #endif
 
-  if ( level == 0 ) {
-    #ifndef NO_BACKLIGHT_CLOCK
+  #ifdef NO_BACKLIGHT_CLOCK
+    uint16_t duty = backlight_level_duty(level, BACKLIGHT_LEVELS);
+    uint8_t sreg = SREG;
+    cli();
+    soft_pwm_duty = duty;
+    SREG = sreg;
+  #else
+    if ( level == 0 ) {
       // Turn off PWM control on backlight pin, revert to output low.
       TCCR1A &= ~(_BV(COM1x1));
       OCR1x = 0x0;
-    #else
-      // #if BACKLIGHT_ON_STATE == 0
-      //   // PORTx |= n
-      //   _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-      // #else
-      //   // PORTx &= ~n
-      //   _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
-      // #endif
-    #endif
-  } 
-  #ifndef NO_BACKLIGHT_CLOCK
+    }
     else if ( level == BACKLIGHT_LEVELS ) {
       // Turn on PWM control of backlight pin
       TCCR1A |= _BV(COM1x1);
@@ -729,82 +782,64 @@ void backlight_set(uint8_t level)
   #endif
 }
 
-uint8_t backlight_tick = 0;
-
-void backlight_task(void) {
-  #ifdef NO_BACKLIGHT_CLOCK
-  if ((0xFFFF >> ((BACKLIGHT_LEVELS - backlight_config.level) * ((BACKLIGHT_LEVELS + 1) / 2))) & (1 << backlight_tick)) { 
-    #if BACKLIGHT_ON_STATE == 0
-      // PORTx &= ~n
-      _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
-    #else
-      // PORTx |= n
-      _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-    #endif
-  } else {
-    #if BACKLIGHT_ON_STATE == 0
-      // PORTx |= n
-      _SFR_IO8((backlight_pin >> 4) + 2) |= _BV(backlight_pin & 0xF);
-    #else
-      // PORTx &= ~n
-      _SFR_IO8((backlight_pin >> 4) + 2) &= ~_BV(backlight_pin & 0xF);
-    #endif
-  }
-  backlight_tick = (backlight_tick + 1) % 16;
-  #endif
-}
-
 #ifdef BACKLIGHT_BREATHING
 
-#define BREATHING_NO_HALT  0
-#define BREATHING_HALT_OFF 1
-#define BREATHING_HALT_ON  2
+static breathing_t breathing;
 
-static uint8_t breath_intensity;
-static uint8_t breath_speed;
-static uint16_t breathing_index;
-static uint8_t breathing_halt;
+#ifdef NO_BACKLIGHT_CLOCK
+// the soft PWM interrupt runs all the time, it only looks at the flag
+static volatile bool breathing_on = false;
+#  define breathing_interrupt_enable()  (breathing_on = true)
+#  define breathing_interrupt_disable() (breathing_on = false)
+#  define breathing_interrupt_toggle()  (breathing_on = !breathing_on)
+#  define breathing_interrupt_enabled() (breathing_on)
+#else
+#  define breathing_interrupt_enable()  (TIMSK1 |= _BV(OCIE1A))
+#  define breathing_interrupt_disable() (TIMSK1 &= ~_BV(OCIE1A))
+#  define breathing_interrupt_toggle()  (TIMSK1 ^= _BV(OCIE1A))
+#  define breathing_interrupt_enabled() (TIMSK1 & _BV(OCIE1A))
+#endif
 
 void breathing_enable(void)
 {
     if (get_backlight_level() == 0)
     {
-        breathing_index = 0;
+        breathing.index = 0;
     }
     else
     {
-        // Set breathing_index to be at the midpoint (brightest point)
-        breathing_index = 0x20 << breath_speed;
+        // Set breathing.index to be at the midpoint (brightest point)
+        breathing.index = BREATHING_TOP << breathing.speed;
     }
 
-    breathing_halt = BREATHING_NO_HALT;
+    breathing.halt = BREATHING_NO_HALT;
 
     // Enable breathing interrupt
-    TIMSK1 |= _BV(OCIE1A);
+    breathing_interrupt_enable();
 }
 
 void breathing_pulse(void)
 {
     if (get_backlight_level() == 0)
     {
-        breathing_index = 0;
+        breathing.index = 0;
     }
     else
     {
-        // Set breathing_index to be at the midpoint + 1 (brightest point)
-        breathing_index = 0x21 << breath_speed;
+        // Set breathing.index to be at the midpoint + 1 (brightest point)
+        breathing.index = (BREATHING_TOP + 1) << breathing.speed;
     }
 
-    breathing_halt = BREATHING_HALT_ON;
+    breathing.halt = BREATHING_HALT_ON;
 
     // Enable breathing interrupt
-    TIMSK1 |= _BV(OCIE1A);
+    breathing_interrupt_enable();
 }
 
 void breathing_disable(void)
 {
     // Disable breathing interrupt
-    TIMSK1 &= ~_BV(OCIE1A);
+    breathing_interrupt_disable();
     backlight_set(get_backlight_level());
 }
 
@@ -812,11 +847,11 @@ void breathing_self_disable(void)
 {
     if (get_backlight_level() == 0)
     {
-        breathing_halt = BREATHING_HALT_OFF;
+        breathing.halt = BREATHING_HALT_OFF;
     }
     else
     {
-        breathing_halt = BREATHING_HALT_ON;
+        breathing.halt = BREATHING_HALT_ON;
     }
 
     //backlight_set(get_backlight_level());
@@ -828,19 +863,19 @@ void breathing_toggle(void)
     {
         if (get_backlight_level() == 0)
         {
-            breathing_index = 0;
+            breathing.index = 0;
         }
         else
         {
-            // Set breathing_index to be at the midpoint + 1 (brightest point)
-            breathing_index = 0x21 << breath_speed;
+            // Set breathing.index to be at the midpoint + 1 (brightest point)
+            breathing.index = (BREATHING_TOP + 1) << breathing.speed;
         }
 
-        breathing_halt = BREATHING_NO_HALT;
+        breathing.halt = BREATHING_NO_HALT;
     }
 
     // Toggle breathing interrupt
-    TIMSK1 ^= _BV(OCIE1A);
+    breathing_interrupt_toggle();
 
     // Restore backlight level
     if (!is_breathing())
@@ -851,70 +886,70 @@ void breathing_toggle(void)
 
 bool is_breathing(void)
 {
-    return (TIMSK1 && _BV(OCIE1A));
+    return breathing_interrupt_enabled();
 }
 
 void breathing_intensity_default(void)
 {
     //breath_intensity = (uint8_t)((uint16_t)100 * (uint16_t)get_backlight_level() / (uint16_t)BACKLIGHT_LEVELS);
-    breath_intensity = ((BACKLIGHT_LEVELS - get_backlight_level()) * ((BACKLIGHT_LEVELS + 1) / 2));
+    breathing.intensity = ((BACKLIGHT_LEVELS - get_backlight_level()) * ((BACKLIGHT_LEVELS + 1) / 2));
 }
 
 void breathing_intensity_set(uint8_t value)
 {
-    breath_intensity = value;
+    breathing.intensity = value;
 }
 
 void breathing_speed_default(void)
 {
-    breath_speed = 4;
+    breathing.speed = 4;
 }
 
 void breathing_speed_set(uint8_t value)
 {
     bool is_breathing_now = is_breathing();
-    uint8_t old_breath_speed = breath_speed;
+    uint8_t old_breath_speed = breathing.speed;
 
     if (is_breathing_now)
     {
         // Disable breathing interrupt
-        TIMSK1 &= ~_BV(OCIE1A);
+        breathing_interrupt_disable();
     }
 
-    breath_speed = value;
+    breathing.speed = value;
 
     if (is_breathing_now)
     {
         // Adjust index to account for new speed
-        breathing_index = (( (uint8_t)( (breathing_index) >> old_breath_speed ) ) & 0x3F) << breath_speed;
+        breathing.index = breathing_rescale(breathing.index, old_breath_speed, breathing.speed);
 
         // Enable breathing interrupt
-        TIMSK1 |= _BV(OCIE1A);
+        breathing_interrupt_enable();
     }
 
 }
 
 void breathing_speed_inc(uint8_t value)
 {
-    if ((uint16_t)(breath_speed - value) > 10 )
+    if ((uint16_t)(breathing.speed - value) > 10 )
     {
         breathing_speed_set(0);
     }
     else
     {
-        breathing_speed_set(breath_speed - value);
+        breathing_speed_set(breathing.speed - value);
     }
 }
 
 void breathing_speed_dec(uint8_t value)
 {
-    if ((uint16_t)(breath_speed + value) > 10 )
+    if ((uint16_t)(breathing.speed + value) > 10 )
     {
         breathing_speed_set(10);
     }
     else
     {
-        breathing_speed_set(breath_speed + value);
+        breathing_speed_set(breathing.speed + value);
     }
 }
 
@@ -922,43 +957,64 @@ void breathing_defaults(void)
 {
     breathing_intensity_default();
     breathing_speed_default();
-    breathing_halt = BREATHING_NO_HALT;
+    breathing.halt = BREATHING_NO_HALT;
 }
 
-/* Breathing Sleep LED brighness(PWM On period) table
- * (64[steps] * 4[duration]) / 64[PWM periods/s] = 4 second breath cycle
- *
- * http://www.wolframalpha.com/input/?i=%28sin%28+x%2F64*pi%29**8+*+255%2C+x%3D0+to+63
- * (0..63).each {|x| p ((sin(x/64.0*PI)**8)*255).to_i }
- */
-static const uint8_t breathing_table[64] PROGMEM = {
-  0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,   1,   2,   4,   6,  10,
- 15,  23,  32,  44,  58,  74,  93, 113, 135, 157, 179, 199, 218, 233, 245, 252,
-255, 252, 245, 233, 218, 199, 179, 157, 135, 113,  93,  74,  58,  44,  32,  23,
- 15,  10,   6,   4,   2,   1,   0,   0,   0,   0,   0,   0,   0,   0,   0,   0,
-};
+#ifndef NO_BACKLIGHT_CLOCK
 
 ISR(TIMER1_COMPA_vect)
 {
-    // OCR1x = (pgm_read_byte(&breathing_table[ ( (uint8_t)( (breathing_index++) >> breath_speed ) ) & 0x3F ] )) * breath_intensity;
+    uint16_t duty;
 
-
-    uint8_t local_index = ( (uint8_t)( (breathing_index++) >> breath_speed ) ) & 0x3F;
-
-    if (((breathing_halt == BREATHING_HALT_ON) && (local_index == 0x20)) || ((breathing_halt == BREATHING_HALT_OFF) && (local_index == 0x3F)))
+    if (!breathing_next(&breathing, &duty))
     {
         // Disable breathing interrupt
-        TIMSK1 &= ~_BV(OCIE1A);
+        breathing_interrupt_disable();
     }
 
-    OCR1x = (uint16_t)(((uint16_t)pgm_read_byte(&breathing_table[local_index]) * 257)) >> breath_intensity;
-
+    OCR1x = duty;
 }
 
-
+#endif
 
 #endif // breathing
 
+#ifdef NO_BACKLIGHT_CLOCK
+
+ISR(TIMER1_COMPA_vect)
+{
+  uint16_t duty = soft_pwm_duty;
+
+  #ifdef BACKLIGHT_BREATHING
+    if (breathing_interrupt_enabled() && !breathing_next(&breathing, &duty)) {
+      breathing_interrupt_disable();
+    }
+  #endif
+
+  soft_pwm_current = duty;
+  if (!duty) {
+    backlight_pin_off();
+    return;
+  }
+  backlight_pin_on();
+  if (duty != BACKLIGHT_DUTY_MAX) {
+    OCR1B = duty;
+    // a late interrupt, COMPB won't match this period
+    if (TCNT1 >= duty) {
+      backlight_pin_off();
+    }
+  }
+}
+
+ISR(TIMER1_COMPB_vect)
+{
+  if (soft_pwm_current != BACKLIGHT_DUTY_MAX) {
+    backlight_pin_off();
+  }
+}
+
+#endif
+
 #else // backlight
 
 __attribute__ ((weak))
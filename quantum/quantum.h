@@ -67,11 +67,14 @@ extern uint32_t default_layer_state;
 	#include "process_leader.h"
 #endif
 
-#define DISABLE_CHORDING
-#ifndef DISABLE_CHORDING
+#ifdef CHORDING_ENABLE
 	#include "process_chording.h"
 #endif
 
+#ifdef STENO_ENABLE
+	#include "process_steno.h"
+#endif
+
 #ifdef UNICODE_ENABLE
 	#include "process_unicode.h"
 #endif
@@ -96,6 +99,8 @@ extern uint32_t default_layer_state;
 
 #define SEND_STRING(str) send_string(PSTR(str))
 void send_string(const char *str);
+extern const bool ascii_to_qwerty_shift_lut[0x80];
+extern const uint8_t ascii_to_qwerty_keycode_lut[0x80];
 
 // For tri-layer
 void update_tri_layer(uint8_t layer1, uint8_t layer2, uint8_t layer3);
@@ -109,6 +114,7 @@ void matrix_init_kb(void);
 void matrix_scan_kb(void);
 void matrix_init_user(void);
 void matrix_scan_user(void);
+void matrix_scan_dynamic_macro(void);
 bool process_action_kb(keyrecord_t *record);
 bool process_record_kb(uint16_t keycode, keyrecord_t *record);
 bool process_record_user(uint16_t keycode, keyrecord_t *record);
@@ -123,7 +129,6 @@ void unregister_code16 (uint16_t code);
 
 #ifdef BACKLIGHT_ENABLE
 void backlight_init_ports(void);
-void backlight_task(void);
 
 #ifdef BACKLIGHT_BREATHING
 void breathing_enable(void);
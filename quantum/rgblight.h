@@ -45,6 +45,22 @@
 #define RGBLIGHT_EFFECT_CHRISTMAS_STEP 2
 #endif
 
+#ifndef RGBLIGHT_REACTIVE_KEYS
+#define RGBLIGHT_REACTIVE_KEYS 8
+#endif
+#ifndef RGBLIGHT_REACTIVE_FADE
+#define RGBLIGHT_REACTIVE_FADE 500
+#endif
+#ifndef RGBLIGHT_REACTIVE_SPLASH
+#define RGBLIGHT_REACTIVE_SPLASH 2
+#endif
+#ifndef RGBLIGHT_REACTIVE_SPLASH_SPEED
+#define RGBLIGHT_REACTIVE_SPLASH_SPEED 40
+#endif
+#ifndef RGBLIGHT_REACTIVE_INTERVAL
+#define RGBLIGHT_REACTIVE_INTERVAL 16
+#endif
+
 #ifndef RGBLIGHT_HUE_STEP
 #define RGBLIGHT_HUE_STEP 10
 #endif
@@ -119,11 +135,54 @@ void rgblight_timer_init(void);
 void rgblight_timer_enable(void);
 void rgblight_timer_disable(void);
 void rgblight_timer_toggle(void);
-void rgblight_effect_breathing(uint8_t interval);
-void rgblight_effect_rainbow_mood(uint8_t interval);
-void rgblight_effect_rainbow_swirl(uint8_t interval);
-void rgblight_effect_snake(uint8_t interval);
-void rgblight_effect_knight(uint8_t interval);
-void rgblight_effect_christmas(void);
+
+/* Each animation is a descriptor in the PROGMEM table in
+ * rgblight_effects.c. step() draws the next frame into led[] every
+ * frame interval, and the frame is only sent to the strip when it
+ * differs from the last one sent.
+ */
+typedef struct {
+  uint8_t mode;               // first mode of the effect
+  uint8_t variants;           // modes from there, passed as variant
+  void (*init)(uint8_t variant);
+  void (*step)(uint8_t variant);
+  const uint8_t *intervals;   // PROGMEM ms per frame, by variant >> interval_shift
+  uint8_t interval_shift;
+  uint16_t interval;          // ms per frame without intervals
+} rgblight_effect_t;
+
+void rgblight_effects_init(void);
+void rgblight_effects_task(void);
+/* send led[] unless the strip already shows it */
+void rgblight_effects_flush(void);
+/* the strip was changed behind the effects' back */
+void rgblight_effects_invalidate(void);
+
+/* Reactive lighting, RGBLIGHT_REACTIVE. A pressed key lights its LED
+ * with the current hue and saturation, after the release it fades out
+ * over RGBLIGHT_REACTIVE_FADE ms. The light splashes to the
+ * RGBLIGHT_REACTIVE_SPLASH LEDs on each side, one LED further every
+ * RGBLIGHT_REACTIVE_SPLASH_SPEED ms, at half the brightness per LED.
+ *
+ * Only the last RGBLIGHT_REACTIVE_KEYS keys are kept, as a brightness
+ * and the time it was set, so a frame costs the same for any number of
+ * LEDs. The keys are drawn on top of led[] while a frame is sent, led[]
+ * itself keeps the frame of the mode.
+ *
+ * The keyboard maps keys to LEDs, RGBLIGHT_REACTIVE_NO_LED for none:
+ *
+ *   const uint8_t PROGMEM rgblight_reactive_map[MATRIX_ROWS][MATRIX_COLS] = { ... };
+ */
+#define RGBLIGHT_REACTIVE_NO_LED 0xFF
+
+void rgblight_reactive_init(void);
+/* from process_record_quantum() */
+void rgblight_reactive_key(uint8_t row, uint8_t col, bool pressed);
+void rgblight_reactive_led(uint8_t index, bool pressed);
+/* every RGBLIGHT_REACTIVE_INTERVAL ms, sends a frame while keys are lit */
+void rgblight_reactive_task(void);
+/* used by rgblight_effects_flush() around sending led[] */
+void rgblight_reactive_draw(void);
+void rgblight_reactive_undraw(void);
 
 #endif
@@ -0,0 +1,258 @@
+/* Copyright 2017 Yang Liu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <string.h>
+#include "progmem.h"
+#include "timer.h"
+#include "rgblight.h"
+#include "led_tables.h"
+
+extern rgblight_config_t rgblight_config;
+
+static LED_TYPE sent[RGBLED_NUM];
+static bool sent_valid = false;
+
+void rgblight_effects_invalidate(void) {
+  sent_valid = false;
+}
+
+void rgblight_effects_flush(void) {
+#ifdef RGBLIGHT_REACTIVE
+  rgblight_reactive_draw();
+#endif
+  if (!sent_valid || memcmp(sent, led, sizeof(sent))) {
+    rgblight_set();
+    memcpy(sent, led, sizeof(sent));
+    sent_valid = true;
+  }
+#ifdef RGBLIGHT_REACTIVE
+  rgblight_reactive_undraw();
+#endif
+}
+
+#ifdef RGBLIGHT_ANIMATIONS
+
+static void fill(uint16_t hue, uint8_t sat, uint8_t val) {
+  sethsv(hue, sat, val, &led[0]);
+  for (uint8_t i = 1; i < RGBLED_NUM; i++) {
+    led[i] = led[0];
+  }
+}
+
+static void clear(void) {
+  memset(led, 0, sizeof(led));
+}
+
+static uint8_t breathing_pos;
+
+static void breathing_init(uint8_t variant) {
+  breathing_pos = 0;
+}
+
+static void breathing_step(uint8_t variant) {
+  fill(rgblight_config.hue, rgblight_config.sat, pgm_read_byte(&LED_BREATHING_TABLE[breathing_pos]));
+  breathing_pos++;
+}
+
+static uint16_t rainbow_hue;
+
+static void rainbow_init(uint8_t variant) {
+  rainbow_hue = 0;
+}
+
+static void rainbow_mood_step(uint8_t variant) {
+  fill(rainbow_hue, rgblight_config.sat, rgblight_config.val);
+  rainbow_hue = rainbow_hue == 359 ? 0 : rainbow_hue + 1;
+}
+
+/* hue of each LED in the rainbow swirl, relative to the first */
+static uint16_t led_hue[RGBLED_NUM];
+
+static void rainbow_swirl_step(uint8_t variant) {
+  for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+    uint16_t hue = led_hue[i] + rainbow_hue;
+    if (hue >= 360) {
+      hue -= 360;
+    }
+    sethsv(hue, rgblight_config.sat, rgblight_config.val, &led[i]);
+  }
+  if (variant % 2) {
+    rainbow_hue = rainbow_hue == 359 ? 0 : rainbow_hue + 1;
+  } else {
+    rainbow_hue = rainbow_hue == 0 ? 359 : rainbow_hue - 1;
+  }
+}
+
+static int8_t chase_pos;
+static int8_t chase_increment;
+
+static void snake_init(uint8_t variant) {
+  chase_pos = 0;
+}
+
+static void snake_step(uint8_t variant) {
+  int8_t increment = (variant % 2) ? -1 : 1;
+  clear();
+  for (uint8_t j = 0; j < RGBLIGHT_EFFECT_SNAKE_LENGTH; j++) {
+    int8_t k = chase_pos + j * increment;
+    if (k < 0) {
+      k += RGBLED_NUM;
+    }
+    if (k < RGBLED_NUM) {
+      sethsv(rgblight_config.hue, rgblight_config.sat,
+             (uint8_t)(rgblight_config.val * (RGBLIGHT_EFFECT_SNAKE_LENGTH - j) / RGBLIGHT_EFFECT_SNAKE_LENGTH),
+             &led[k]);
+    }
+  }
+  if (increment == 1) {
+    chase_pos = chase_pos == 0 ? RGBLED_NUM - 1 : chase_pos - 1;
+  } else {
+    chase_pos = chase_pos == RGBLED_NUM - 1 ? 0 : chase_pos + 1;
+  }
+}
+
+static void knight_init(uint8_t variant) {
+  chase_pos = 0;
+  chase_increment = -1;
+}
+
+static void knight_step(uint8_t variant) {
+  LED_TYPE lit;
+  bool on[RGBLED_NUM] = { 0 };
+
+  sethsv(rgblight_config.hue, rgblight_config.sat, rgblight_config.val, &lit);
+  for (uint8_t j = 0; j < RGBLIGHT_EFFECT_KNIGHT_LENGTH; j++) {
+    int8_t k = chase_pos + j * chase_increment;
+    if (k < 0) {
+      k = 0;
+    }
+    if (k >= RGBLED_NUM) {
+      k = RGBLED_NUM - 1;
+    }
+    on[k] = true;
+  }
+  for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+    uint8_t cur = (i + RGBLIGHT_EFFECT_KNIGHT_OFFSET) % RGBLED_NUM;
+    if (on[cur]) {
+      led[i] = lit;
+    } else {
+      memset(&led[i], 0, sizeof(led[i]));
+    }
+  }
+  if (chase_increment == 1) {
+    if (chase_pos - 1 < 0 - RGBLIGHT_EFFECT_KNIGHT_LENGTH) {
+      chase_pos = 0 - RGBLIGHT_EFFECT_KNIGHT_LENGTH;
+      chase_increment = -1;
+    } else {
+      chase_pos -= 1;
+    }
+  } else {
+    if (chase_pos + 1 > RGBLED_NUM + RGBLIGHT_EFFECT_KNIGHT_LENGTH) {
+      chase_pos = RGBLED_NUM + RGBLIGHT_EFFECT_KNIGHT_LENGTH - 1;
+      chase_increment = 1;
+    } else {
+      chase_pos += 1;
+    }
+  }
+}
+
+static uint8_t christmas_offset;
+
+static void christmas_init(uint8_t variant) {
+  christmas_offset = 0;
+}
+
+static void christmas_step(uint8_t variant) {
+  christmas_offset ^= 1;
+  for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+    uint16_t hue = ((i / RGBLIGHT_EFFECT_CHRISTMAS_STEP + christmas_offset) % 2) * 120;
+    sethsv(hue, rgblight_config.sat, rgblight_config.val, &led[i]);
+  }
+}
+
+static const rgblight_effect_t effects[] PROGMEM = {
+  // MODE 2-5, breathing
+  { 2, 4, breathing_init, breathing_step, RGBLED_BREATHING_INTERVALS, 0, 0 },
+  // MODE 6-8, rainbow mood
+  { 6, 3, rainbow_init, rainbow_mood_step, RGBLED_RAINBOW_MOOD_INTERVALS, 0, 0 },
+  // MODE 9-14, rainbow swirl
+  { 9, 6, rainbow_init, rainbow_swirl_step, RGBLED_RAINBOW_SWIRL_INTERVALS, 1, 0 },
+  // MODE 15-20, snake
+  { 15, 6, snake_init, snake_step, RGBLED_SNAKE_INTERVALS, 1, 0 },
+  // MODE 21-23, knight
+  { 21, 3, knight_init, knight_step, RGBLED_KNIGHT_INTERVALS, 0, 0 },
+  // MODE 24, christmas
+  { 24, 1, christmas_init, christmas_step, NULL, 0, RGBLIGHT_EFFECT_CHRISTMAS_INTERVAL },
+};
+
+static const rgblight_effect_t *effect = NULL;
+static uint8_t effect_mode = 0;
+static bool effect_started;
+static uint16_t last_frame;
+
+void rgblight_effects_init(void) {
+  for (uint8_t i = 0; i < RGBLED_NUM; i++) {
+    led_hue[i] = 360 / RGBLED_NUM * i;
+  }
+  effect = NULL;
+  effect_mode = 0;
+}
+
+static void start_effect(uint8_t mode) {
+  effect_mode = mode;
+  effect = NULL;
+  for (uint8_t i = 0; i < sizeof(effects) / sizeof(effects[0]); i++) {
+    uint8_t first = pgm_read_byte(&effects[i].mode);
+    if (mode >= first && mode < first + pgm_read_byte(&effects[i].variants)) {
+      effect = &effects[i];
+      break;
+    }
+  }
+  if (effect) {
+    void (*init)(uint8_t) = pgm_read_ptr(&effect->init);
+    init(mode - pgm_read_byte(&effect->mode));
+    effect_started = false;
+    rgblight_effects_invalidate();
+  }
+}
+
+void rgblight_effects_task(void) {
+  if (rgblight_config.mode != effect_mode) {
+    start_effect(rgblight_config.mode);
+  }
+  if (!effect) {
+    return;
+  }
+
+  uint8_t variant = effect_mode - pgm_read_byte(&effect->mode);
+  const uint8_t *intervals = pgm_read_ptr(&effect->intervals);
+  uint16_t interval;
+  if (intervals) {
+    interval = pgm_read_byte(&intervals[variant >> pgm_read_byte(&effect->interval_shift)]);
+  } else {
+    interval = pgm_read_word(&effect->interval);
+  }
+  if (effect_started && timer_elapsed(last_frame) < interval) {
+    return;
+  }
+  effect_started = true;
+  last_frame = timer_read();
+
+  void (*step)(uint8_t) = pgm_read_ptr(&effect->step);
+  step(variant);
+  rgblight_effects_flush();
+}
+
+#endif
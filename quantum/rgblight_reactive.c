@@ -0,0 +1,189 @@
+/* Copyright 2017 Yang Liu
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU General Public License as published by
+ * the Free Software Foundation, either version 2 of the License, or
+ * (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU General Public License for more details.
+ *
+ * You should have received a copy of the GNU General Public License
+ * along with this program.  If not, see <http://www.gnu.org/licenses/>.
+ */
+#include <stddef.h>
+#include "progmem.h"
+#include "timer.h"
+#include "rgblight.h"
+
+extern rgblight_config_t rgblight_config;
+extern const uint8_t rgblight_reactive_map[MATRIX_ROWS][MATRIX_COLS];
+
+/* brightness lost per ms after the release, 8.8 fixed point */
+#define FADE_RATE (((uint32_t)255 << 8) / RGBLIGHT_REACTIVE_FADE)
+
+typedef struct {
+  uint8_t led;       // RGBLIGHT_REACTIVE_NO_LED: slot is free
+  uint8_t level;     // brightness at time
+  uint16_t time;     // of the release, the level doesn't change while held
+  uint16_t pressed;  // the splash starts here
+  uint8_t splash;    // LEDs the splash reached, up to RGBLIGHT_REACTIVE_SPLASH
+  bool held;
+} reactive_key_t;
+
+static reactive_key_t keys[RGBLIGHT_REACTIVE_KEYS];
+
+/* led[] as it was before drawing the keys, in drawing order */
+static struct {
+  uint8_t index;
+  LED_TYPE color;
+} saved[RGBLIGHT_REACTIVE_KEYS * (2 * RGBLIGHT_REACTIVE_SPLASH + 1)];
+static uint8_t saved_count = 0;
+
+/* the last frame sent had keys on it */
+static bool lit = false;
+
+void rgblight_reactive_init(void) {
+  for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_KEYS; i++) {
+    keys[i].led = RGBLIGHT_REACTIVE_NO_LED;
+  }
+  saved_count = 0;
+  lit = false;
+}
+
+static uint8_t level_of(const reactive_key_t *k) {
+  if (k->held) {
+    return k->level;
+  }
+  uint32_t lost = ((uint32_t)timer_elapsed(k->time) * FADE_RATE) >> 8;
+  return lost >= k->level ? 0 : k->level - lost;
+}
+
+void rgblight_reactive_led(uint8_t index, bool pressed) {
+  if (index >= RGBLED_NUM) {
+    return;
+  }
+
+  reactive_key_t *k = NULL;
+  for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_KEYS; i++) {
+    if (keys[i].led == index) {
+      k = &keys[i];
+      break;
+    }
+  }
+
+  if (!pressed) {
+    if (k && k->held) {
+      k->held = false;
+      k->time = timer_read();
+    }
+    return;
+  }
+
+  if (!k) {
+    // a free slot, or the one of the dimmest released key
+    uint8_t dimmest = 0xFF;
+    for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_KEYS; i++) {
+      if (keys[i].led == RGBLIGHT_REACTIVE_NO_LED) {
+        k = &keys[i];
+        break;
+      }
+      if (!keys[i].held && level_of(&keys[i]) <= dimmest) {
+        dimmest = level_of(&keys[i]);
+        k = &keys[i];
+      }
+    }
+    if (!k) {
+      return;
+    }
+  }
+  k->led = index;
+  k->level = 255;
+  k->held = true;
+  k->pressed = timer_read();
+  k->splash = 0;
+}
+
+void rgblight_reactive_key(uint8_t row, uint8_t col, bool pressed) {
+  if (row < MATRIX_ROWS && col < MATRIX_COLS) {
+    rgblight_reactive_led(pgm_read_byte(&rgblight_reactive_map[row][col]), pressed);
+  }
+}
+
+static void add(uint8_t index, const LED_TYPE *color, uint8_t shift) {
+  LED_TYPE *l = &led[index];
+  uint16_t r = l->r + (color->r >> shift);
+  uint16_t g = l->g + (color->g >> shift);
+  uint16_t b = l->b + (color->b >> shift);
+
+  saved[saved_count].index = index;
+  saved[saved_count].color = *l;
+  saved_count++;
+  l->r = r > 255 ? 255 : r;
+  l->g = g > 255 ? 255 : g;
+  l->b = b > 255 ? 255 : b;
+}
+
+void rgblight_reactive_draw(void) {
+  saved_count = 0;
+  if (!rgblight_config.enable) {
+    return;
+  }
+
+  for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_KEYS; i++) {
+    reactive_key_t *k = &keys[i];
+    if (k->led == RGBLIGHT_REACTIVE_NO_LED) {
+      continue;
+    }
+    uint8_t level = level_of(k);
+    if (!level) {
+      continue;
+    }
+
+    LED_TYPE color;
+    sethsv(rgblight_config.hue, rgblight_config.sat, (uint16_t)level * rgblight_config.val / 255, &color);
+    add(k->led, &color, 0);
+
+    if (k->splash < RGBLIGHT_REACTIVE_SPLASH) {
+      uint16_t reach = timer_elapsed(k->pressed) / RGBLIGHT_REACTIVE_SPLASH_SPEED;
+      k->splash = reach > RGBLIGHT_REACTIVE_SPLASH ? RGBLIGHT_REACTIVE_SPLASH : reach;
+    }
+    for (uint8_t d = 1; d <= k->splash; d++) {
+      if (k->led >= d) {
+        add(k->led - d, &color, d);
+      }
+      if (k->led + d < RGBLED_NUM) {
+        add(k->led + d, &color, d);
+      }
+    }
+  }
+}
+
+void rgblight_reactive_undraw(void) {
+  // backwards, an LED lit by two keys gets its first saved color back
+  while (saved_count) {
+    saved_count--;
+    led[saved[saved_count].index] = saved[saved_count].color;
+  }
+}
+
+void rgblight_reactive_task(void) {
+  bool active = false;
+  for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_KEYS; i++) {
+    if (keys[i].led == RGBLIGHT_REACTIVE_NO_LED) {
+      continue;
+    }
+    if (level_of(&keys[i])) {
+      active = true;
+    } else {
+      keys[i].led = RGBLIGHT_REACTIVE_NO_LED;
+    }
+  }
+  // one more frame after the last key went dark, to clear it
+  if (active || lit) {
+    rgblight_effects_flush();
+  }
+  lit = active;
+}
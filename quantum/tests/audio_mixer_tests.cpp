@@ -0,0 +1,188 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <stdlib.h>
+#include <algorithm>
+#include <vector>
+extern "C" {
+#include "mixer.h"
+}
+
+static pitch_t note(int semitone) {
+    return 24 * SYNTH_SEMITONE + semitone * SYNTH_SEMITONE;
+}
+
+class AudioMixer : public ::testing::Test {
+public:
+    AudioMixer() {
+        mixer_clear();
+    }
+
+    std::vector<pitch_t> playing() {
+        std::vector<pitch_t> pitches;
+        for (int i = 0; i < MIXER_VOICES; i++) {
+            if (mixer_voices[i].pitch != SYNTH_REST) {
+                pitches.push_back(mixer_voices[i].pitch);
+            }
+        }
+        return pitches;
+    }
+
+    /* sign changes of the mix over a second */
+    int crossings() {
+        int count = 0;
+        int16_t last = mixer_sample();
+        for (int i = 1; i < MIXER_SAMPLE_RATE; i++) {
+            int16_t sample = mixer_sample();
+            if ((sample < 0) != (last < 0)) {
+                count++;
+            }
+            last = sample;
+        }
+        return count;
+    }
+};
+
+using testing::UnorderedElementsAre;
+using testing::ElementsAre;
+
+TEST_F(AudioMixer, gives_each_note_a_voice) {
+    uint8_t a = mixer_note_on(note(0), 15, 128);
+    uint8_t b = mixer_note_on(note(4), 15, 128);
+    EXPECT_NE(a, b);
+    EXPECT_EQ(mixer_active(), 2);
+    EXPECT_EQ(mixer_newest(), b);
+    EXPECT_THAT(playing(), UnorderedElementsAre(note(0), note(4)));
+}
+
+TEST_F(AudioMixer, restarts_a_note_in_its_voice) {
+    uint8_t a = mixer_note_on(note(0), 15, 128);
+    mixer_note_on(note(4), 15, 128);
+    EXPECT_EQ(mixer_note_on(note(0), 8, 128), a);
+    EXPECT_EQ(mixer_active(), 2);
+    EXPECT_EQ(mixer_voices[a].volume, 8);
+    EXPECT_EQ(mixer_newest(), a);
+}
+
+TEST_F(AudioMixer, steals_the_oldest_note) {
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        mixer_note_on(note(i), 15, 128);
+    }
+    // restarting the first note makes the second one the oldest
+    mixer_note_on(note(0), 15, 128);
+    mixer_note_on(note(20), 15, 128);
+    EXPECT_EQ(mixer_active(), MIXER_VOICES);
+    std::vector<pitch_t> pitches = playing();
+    EXPECT_EQ(std::count(pitches.begin(), pitches.end(), note(1)), 0);
+    EXPECT_EQ(std::count(pitches.begin(), pitches.end(), note(20)), 1);
+    // the stolen note is gone from the map too
+    EXPECT_FALSE(mixer_note_off(note(1)));
+    EXPECT_TRUE(mixer_note_off(note(20)));
+}
+
+TEST_F(AudioMixer, stops_only_the_note) {
+    uint8_t a = mixer_note_on(note(0), 15, 128);
+    uint8_t b = mixer_note_on(note(7), 15, 128);
+    EXPECT_TRUE(mixer_note_off(note(0)));
+    EXPECT_FALSE(mixer_note_off(note(0)));
+    EXPECT_FALSE(mixer_note_off(note(3)));
+    EXPECT_FALSE(mixer_note_off(SYNTH_REST));
+    EXPECT_EQ(mixer_voices[a].pitch, SYNTH_REST);
+    EXPECT_EQ(mixer_voices[b].pitch, note(7));
+    EXPECT_EQ(mixer_active(), 1);
+}
+
+TEST_F(AudioMixer, stops_notes_sharing_a_semitone) {
+    mixer_note_on(note(5), 15, 128);
+    mixer_note_on(note(5) + 10, 15, 128);
+    mixer_note_on(note(5) - 10, 15, 128);
+    EXPECT_TRUE(mixer_note_off(note(5)));
+    EXPECT_TRUE(mixer_note_off(note(5) - 10));
+    EXPECT_TRUE(mixer_note_off(note(5) + 10));
+    EXPECT_EQ(mixer_active(), 0);
+}
+
+TEST_F(AudioMixer, newest_goes_back_to_the_last_note_still_playing) {
+    mixer_note_on(note(0), 15, 128);
+    uint8_t b = mixer_note_on(note(1), 15, 128);
+    mixer_note_on(note(2), 15, 128);
+    mixer_note_off(note(2));
+    EXPECT_EQ(mixer_newest(), b);
+    mixer_note_off(note(0));
+    EXPECT_EQ(mixer_newest(), b);
+    mixer_note_off(note(1));
+    EXPECT_EQ(mixer_newest(), MIXER_NO_VOICE);
+}
+
+TEST_F(AudioMixer, next_goes_round_the_playing_voices) {
+    EXPECT_EQ(mixer_next(0), MIXER_NO_VOICE);
+    uint8_t a = mixer_note_on(note(0), 15, 128);
+    EXPECT_EQ(mixer_next(a), a);
+    uint8_t b = mixer_note_on(note(1), 15, 128);
+    uint8_t c = mixer_note_on(note(2), 15, 128);
+    mixer_note_off(note(1));
+    EXPECT_EQ(mixer_next(a), c);
+    EXPECT_EQ(mixer_next(c), a);
+    EXPECT_EQ(mixer_next(b), c);
+    EXPECT_EQ(mixer_next(MIXER_NO_VOICE), a);
+}
+
+TEST_F(AudioMixer, is_silent_without_notes) {
+    for (int i = 0; i < 100; i++) {
+        EXPECT_EQ(mixer_sample(), 0);
+    }
+    uint16_t dac[4];
+    mixer_render_dac(dac, 4);
+    EXPECT_THAT(dac, ElementsAre(2048, 2048, 2048, 2048));
+}
+
+TEST_F(AudioMixer, plays_the_frequency_of_the_note) {
+    for (float frequency : {110.0f, 440.0f, 1046.5f, 3520.0f}) {
+        mixer_clear();
+        mixer_note_on(synth_pitch(frequency), 15, 128);
+        EXPECT_NEAR(crossings(), 2 * frequency, 3) << frequency;
+    }
+}
+
+TEST_F(AudioMixer, duty_follows_the_timbre) {
+    mixer_note_on(synth_pitch(440), 15, 64);
+    int high = 0;
+    for (int i = 0; i < MIXER_SAMPLE_RATE; i++) {
+        high += mixer_sample() > 0;
+    }
+    EXPECT_NEAR(high, MIXER_SAMPLE_RATE / 4, MIXER_SAMPLE_RATE / 200);
+}
+
+TEST_F(AudioMixer, mixes_all_voices_without_clipping) {
+    for (int i = 0; i < MIXER_VOICES; i++) {
+        mixer_note_on(note(i * 3), 0xFF, 128);
+    }
+    // all voices start high together
+    EXPECT_EQ(mixer_sample(), MIXER_VOICES * MIXER_VOLUME_MAX * MIXER_AMPLITUDE);
+    int16_t lowest = 0, highest = 0;
+    for (int i = 0; i < MIXER_SAMPLE_RATE; i++) {
+        int16_t sample = mixer_sample();
+        lowest = std::min(lowest, sample);
+        highest = std::max(highest, sample);
+    }
+    EXPECT_EQ(lowest, -MIXER_VOICES * MIXER_VOLUME_MAX * MIXER_AMPLITUDE);
+    EXPECT_LE(highest, INT16_MAX);
+    uint16_t dac[256];
+    mixer_render_dac(dac, 256);
+    for (uint16_t sample : dac) {
+        EXPECT_LT(sample, 1 << MIXER_DAC_BITS);
+    }
+}
+
+TEST_F(AudioMixer, mixes_two_notes) {
+    mixer_note_on(synth_pitch(440), 15, 128);
+    mixer_note_on(synth_pitch(660), 8, 128);
+    // the louder note decides the sign, the quieter one the level
+    int levels[3] = {0, 0, 0};
+    for (int i = 0; i < MIXER_SAMPLE_RATE; i++) {
+        int16_t sample = abs(mixer_sample());
+        levels[sample == 23 * MIXER_AMPLITUDE ? 0 : sample == 7 * MIXER_AMPLITUDE ? 1 : 2]++;
+    }
+    EXPECT_GT(levels[0], MIXER_SAMPLE_RATE / 3);
+    EXPECT_GT(levels[1], MIXER_SAMPLE_RATE / 3);
+    EXPECT_EQ(levels[2], 0);
+}
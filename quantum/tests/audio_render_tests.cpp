@@ -0,0 +1,277 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <math.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string>
+#include <vector>
+extern "C" {
+#include "audio.h"
+#include "audio_host.h"
+}
+
+extern "C" {
+bool eeconfig_is_enabled(void) { return true; }
+void eeconfig_init(void) {}
+uint8_t eeconfig_read_audio(void) { return 1; }
+void eeconfig_update_audio(uint8_t val) {}
+void audio_on_user(void) {}
+}
+
+struct Heard {
+    double onset;
+    double frequency;
+};
+
+/* seconds of a float song duration and of a rest at the default tempo */
+static double duration_seconds(double duration) {
+    return duration * 0xFFFF * TEMPO_DEFAULT / 400 / SYNTH_CLOCK;
+}
+
+static double rest_seconds(double rest) {
+    return rest * 0xFFFF / SYNTH_CLOCK;
+}
+
+/* the notes a song should sound, consecutive equal notes run together
+ * without a rest between them */
+static std::vector<Heard> score(const float (*notes)[2], size_t count, float rest, int repeats) {
+    std::vector<Heard> expected;
+    double time = 0;
+    float last = 0;
+    for (int r = 0; r < repeats; r++) {
+        for (size_t i = 0; i < count; i++) {
+            float frequency = notes[i][0];
+            if (frequency > 0 && (frequency != last || rest > 0)) {
+                expected.push_back({time, frequency});
+            }
+            last = frequency;
+            time += duration_seconds(notes[i][1]) + rest_seconds(rest);
+        }
+    }
+    return expected;
+}
+
+class AudioRender : public ::testing::Test {
+public:
+    AudioRender() {
+        stop_all_notes();
+        audio_host_reset();
+    }
+
+    std::vector<int16_t> render(double seconds) {
+        std::vector<int16_t> samples(seconds * AUDIO_HOST_SAMPLE_RATE);
+        audio_host_render(samples.data(), samples.size());
+        save(samples);
+        return samples;
+    }
+
+    /* rising edges in samples, exact while a period has whole low and high samples */
+    static std::vector<double> rising_edges(const std::vector<int16_t> &samples) {
+        std::vector<double> edges;
+        for (size_t i = 1; i + 1 < samples.size(); i++) {
+            if (samples[i - 1] == -AUDIO_HOST_AMPLITUDE && samples[i] > -AUDIO_HOST_AMPLITUDE && samples[i + 1] == AUDIO_HOST_AMPLITUDE) {
+                edges.push_back(i + (double)(AUDIO_HOST_AMPLITUDE - samples[i]) / (2 * AUDIO_HOST_AMPLITUDE));
+            }
+        }
+        return edges;
+    }
+
+    /* notes as runs of periods of the same length */
+    static std::vector<Heard> listen(const std::vector<int16_t> &samples) {
+        std::vector<double> edges = rising_edges(samples);
+        std::vector<Heard> heard;
+        size_t start = 0;
+        auto note = [&](size_t end) {
+            if (end >= start + 3) {
+                heard.push_back({edges[start] / AUDIO_HOST_SAMPLE_RATE, (end - start) * AUDIO_HOST_SAMPLE_RATE / (edges[end] - edges[start])});
+            }
+            start = end;
+        };
+        for (size_t i = start + 2; i < edges.size(); i++) {
+            double first = edges[start + 1] - edges[start];
+            if (i - 1 > start && fabs(edges[i] - edges[i - 1] - first) > first * 0.015) {
+                note(i - 1);
+            }
+        }
+        if (!edges.empty()) {
+            note(edges.size() - 1);
+        }
+        return heard;
+    }
+
+    static void expect_notes(const std::vector<Heard> &heard, const std::vector<Heard> &expected) {
+        ASSERT_EQ(heard.size(), expected.size());
+        for (size_t i = 0; i < expected.size(); i++) {
+            // a note starts after the last period of the one before, the
+            // first edge of the first note is a period in
+            double late = 1 / expected[i > 0 ? i - 1 : 0].frequency;
+            EXPECT_NEAR(heard[i].onset, expected[i].onset + late / 2, late / 2 + 0.002 + expected[i].onset * 0.002) << "note " << i;
+            EXPECT_NEAR(heard[i].frequency, expected[i].frequency, expected[i].frequency * 0.005) << "note " << i;
+        }
+    }
+
+private:
+    /* keeps the renders as WAV files in $AUDIO_RENDER_DIR when set */
+    void save(const std::vector<int16_t> &samples) {
+        const char *dir = getenv("AUDIO_RENDER_DIR");
+        if (!dir) {
+            return;
+        }
+        const ::testing::TestInfo *test = ::testing::UnitTest::GetInstance()->current_test_info();
+        std::string path = std::string(dir) + "/" + test->name() + "_" + std::to_string(saved++) + ".wav";
+        FILE *file = fopen(path.c_str(), "wb");
+        ASSERT_NE(file, nullptr) << path;
+        EXPECT_TRUE(audio_host_write_wav(file, samples.data(), samples.size()));
+        fclose(file);
+    }
+
+    int saved = 0;
+};
+
+TEST_F(AudioRender, is_silent_without_notes) {
+    for (int16_t sample : render(0.1)) {
+        ASSERT_EQ(sample, 0);
+    }
+    EXPECT_EQ(audio_host.interrupts, 0);
+}
+
+TEST_F(AudioRender, plays_a_compact_song) {
+    static const float notes[][2] = SONG(ONE_UP_SOUND);
+    static const uint8_t PROGMEM one_up[] = SONG_DATA(ONE_UP_SOUND);
+    PLAY_SONG(one_up, false, 0);
+    expect_notes(listen(render(1)), score(notes, NOTE_ARRAY_SIZE(notes), 0, 1));
+    EXPECT_FALSE(is_playing_notes());
+}
+
+TEST_F(AudioRender, plays_a_float_song_with_rests) {
+    static float notes[][2] = SONG(ODE_TO_JOY);
+    PLAY_NOTE_ARRAY(notes, false, 1);
+    expect_notes(listen(render(3)), score(notes, NOTE_ARRAY_SIZE(notes), 1, 1));
+}
+
+TEST_F(AudioRender, repeats_a_song) {
+    static const float notes[][2] = SONG(SONIC_RING);
+    static const uint8_t PROGMEM ring[] = SONG_DATA(SONIC_RING);
+    PLAY_SONG(ring, true, 0);
+    std::vector<Heard> heard = listen(render(1.2));
+    EXPECT_TRUE(is_playing_notes());
+    // twice through the song of 0.52s
+    std::vector<Heard> expected = score(notes, NOTE_ARRAY_SIZE(notes), 0, 3);
+    expected.resize(6);
+    heard.resize(std::min(heard.size(), expected.size()));
+    expect_notes(heard, expected);
+}
+
+TEST_F(AudioRender, follows_the_tempo) {
+    static const float notes[][2] = SONG(ONE_UP_SOUND);
+    static const uint8_t PROGMEM one_up[] = SONG_DATA(ONE_UP_SOUND);
+    set_tempo(TEMPO_DEFAULT / 2);
+    PLAY_SONG(one_up, false, 0);
+    std::vector<Heard> heard = listen(render(0.6));
+    set_tempo(TEMPO_DEFAULT);
+    std::vector<Heard> expected = score(notes, NOTE_ARRAY_SIZE(notes), 0, 1);
+    for (Heard &note : expected) {
+        note.onset /= 2;
+    }
+    expect_notes(heard, expected);
+}
+
+TEST_F(AudioRender, music_mode_glides_to_the_newest_note) {
+    play_note(440, 0xF);
+    expect_notes(listen(render(0.2)), {{0, 440}});
+
+    play_note(880, 0xF);
+    std::vector<int16_t> samples = render(0.5);
+    // the periods shorten a step each, the glide takes about 50ms
+    std::vector<double> edges = rising_edges(samples);
+    ASSERT_GE(edges.size(), 10);
+    double period = edges[1] - edges[0];
+    EXPECT_LT(AUDIO_HOST_SAMPLE_RATE / period, 500);
+    int gliding = 0;
+    for (size_t i = 2; i < edges.size(); i++) {
+        double next = edges[i] - edges[i - 1];
+        EXPECT_LT(next, period * 1.005) << "edge " << i;
+        gliding += AUDIO_HOST_SAMPLE_RATE / next < 850;
+        period = next;
+    }
+    EXPECT_GT(gliding, 10);
+    std::vector<Heard> heard = listen(samples);
+    ASSERT_EQ(heard.size(), 1);
+    EXPECT_NEAR(heard[0].onset, 0.05, 0.02);
+    EXPECT_NEAR(heard[0].frequency, 880, 880 * 0.005);
+
+    stop_note(880);
+    stop_note(440);
+    std::vector<int16_t> silence = render(0.1);
+    EXPECT_EQ(silence.back(), 0);
+}
+
+TEST_F(AudioRender, plays_a_sample) {
+    // 500Hz square wave at 8000 samples a second
+    static uint8_t data[AUDIO_SAMPLE_RATE / 10];
+    for (size_t i = 0; i < sizeof(data); i++) {
+        data[i] = i % 16 < 8 ? 0xE0 : 0x20;
+    }
+    static const audio_sample_t square = SAMPLE(data, SAMPLE_PCM8, sizeof(data));
+    play_sample(&square, false);
+
+    std::vector<int16_t> samples(AUDIO_HOST_SAMPLE_RATE / 5);
+    int crossings = 0;
+    for (size_t i = 0; i < samples.size(); i += 64) {
+        audio_host_render(&samples[i], std::min<size_t>(64, samples.size() - i));
+        sample_task();
+    }
+    // the mean over two periods of the PWM is the sample, with some
+    // hysteresis for the steps of the window
+    const int32_t window = 2 * AUDIO_HOST_SAMPLE_RATE / AUDIO_SAMPLE_RATE;
+    const int32_t threshold = window * AUDIO_HOST_AMPLITUDE / 4;
+    int32_t sum = 0;
+    int sign = 0;
+    for (size_t i = 0; i < samples.size(); i++) {
+        sum += samples[i] - (i >= (size_t)window ? samples[i - window] : 0);
+        int now = sum > threshold ? 1 : sum < -threshold ? -1 : sign;
+        crossings += sign != 0 && now != sign;
+        sign = now;
+    }
+    // a tenth of a second of it, then silence
+    EXPECT_NEAR(crossings, 2 * 500 / 10, 2);
+    EXPECT_EQ(samples.back(), 0);
+    EXPECT_NEAR(audio_host.interrupts, AUDIO_SAMPLE_RATE / 10, 2 * SAMPLE_BUFFER_SIZE);
+}
+
+TEST_F(AudioRender, interrupts_once_a_period) {
+    play_note(440, 0xF);
+    render(1);
+    EXPECT_NEAR(audio_host.interrupts, 440, 2);
+}
+
+TEST_F(AudioRender, writes_a_wav_file) {
+    play_note(440, 0xF);
+    std::vector<int16_t> samples = render(0.01);
+    FILE *file = tmpfile();
+    ASSERT_NE(file, nullptr);
+    ASSERT_TRUE(audio_host_write_wav(file, samples.data(), samples.size()));
+
+    std::vector<uint8_t> wav(44 + 2 * samples.size() + 1);
+    rewind(file);
+    ASSERT_EQ(fread(wav.data(), 1, wav.size(), file), wav.size() - 1);
+    fclose(file);
+    auto le = [&](size_t at, int bytes) {
+        uint32_t value = 0;
+        for (int i = bytes - 1; i >= 0; i--) {
+            value = value << 8 | wav[at + i];
+        }
+        return value;
+    };
+    EXPECT_EQ(std::string(wav.begin(), wav.begin() + 4), "RIFF");
+    EXPECT_EQ(le(4, 4), wav.size() - 1 - 8);
+    EXPECT_EQ(std::string(wav.begin() + 8, wav.begin() + 16), "WAVEfmt ");
+    EXPECT_EQ(le(22, 2), 1);
+    EXPECT_EQ(le(24, 4), AUDIO_HOST_SAMPLE_RATE);
+    EXPECT_EQ(le(34, 2), 16);
+    EXPECT_EQ(std::string(wav.begin() + 36, wav.begin() + 40), "data");
+    EXPECT_EQ(le(40, 4), 2 * samples.size());
+    for (size_t i = 0; i < samples.size(); i++) {
+        ASSERT_EQ((int16_t)le(44 + 2 * i, 2), samples[i]);
+    }
+}
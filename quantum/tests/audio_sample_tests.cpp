@@ -0,0 +1,207 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <math.h>
+#include <vector>
+extern "C" {
+#include "adpcm.h"
+#include "sample.h"
+}
+
+static const int steps[ADPCM_STEPS] = {
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767};
+static const int index_changes[8] = {-1, -1, -1, -1, 2, 4, 6, 8};
+
+/* IMA-ADPCM as specified, the encoder keeps the state of a decoder */
+struct Reference {
+    int predictor = 0;
+    int index = 0;
+
+    int decode(uint8_t code) {
+        int step = steps[index];
+        int diff = step >> 3;
+        if (code & 4) diff += step;
+        if (code & 2) diff += step >> 1;
+        if (code & 1) diff += step >> 2;
+        predictor += code & 8 ? -diff : diff;
+        predictor = std::max(-32768, std::min(32767, predictor));
+        index = std::max(0, std::min(ADPCM_STEPS - 1, index + index_changes[code & 7]));
+        return predictor;
+    }
+
+    uint8_t encode(int sample) {
+        int step = steps[index];
+        int diff = sample - predictor;
+        uint8_t code = 0;
+        if (diff < 0) {
+            code = 8;
+            diff = -diff;
+        }
+        for (uint8_t bit = 4; bit; bit >>= 1, step >>= 1) {
+            if (diff >= step) {
+                code |= bit;
+                diff -= step;
+            }
+        }
+        decode(code);
+        return code;
+    }
+};
+
+static std::vector<int16_t> chirp(int count) {
+    std::vector<int16_t> pcm;
+    for (int i = 0; i < count; i++) {
+        double t = (double)i / AUDIO_SAMPLE_RATE;
+        pcm.push_back(12000 * sin(2 * M_PI * (100 + 1000 * t) * t) * std::min(1.0, i / 400.0));
+    }
+    return pcm;
+}
+
+static std::vector<uint8_t> pack(const std::vector<uint8_t> &codes) {
+    std::vector<uint8_t> data((codes.size() + 1) / 2);
+    for (size_t i = 0; i < codes.size(); i++) {
+        data[i / 2] |= i & 1 ? codes[i] << 4 : codes[i];
+    }
+    return data;
+}
+
+TEST(AudioSample, decodes_known_codes) {
+    adpcm_state_t state;
+    adpcm_init(&state);
+    // 7/8 + 1/8 of step 7, then down by the same of step 16
+    EXPECT_EQ(adpcm_decode(&state, 7), 11);
+    EXPECT_EQ(state.index, 8);
+    EXPECT_EQ(adpcm_decode(&state, 8 | 7), 11 - 30);
+    EXPECT_EQ(state.index, 16);
+    EXPECT_EQ(adpcm_decode(&state, 0), 11 - 30 + 4);
+    EXPECT_EQ(state.index, 15);
+}
+
+TEST(AudioSample, decodes_like_the_reference) {
+    std::vector<int16_t> pcm = chirp(AUDIO_SAMPLE_RATE);
+    Reference encoder;
+    std::vector<uint8_t> codes;
+    std::vector<int> expected;
+    for (int16_t sample : pcm) {
+        codes.push_back(encoder.encode(sample));
+        expected.push_back(encoder.predictor);
+    }
+
+    adpcm_state_t state;
+    adpcm_init(&state);
+    double signal = 0, noise = 0;
+    for (size_t i = 0; i < codes.size(); i++) {
+        int16_t decoded = adpcm_decode(&state, codes[i]);
+        ASSERT_EQ(decoded, expected[i]) << "sample " << i;
+        signal += (double)pcm[i] * pcm[i];
+        noise += (double)(decoded - pcm[i]) * (decoded - pcm[i]);
+    }
+    // 4 bit codes, the fast end of the chirp is the hardest to follow
+    EXPECT_GT(10 * log10(signal / noise), 20);
+}
+
+TEST(AudioSample, clamps_at_full_scale) {
+    adpcm_state_t state;
+    adpcm_init(&state);
+    for (int i = 0; i < 100; i++) {
+        adpcm_decode(&state, 7);
+    }
+    EXPECT_EQ(state.predictor, INT16_MAX);
+    EXPECT_EQ(state.index, ADPCM_STEPS - 1);
+    for (int i = 0; i < 10; i++) {
+        adpcm_decode(&state, 8 | 7);
+    }
+    EXPECT_EQ(state.predictor, INT16_MIN);
+    for (int i = 0; i < 100; i++) {
+        adpcm_decode(&state, 0);
+    }
+    EXPECT_EQ(state.index, 0);
+}
+
+TEST(AudioSample, reads_adpcm_low_codes_first) {
+    std::vector<int16_t> pcm = chirp(999);
+    Reference encoder;
+    std::vector<uint8_t> codes;
+    for (int16_t sample : pcm) {
+        codes.push_back(encoder.encode(sample));
+    }
+    std::vector<uint8_t> data = pack(codes);
+    EXPECT_EQ(data.size(), SAMPLE_BYTES(SAMPLE_ADPCM, pcm.size()));
+    audio_sample_t sample = SAMPLE(data.data(), SAMPLE_ADPCM, (uint32_t)pcm.size());
+
+    // twice through, the state starts over each time
+    sample_reader_t reader;
+    sample_start(&reader, &sample, true);
+    for (int pass = 0; pass < 2; pass++) {
+        Reference decoder;
+        for (size_t i = 0; i < codes.size(); i++) {
+            ASSERT_TRUE(sample_more(&reader));
+            ASSERT_EQ(sample_read(&reader), decoder.decode(codes[i])) << "pass " << pass << " sample " << i;
+        }
+    }
+    EXPECT_TRUE(sample_more(&reader));
+}
+
+TEST(AudioSample, reads_pcm8_and_ends_in_silence) {
+    const uint8_t data[] = {0x80, 0xFF, 0x00, 0x90};
+    audio_sample_t sample = SAMPLE(data, SAMPLE_PCM8, 4);
+    sample_reader_t reader;
+    sample_start(&reader, &sample, false);
+    EXPECT_EQ(sample_read(&reader), 0);
+    EXPECT_EQ(sample_read(&reader), 0x7F00);
+    EXPECT_EQ(sample_read(&reader), -0x8000);
+    EXPECT_EQ(sample_read(&reader), 0x1000);
+    EXPECT_FALSE(sample_more(&reader));
+    EXPECT_EQ(sample_read(&reader), 0);
+}
+
+TEST(AudioSample, outputs_pwm_duties) {
+    EXPECT_EQ(sample_output(INT16_MIN), 0);
+    EXPECT_EQ(sample_output(0), SAMPLE_PERIOD / 2);
+    EXPECT_EQ(sample_output(INT16_MAX), SAMPLE_PERIOD - 1);
+}
+
+TEST(AudioSample, plays_through_the_double_buffer) {
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 5 * SAMPLE_BUFFER_SIZE / 2; i++) {
+        data.push_back(i * 7);
+    }
+    audio_sample_t sample = SAMPLE(data.data(), SAMPLE_PCM8, (uint32_t)data.size());
+    sample_play(&sample, false);
+    EXPECT_TRUE(sample_playing());
+
+    std::vector<sample_output_t> played;
+    sample_output_t output;
+    // the scan keeps up for a half, then falls behind for a few samples
+    for (int i = 0; i < SAMPLE_BUFFER_SIZE; i++) {
+        ASSERT_TRUE(sample_pop(&output));
+        played.push_back(output);
+    }
+    sample_task();
+    for (int i = 0; i < 2 * SAMPLE_BUFFER_SIZE; i++) {
+        ASSERT_TRUE(sample_pop(&output));
+        played.push_back(output);
+    }
+    for (int i = 0; i < 3; i++) {
+        ASSERT_TRUE(sample_pop(&output));
+        EXPECT_EQ(output, SAMPLE_PERIOD / 2);
+    }
+    sample_task();
+    while (sample_pop(&output)) {
+        played.push_back(output);
+        sample_task();
+    }
+    EXPECT_FALSE(sample_playing());
+
+    // the last half is padded with silence
+    ASSERT_EQ(played.size(), 3 * SAMPLE_BUFFER_SIZE);
+    for (size_t i = 0; i < played.size(); i++) {
+        int16_t level = i < data.size() ? ((int16_t)data[i] - 0x80) * 256 : 0;
+        ASSERT_EQ(played[i], sample_output(level)) << "sample " << i;
+    }
+}
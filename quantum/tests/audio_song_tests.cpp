@@ -0,0 +1,123 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <stdlib.h>
+#include <vector>
+extern "C" {
+#include "song.h"
+#include "song_list.h"
+}
+
+struct Song {
+    const char *name;
+    const float (*notes)[2];
+    size_t count;
+    const uint8_t *data;
+    size_t length;
+};
+
+#define SONG_CASE(song)                                              \
+    [] {                                                             \
+        static const float notes[][2] = SONG(song);                  \
+        /* SONG_DATA(song) would get song already expanded */        \
+        static const uint8_t data[] = { song##_DATA };               \
+        return Song{#song, notes, sizeof(notes) / sizeof(notes[0]), data, sizeof(data)}; \
+    }()
+
+static const std::vector<Song> songs = {
+    SONG_CASE(COIN_SOUND),
+    SONG_CASE(ODE_TO_JOY),
+    SONG_CASE(ROCK_A_BYE_BABY),
+    SONG_CASE(CLOSE_ENCOUNTERS_5_NOTE),
+    SONG_CASE(DOE_A_DEER),
+    SONG_CASE(IN_LIKE_FLINT),
+    SONG_CASE(GOODBYE_SOUND),
+    SONG_CASE(STARTUP_SOUND),
+    SONG_CASE(QWERTY_SOUND),
+    SONG_CASE(COLEMAK_SOUND),
+    SONG_CASE(DVORAK_SOUND),
+    SONG_CASE(PLOVER_SOUND),
+    SONG_CASE(PLOVER_GOODBYE_SOUND),
+    SONG_CASE(MUSIC_SCALE_SOUND),
+    SONG_CASE(CAPS_LOCK_ON_SOUND),
+    SONG_CASE(CAPS_LOCK_OFF_SOUND),
+    SONG_CASE(SCROLL_LOCK_ON_SOUND),
+    SONG_CASE(SCROLL_LOCK_OFF_SOUND),
+    SONG_CASE(NUM_LOCK_ON_SOUND),
+    SONG_CASE(NUM_LOCK_OFF_SOUND),
+    SONG_CASE(UNICODE_WINDOWS),
+    SONG_CASE(UNICODE_LINUX),
+    SONG_CASE(ONE_UP_SOUND),
+    SONG_CASE(SONIC_RING),
+    SONG_CASE(ZELDA_PUZZLE),
+};
+
+static std::vector<song_note_t> decode(const uint8_t *data, uint16_t length) {
+    std::vector<song_note_t> notes;
+    song_reader_t reader;
+    song_note_t note;
+    song_start(&reader, data, length);
+    while (song_next(&reader, &note)) {
+        notes.push_back(note);
+    }
+    EXPECT_FALSE(song_more(&reader));
+    return notes;
+}
+
+TEST(AudioSong, decodes_the_songs_of_the_song_list) {
+    for (const Song &song : songs) {
+        std::vector<song_note_t> notes = decode(song.data, song.length);
+        ASSERT_EQ(notes.size(), song.count) << song.name;
+        for (size_t i = 0; i < song.count; i++) {
+            pitch_t expected = synth_pitch(song.notes[i][0]);
+            pitch_t pitch = song_pitch(notes[i].note);
+            EXPECT_LE(abs((int)pitch - (int)expected), 1) << song.name << " note " << i;
+            EXPECT_EQ(notes[i].duration, song.notes[i][1]) << song.name << " note " << i;
+        }
+    }
+}
+
+TEST(AudioSong, is_smaller_than_the_float_songs) {
+    size_t floats = 0, bytes = 0;
+    for (const Song &song : songs) {
+        EXPECT_LE(song.length, 2 * song.count) << song.name;
+        floats += song.count * 2 * sizeof(float);
+        bytes += song.length;
+    }
+    EXPECT_LT(bytes * 5, floats);
+}
+
+TEST(AudioSong, repeats_the_last_duration) {
+    const uint8_t data[] = {69, 16, 71 | SONG_SAME_DURATION, SONG_NOTE_REST, 8, 72 | SONG_SAME_DURATION};
+    std::vector<song_note_t> notes = decode(data, sizeof(data));
+    ASSERT_EQ(notes.size(), 4);
+    EXPECT_EQ(notes[0].note, 69);
+    EXPECT_EQ(notes[0].duration, 16);
+    EXPECT_EQ(notes[1].note, 71);
+    EXPECT_EQ(notes[1].duration, 16);
+    EXPECT_EQ(notes[2].note, SONG_NOTE_REST);
+    EXPECT_EQ(notes[2].duration, 8);
+    EXPECT_EQ(notes[3].note, 72);
+    EXPECT_EQ(notes[3].duration, 8);
+}
+
+TEST(AudioSong, stops_at_a_truncated_note) {
+    const uint8_t data[] = {69, 16, 71};
+    EXPECT_EQ(decode(data, sizeof(data)).size(), 1);
+    EXPECT_EQ(decode(data, 0).size(), 0);
+}
+
+TEST(AudioSong, pitches_follow_the_midi_notes) {
+    EXPECT_EQ(song_pitch(SONG_NOTE_REST), SYNTH_REST);
+    EXPECT_NEAR(song_pitch(SONG_NOTE_A4), synth_pitch(440.0f), 1);
+    EXPECT_EQ(song_pitch(SONG_NOTE_A4 + 12) - song_pitch(SONG_NOTE_A4), SYNTH_OCTAVE);
+    EXPECT_NEAR(song_pitch(60), synth_pitch(261.63f), 1);
+}
+
+TEST(AudioSong, ticks_follow_the_tempo) {
+    for (uint8_t tempo : {50, 100, 200}) {
+        for (uint8_t duration : {1, 16, 64, 255}) {
+            double expected = duration / 4.0 * tempo / 100 * 0xFFFF;
+            EXPECT_NEAR(song_ticks(duration, tempo), expected, duration) << (int)tempo << " " << (int)duration;
+        }
+    }
+}
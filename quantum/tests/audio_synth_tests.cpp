@@ -0,0 +1,143 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <math.h>
+extern "C" {
+#include "synth.h"
+}
+
+/* the float maths audio.c used to do in the interrupt */
+static const double vibrato_lut[20] = {
+    1.0022336811487, 1.0042529943610, 1.0058584256028, 1.0068905285205,
+    1.0072464122237, 1.0068905285205, 1.0058584256028, 1.0042529943610,
+    1.0022336811487, 1.0000000000000, 0.9977712970630, 0.9957650169978,
+    0.9941756956510, 0.9931566259436, 0.9928057204913, 0.9931566259436,
+    0.9941756956510, 0.9957650169978, 0.9977712970630, 1.0000000000000,
+};
+
+static uint16_t reference_period(double frequency) {
+    return (uint16_t)(F_CPU / (frequency * SYNTH_PRESCALER));
+}
+
+static double frequency_of(pitch_t pitch) {
+    return (double)SYNTH_CLOCK / synth_period(pitch);
+}
+
+static double reference_glide(double frequency, double target) {
+    if (frequency < target && frequency < target * pow(2, -440 / target / 12 / 2)) {
+        return frequency * pow(2, 440 / frequency / 12 / 2);
+    } else if (frequency > target && frequency > target * pow(2, 440 / target / 12 / 2)) {
+        return frequency * pow(2, -440 / frequency / 12 / 2);
+    }
+    return target;
+}
+
+TEST(AudioSynth, period_matches_the_float_division) {
+    for (double frequency = 31; frequency < 8000; frequency *= 1.013) {
+        double reference = reference_period(frequency);
+        double period = synth_period(synth_pitch(frequency));
+        EXPECT_LE(fabs(period - reference), 1 + reference * 0.0005) << frequency << "Hz";
+    }
+}
+
+TEST(AudioSynth, pitch_is_semitones_above_the_lowest_period) {
+    double lowest = (double)SYNTH_CLOCK / 0xFFFF;
+    EXPECT_EQ(synth_period(0), 0xFFFF);
+    EXPECT_EQ(synth_period(SYNTH_OCTAVE), 0x8000);
+    EXPECT_EQ(synth_period(3 * SYNTH_OCTAVE), 0x2000);
+    EXPECT_NEAR(synth_pitch(lowest * 2), SYNTH_OCTAVE, 1);
+    EXPECT_NEAR(synth_pitch(lowest * pow(2, 7 / 12.0)), 7 * SYNTH_SEMITONE, 1);
+    EXPECT_NEAR(synth_pitch(880) - synth_pitch(440), SYNTH_OCTAVE, 1);
+}
+
+TEST(AudioSynth, rests_and_out_of_range_frequencies) {
+    EXPECT_EQ(synth_pitch(0), SYNTH_REST);
+    EXPECT_EQ(synth_pitch(-440), SYNTH_REST);
+    // the lowest note is the lowest period, not a rest
+    EXPECT_EQ(synth_pitch(1), 1);
+    EXPECT_EQ(synth_pitch(1e30), 0xFFFF);
+    EXPECT_GE(synth_period(0xFFFF), 1);
+}
+
+TEST(AudioSynth, pitch_of_period_inverts_period) {
+    for (uint32_t pitch = 1; pitch < 10 * SYNTH_OCTAVE; pitch += 37) {
+        uint16_t period = synth_period(pitch);
+        EXPECT_EQ(synth_period(synth_pitch_of_period(period)), period) << pitch;
+    }
+    EXPECT_EQ(synth_pitch_of_period(0xFFFF), 1);
+}
+
+TEST(AudioSynth, mul_matches_the_float_product) {
+    for (float x : {0.01f, 0.25f, 0.5f, 1.0f, 1.5f, 3.0f, 12.0f, 16.0f, 64.0f, 100.5f}) {
+        for (uint16_t k : {1, 100, 0x7FF, 16383, 41779, 0xFFFF}) {
+            double reference = (double)x * k;
+            EXPECT_NEAR(synth_mul(x, k), reference, reference / 30000 + 1) << x << " * " << k;
+        }
+    }
+    EXPECT_EQ(synth_mul(0, 1000), 0);
+    EXPECT_EQ(synth_mul(-2, 1000), 0);
+}
+
+TEST(AudioSynth, transpose_keeps_the_range) {
+    EXPECT_EQ(synth_transpose(1000, -SYNTH_OCTAVE), 1);
+    EXPECT_EQ(synth_transpose(0xFF00, SYNTH_OCTAVE), 0xFFFF);
+    EXPECT_EQ(synth_transpose(SYNTH_REST, SYNTH_OCTAVE), SYNTH_REST);
+    EXPECT_EQ(synth_transpose(5000, -SYNTH_OCTAVE), 5000 - SYNTH_OCTAVE);
+}
+
+TEST(AudioSynth, glide_follows_the_float_glissando) {
+    for (auto notes : {std::make_pair(220.0, 880.0), std::make_pair(1760.0, 110.0), std::make_pair(440.0, 466.16)}) {
+        double reference = notes.first;
+        pitch_t pitch = synth_pitch(notes.first);
+        pitch_t target = synth_pitch(notes.second);
+        int reference_steps = 0, steps = 0;
+        for (int i = 0; i < 10000 && (reference != notes.second || pitch != target); i++) {
+            if (reference != notes.second) {
+                reference = reference_glide(reference, notes.second);
+                reference_steps++;
+            }
+            if (pitch != target) {
+                pitch = synth_glide(pitch, target);
+                steps++;
+            }
+            if (reference != notes.second && pitch != target) {
+                EXPECT_NEAR(frequency_of(pitch) / reference, 1, 0.01) << notes.first << " to " << notes.second << " step " << i;
+            }
+        }
+        EXPECT_EQ(pitch, target);
+        EXPECT_NEAR(steps, reference_steps, 2 + reference_steps / 50);
+    }
+}
+
+TEST(AudioSynth, glide_jumps_from_a_rest) {
+    EXPECT_EQ(synth_glide(SYNTH_REST, 1000), 1000);
+    EXPECT_EQ(synth_glide(1000, SYNTH_REST), SYNTH_REST);
+}
+
+TEST(AudioSynth, vibrato_follows_the_float_vibrato) {
+    for (double strength : {1.0, 0.5}) {
+        for (double frequency : {110.0, 440.0, 1318.5}) {
+            double rate = 0.125, counter = 0, travelled = 0;
+            synth_vibrato_t vibrato = {0, uint8_t(rate * 256), uint16_t(strength * 256)};
+            pitch_t pitch = synth_pitch(frequency);
+            double base = frequency_of(pitch);
+            for (int i = 0; i < 2000; i++) {
+                // the phase keeps up with the float counter, the rounding
+                // of the increment makes the rate a little off
+                double drift = fabs((double)vibrato.phase / SYNTH_VIBRATO_STEP - counter);
+                EXPECT_LT(fmin(drift, 20 - drift), 0.01 + travelled * 0.002) << frequency << "Hz interrupt " << i;
+                // and the depth is the float one at the entry of the phase
+                double reference = base * pow(vibrato_lut[vibrato.phase / SYNTH_VIBRATO_STEP], strength);
+                counter = fmod(counter + rate * (1.0 + 440.0 / base), 20);
+                travelled += rate * (1.0 + 440.0 / base);
+                double vibrated = frequency_of(synth_vibrato(&vibrato, pitch));
+                EXPECT_NEAR(vibrated / reference, 1, 0.0002 + 1.0 / synth_period(pitch)) << frequency << "Hz interrupt " << i;
+            }
+        }
+    }
+}
+
+TEST(AudioSynth, vibrato_offsets_wrap) {
+    EXPECT_EQ(synth_vibrato_offset(4), 32);
+    EXPECT_EQ(synth_vibrato_offset(14), -32);
+    EXPECT_EQ(synth_vibrato_offset(24), 32);
+}
@@ -0,0 +1,95 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <vector>
+extern "C" {
+#include "backlight_pwm.h"
+#include "led_tables.h"
+}
+
+TEST(BacklightLevelDuty, is_off_and_fully_on_at_the_ends) {
+    EXPECT_EQ(backlight_level_duty(0, 3), 0);
+    EXPECT_EQ(backlight_level_duty(3, 3), BACKLIGHT_DUTY_MAX);
+    EXPECT_EQ(backlight_level_duty(15, 15), BACKLIGHT_DUTY_MAX);
+}
+
+TEST(BacklightLevelDuty, follows_the_cie_curve) {
+    for (int levels = 1; levels <= 15; levels++) {
+        uint16_t last = 0;
+        for (int level = 1; level <= levels; level++) {
+            uint16_t duty = backlight_level_duty(level, levels);
+            EXPECT_EQ(duty, CIE1931_CURVE[level * 255 / levels] * 257);
+            EXPECT_GT(duty, last) << level << "/" << levels;
+            last = duty;
+        }
+    }
+}
+
+static std::vector<uint16_t> breathe(breathing_t& b, int periods, int* stopped = nullptr) {
+    std::vector<uint16_t> duties;
+    for (int i = 0; i < periods; i++) {
+        uint16_t duty;
+        bool more = breathing_next(&b, &duty);
+        duties.push_back(duty);
+        if (!more) {
+            if (stopped) *stopped = i;
+            break;
+        }
+    }
+    return duties;
+}
+
+TEST(Breathing, rises_and_falls_over_the_steps) {
+    breathing_t b = {0, 0, 0, BREATHING_NO_HALT};
+    auto duties = breathe(b, BREATHING_STEPS);
+    EXPECT_EQ(duties[0], 0);
+    EXPECT_EQ(duties[BREATHING_TOP], BACKLIGHT_DUTY_MAX);
+    for (int i = 1; i < BREATHING_STEPS / 2; i++) {
+        EXPECT_GE(duties[i], duties[i - 1]);
+        EXPECT_EQ(duties[BREATHING_TOP - i], duties[BREATHING_TOP + i]);
+    }
+}
+
+TEST(Breathing, holds_each_step_for_the_speed) {
+    breathing_t b = {0, 4, 0, BREATHING_NO_HALT};
+    auto duties = breathe(b, BREATHING_STEPS << 4);
+    // 64 steps of 16 periods, a 4.2s breath at 244 periods a second
+    for (int i = 0; i < BREATHING_STEPS << 4; i++) {
+        EXPECT_EQ(duties[i], duties[i & ~15]);
+    }
+    EXPECT_EQ(duties[BREATHING_TOP << 4], BACKLIGHT_DUTY_MAX);
+    EXPECT_EQ(duties[(BREATHING_TOP << 4) - 1], duties[(BREATHING_TOP - 1) << 4]);
+    // and starts over
+    uint16_t duty;
+    breathing_next(&b, &duty);
+    EXPECT_EQ(duty, 0);
+}
+
+TEST(Breathing, is_dimmed_by_the_intensity) {
+    breathing_t b = {BREATHING_TOP, 0, 3, BREATHING_NO_HALT};
+    uint16_t duty;
+    breathing_next(&b, &duty);
+    EXPECT_EQ(duty, BACKLIGHT_DUTY_MAX >> 3);
+}
+
+TEST(Breathing, halts_on_at_the_brightest_step) {
+    breathing_t b = {(BREATHING_TOP + 1) << 2, 2, 0, BREATHING_HALT_ON};
+    int stopped = -1;
+    auto duties = breathe(b, 1000, &stopped);
+    EXPECT_EQ(stopped, (BREATHING_STEPS - 1) * 4);
+    EXPECT_EQ(duties.back(), BACKLIGHT_DUTY_MAX);
+}
+
+TEST(Breathing, halts_off_at_the_last_step) {
+    breathing_t b = {0, 0, 0, BREATHING_HALT_OFF};
+    int stopped = -1;
+    auto duties = breathe(b, 1000, &stopped);
+    EXPECT_EQ(stopped, BREATHING_STEPS - 1);
+    EXPECT_EQ(duties.back(), 0);
+}
+
+TEST(Breathing, keeps_the_step_at_another_speed) {
+    for (uint16_t step = 0; step < BREATHING_STEPS; step++) {
+        uint16_t index = breathing_rescale((step << 4) + 5, 4, 2);
+        EXPECT_EQ(index, step << 2);
+    }
+}
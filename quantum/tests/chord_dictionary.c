@@ -0,0 +1,54 @@
+#include "process_chording.h"
+
+/* a few briefs, sorted by chord */
+CHORD_OUTPUT(and, "and ");
+CHORD_OUTPUT(that, "that ");
+CHORD_OUTPUT(to, "to ");
+CHORD_OUTPUT(undo, "\b");
+CHORD_OUTPUT(is, "is ");
+CHORD_OUTPUT(a, "a ");
+CHORD_OUTPUT(the, "the ");
+CHORD_OUTPUT(i, "I ");
+CHORD_OUTPUT(of, "of ");
+CHORD_OUTPUT(newline, "\n");
+CHORD_OUTPUT(in, "in ");
+CHORD_OUTPUT(hello, "Hello!");
+CHORD_OUTPUT(apple, "apple ");
+CHORD_OUTPUT(keyboard, "keyboard ");
+CHORD_OUTPUT(was, "was ");
+
+const chord_entry_t PROGMEM chord_dictionary[CHORD_COUNT] = {
+  { STN(SL) | STN(KL) | STN(PL) | STN(A), and },
+  { STN(TL) | STN(HL) | STN(A), that },
+  { STN(TL) | STN(O), to },
+  { STN(STAR), undo },
+  { STN(SL) | STN(STAR), is },
+  { STN(A) | STN(STAR), a },
+  { STN(TL) | STN(HL) | STN(E), the },
+  { STN(STAR) | STN(E) | STN(U), i },
+  { STN(O) | STN(FR), of },
+  { STN(RL) | STN(RR), newline },
+  { STN(STAR) | STN(PR) | STN(BR), in },
+  { STN(HL) | STN(E) | STN(LR), hello },
+  { STN(A) | STN(PR) | STN(LR), apple },
+  { STN(KL) | STN(E) | STN(BR) | STN(DR), keyboard },
+  { STN(WL) | STN(A) | STN(ZR), was },
+};
+
+/* the part of the quantum.c tables the briefs use */
+const bool ascii_to_qwerty_shift_lut[0x80] = {
+  ['!'] = 1, ['A' ... 'Z'] = 1
+};
+
+const uint8_t ascii_to_qwerty_keycode_lut[0x80] = {
+  ['\b'] = KC_BSPC, ['\n'] = KC_ENT, [' '] = KC_SPC, ['!'] = KC_1,
+  ['a'] = KC_A, ['A'] = KC_A, ['b'] = KC_B, ['B'] = KC_B, ['c'] = KC_C, ['C'] = KC_C,
+  ['d'] = KC_D, ['D'] = KC_D, ['e'] = KC_E, ['E'] = KC_E, ['f'] = KC_F, ['F'] = KC_F,
+  ['g'] = KC_G, ['G'] = KC_G, ['h'] = KC_H, ['H'] = KC_H, ['i'] = KC_I, ['I'] = KC_I,
+  ['j'] = KC_J, ['J'] = KC_J, ['k'] = KC_K, ['K'] = KC_K, ['l'] = KC_L, ['L'] = KC_L,
+  ['m'] = KC_M, ['M'] = KC_M, ['n'] = KC_N, ['N'] = KC_N, ['o'] = KC_O, ['O'] = KC_O,
+  ['p'] = KC_P, ['P'] = KC_P, ['q'] = KC_Q, ['Q'] = KC_Q, ['r'] = KC_R, ['R'] = KC_R,
+  ['s'] = KC_S, ['S'] = KC_S, ['t'] = KC_T, ['T'] = KC_T, ['u'] = KC_U, ['U'] = KC_U,
+  ['v'] = KC_V, ['V'] = KC_V, ['w'] = KC_W, ['W'] = KC_W, ['x'] = KC_X, ['X'] = KC_X,
+  ['y'] = KC_Y, ['Y'] = KC_Y, ['z'] = KC_Z, ['Z'] = KC_Z
+};
@@ -0,0 +1,66 @@
+#include "gtest/gtest.h"
+#include <stdlib.h>
+extern "C" {
+#include "color.h"
+}
+
+/* the conversion sethsv() used to do, with divisions */
+static RGB reference_hsv_to_rgb(uint16_t hue, uint8_t sat, uint8_t val) {
+    uint8_t r = 0, g = 0, b = 0, base, color;
+
+    if (sat == 0) {
+        r = val;
+        g = val;
+        b = val;
+    } else {
+        base = ((255 - sat) * val) >> 8;
+        color = (val - base) * (hue % 60) / 60;
+
+        switch (hue / 60) {
+            case 0: r = val; g = base + color; b = base; break;
+            case 1: r = val - color; g = val; b = base; break;
+            case 2: r = base; g = val; b = base + color; break;
+            case 3: r = base; g = val - color; b = val; break;
+            case 4: r = base + color; g = base; b = val; break;
+            case 5: r = val; g = base; b = val - color; break;
+        }
+    }
+    RGB rgb = {r, g, b};
+    return rgb;
+}
+
+TEST(Color, converts_primary_colors) {
+    RGB red = hsv_to_rgb(0, 255, 255);
+    RGB green = hsv_to_rgb(120, 255, 255);
+    RGB blue = hsv_to_rgb(240, 255, 255);
+    EXPECT_EQ(red.r, 255); EXPECT_EQ(red.g, 0); EXPECT_EQ(red.b, 0);
+    EXPECT_EQ(green.r, 0); EXPECT_EQ(green.g, 255); EXPECT_EQ(green.b, 0);
+    EXPECT_EQ(blue.r, 0); EXPECT_EQ(blue.g, 0); EXPECT_EQ(blue.b, 255);
+}
+
+TEST(Color, converts_gray_without_a_hue) {
+    RGB gray = hsv_to_rgb(200, 0, 100);
+    EXPECT_EQ(gray.r, 100); EXPECT_EQ(gray.g, 100); EXPECT_EQ(gray.b, 100);
+}
+
+TEST(Color, matches_the_division_based_conversion) {
+    int worst = 0;
+    for (int hue = 0; hue < 360; hue++) {
+        for (int sat = 0; sat < 256; sat++) {
+            for (int val = 0; val < 256; val++) {
+                RGB got = hsv_to_rgb(hue, sat, val);
+                RGB want = reference_hsv_to_rgb(hue, sat, val);
+                int diff = abs(got.r - want.r);
+                diff = std::max(diff, abs(got.g - want.g));
+                diff = std::max(diff, abs(got.b - want.b));
+                worst = std::max(worst, diff);
+                if (diff > 1) {
+                    FAIL() << "hsv " << hue << "," << sat << "," << val;
+                }
+            }
+        }
+    }
+    // the reciprocals are exact, so there is nothing for the LED curve
+    // to amplify either
+    EXPECT_EQ(worst, 0);
+}
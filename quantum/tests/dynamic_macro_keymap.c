@@ -0,0 +1,18 @@
+/* Stands in for a keymap.c using dynamic macros */
+#include <stddef.h>
+#include "action_layer.h"
+#include "debug.h"
+
+enum test_keycodes {
+    DYNAMIC_MACRO_RANGE = 0x5F00,
+};
+
+#include "dynamic_macro.h"
+
+void dynamic_macro_test_reset(void)
+{
+    macro_end = macro_buffer;
+    r_macro_end = r_macro_buffer;
+    dynamic_macro_player.playing = false;
+    dynamic_macro_saver.pending = false;
+}
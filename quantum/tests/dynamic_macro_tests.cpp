@@ -0,0 +1,347 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string>
+#include <vector>
+extern "C" {
+#include "action_layer.h"
+
+enum {
+    DYN_REC_START1 = 0x5F00,
+    DYN_REC_START2,
+    DYN_REC_STOP,
+    DYN_MACRO_PLAY1,
+    DYN_MACRO_PLAY2,
+};
+
+bool process_record_dynamic_macro(uint16_t keycode, keyrecord_t *record);
+void matrix_scan_dynamic_macro(void);
+bool dynamic_macro_is_playing(void);
+bool dynamic_macro_load(void);
+bool dynamic_macro_saving(void);
+void dynamic_macro_test_reset(void);
+}
+
+using testing::ElementsAre;
+
+uint32_t layer_state = 0;
+
+class DynamicMacro : public ::testing::Test {
+public:
+    DynamicMacro() {
+        Instance = this;
+        now = 1000;
+        layer_state = 0;
+        dynamic_macro_test_reset();
+        eeprom.assign(1024, 0xFF);
+    }
+
+    ~DynamicMacro() {
+        Instance = nullptr;
+    }
+
+    bool key(uint16_t keycode, bool pressed, uint8_t row = 0, uint8_t col = 0) {
+        keyrecord_t record = {};
+        record.event.key.row = row;
+        record.event.key.col = col;
+        record.event.pressed = pressed;
+        record.event.time = now;
+        bool ret = process_record_dynamic_macro(keycode, &record);
+        now += 1;
+        return ret;
+    }
+
+    void tap(uint16_t keycode, uint8_t row = 0, uint8_t col = 0) {
+        key(keycode, true, row, col);
+        key(keycode, false, row, col);
+    }
+
+    void tap_key(uint8_t row, uint8_t col, uint16_t hold = 0) {
+        key(0x04, true, row, col);
+        now += hold;
+        key(0x04, false, row, col);
+    }
+
+    void record(uint8_t slot, void (*keys)(DynamicMacro&)) {
+        tap(slot == 1 ? DYN_REC_START1 : DYN_REC_START2);
+        keys(*this);
+        key(DYN_REC_STOP, true);
+        key(DYN_REC_STOP, false);
+    }
+
+    /* run the main loop until the macro has been played back */
+    void play(uint8_t slot) {
+        played.clear();
+        tap(slot == 1 ? DYN_MACRO_PLAY1 : DYN_MACRO_PLAY2);
+        for (int i = 0; i < 100000 && dynamic_macro_is_playing(); i++) {
+            matrix_scan_dynamic_macro();
+            now += 1;
+        }
+    }
+
+    /* run the main loop until the macros are in the eeprom */
+    void save() {
+        for (int i = 0; i < 10000 && dynamic_macro_saving(); i++) {
+            matrix_scan_dynamic_macro();
+        }
+    }
+
+    void log(keyrecord_t* record) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%c%u,%u@%u",
+            record->event.pressed ? 'D' : 'U',
+            record->event.key.row, record->event.key.col,
+            (unsigned)(uint16_t)(now - play_start));
+        played.push_back(buf);
+    }
+
+    uint16_t now;
+    uint16_t play_start;
+    std::vector<std::string> played;
+    std::vector<uint8_t> eeprom;
+    unsigned eeprom_writes = 0;
+    unsigned keyboard_clears = 0;
+
+    static DynamicMacro* Instance;
+};
+
+DynamicMacro* DynamicMacro::Instance = nullptr;
+
+extern "C" {
+    uint16_t timer_read(void) {
+        return DynamicMacro::Instance->now;
+    }
+
+    void process_record(keyrecord_t *record) {
+        DynamicMacro::Instance->log(record);
+    }
+
+    void clear_keyboard(void) {
+        DynamicMacro::Instance->keyboard_clears++;
+    }
+
+    void layer_clear(void) {
+        layer_state = 0;
+    }
+
+    uint8_t eeprom_read_byte(const uint8_t *p) {
+        return DynamicMacro::Instance->eeprom.at((uintptr_t)p);
+    }
+
+    void eeprom_update_byte(uint8_t *p, uint8_t value) {
+        DynamicMacro::Instance->eeprom.at((uintptr_t)p) = value;
+        DynamicMacro::Instance->eeprom_writes++;
+    }
+}
+
+TEST_F(DynamicMacro, records_and_plays_back_keys) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 2);
+        t.tap_key(3, 4);
+    });
+    play_start = now + 1;
+    play(1);
+    ASSERT_EQ(played.size(), 4);
+    EXPECT_EQ(played[0].substr(0, 4), "D1,2");
+    EXPECT_EQ(played[1].substr(0, 4), "U1,2");
+    EXPECT_EQ(played[2].substr(0, 4), "D3,4");
+    EXPECT_EQ(played[3].substr(0, 4), "U3,4");
+}
+
+TEST_F(DynamicMacro, playback_does_not_block) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 2);
+    });
+    tap(DYN_MACRO_PLAY1);
+    EXPECT_TRUE(dynamic_macro_is_playing());
+    EXPECT_TRUE(played.empty());
+    matrix_scan_dynamic_macro();
+    EXPECT_EQ(played.size(), 1);
+    // the release was recorded 1ms after the press
+    matrix_scan_dynamic_macro();
+    EXPECT_EQ(played.size(), 1);
+    now += 1;
+    matrix_scan_dynamic_macro();
+    EXPECT_EQ(played.size(), 2);
+    matrix_scan_dynamic_macro();
+    EXPECT_FALSE(dynamic_macro_is_playing());
+}
+
+TEST_F(DynamicMacro, replays_the_recorded_timing) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(0, 1, 49);
+        t.now += 300;
+        t.tap_key(0, 2, 9);
+    });
+    play_start = now + 1;
+    play(1);
+    // the first event starts right away, one scan after the play key
+    EXPECT_THAT(played, ElementsAre("D0,1@1", "U0,1@51", "D0,2@352", "U0,2@362"));
+}
+
+TEST_F(DynamicMacro, restores_the_layer_state_after_playback) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(0, 1);
+    });
+    layer_state = 0x4;
+    play(1);
+    EXPECT_EQ(layer_state, 0x4);
+}
+
+TEST_F(DynamicMacro, ignores_leading_releases_and_trims_trailing_presses) {
+    record(1, [](DynamicMacro& t) {
+        t.key(0x04, false, 5, 5);
+        t.tap_key(0, 1);
+        t.key(0x04, true, 6, 6);
+        t.key(0x04, true, 7, 7);
+    });
+    play_start = now + 1;
+    play(1);
+    ASSERT_EQ(played.size(), 2);
+    EXPECT_EQ(played[0].substr(0, 4), "D0,1");
+    EXPECT_EQ(played[1].substr(0, 4), "U0,1");
+}
+
+TEST_F(DynamicMacro, keeps_the_two_macros_apart) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 1);
+    });
+    record(2, [](DynamicMacro& t) {
+        t.tap_key(2, 2, 200);
+        t.tap_key(3, 3);
+    });
+    play_start = now + 1;
+    play(1);
+    ASSERT_EQ(played.size(), 2);
+    EXPECT_EQ(played[0].substr(0, 4), "D1,1");
+    play_start = now + 1;
+    play(2);
+    ASSERT_EQ(played.size(), 4);
+    EXPECT_EQ(played[0].substr(0, 4), "D2,2");
+    EXPECT_EQ(played[1], "U2,2@202");
+    EXPECT_EQ(played[3].substr(0, 4), "U3,3");
+}
+
+TEST_F(DynamicMacro, stores_events_without_timing_in_two_bytes) {
+    // 64 bytes hold 32 events when they come within the same ms
+    record(1, [](DynamicMacro& t) {
+        for (int i = 0; i < 20; i++) {
+            t.key(0x04, true, 0, i);
+            t.now -= 1;
+            t.key(0x04, false, 0, i);
+            t.now -= 1;
+        }
+    });
+    play(1);
+    EXPECT_EQ(played.size(), 32);
+}
+
+TEST_F(DynamicMacro, does_not_overwrite_the_other_macro) {
+    record(2, [](DynamicMacro& t) {
+        t.tap_key(9, 9);
+    });
+    record(1, [](DynamicMacro& t) {
+        for (int i = 0; i < 40; i++) {
+            t.tap_key(1, i);
+        }
+    });
+    play(1);
+    EXPECT_LT(played.size(), 80);
+    EXPECT_GT(played.size(), 0);
+    play(2);
+    ASSERT_EQ(played.size(), 2);
+    EXPECT_EQ(played[0].substr(0, 4), "D9,9");
+}
+
+TEST_F(DynamicMacro, saves_to_and_loads_from_eeprom) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 2, 1000);
+    });
+    record(2, [](DynamicMacro& t) {
+        t.tap_key(3, 4);
+    });
+    save();
+    dynamic_macro_test_reset();
+    play(1);
+    EXPECT_TRUE(played.empty());
+    ASSERT_TRUE(dynamic_macro_load());
+    play_start = now + 1;
+    play(1);
+    EXPECT_THAT(played, ElementsAre("D1,2@1", "U1,2@1002"));
+    play(2);
+    ASSERT_EQ(played.size(), 2);
+    EXPECT_EQ(played[0].substr(0, 4), "D3,4");
+}
+
+TEST_F(DynamicMacro, rejects_a_corrupted_eeprom) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 2);
+    });
+    save();
+    eeprom[32 + 5] ^= 0x01;
+    EXPECT_FALSE(dynamic_macro_load());
+    play(1);
+    EXPECT_TRUE(played.empty());
+}
+
+TEST_F(DynamicMacro, rejects_an_empty_eeprom) {
+    EXPECT_FALSE(dynamic_macro_load());
+}
+
+TEST_F(DynamicMacro, saves_a_byte_per_scan_with_the_crc_last) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 2);
+        t.tap_key(3, 4);
+    });
+    EXPECT_EQ(eeprom_writes, 0);
+    ASSERT_TRUE(dynamic_macro_saving());
+
+    // the header, 11 bytes of events (2 for the first, 3 with a delay
+    // for the others), then the crc
+    unsigned scans = 0;
+    while (dynamic_macro_saving()) {
+        EXPECT_FALSE(dynamic_macro_load());
+        unsigned writes = eeprom_writes;
+        matrix_scan_dynamic_macro();
+        EXPECT_LE(eeprom_writes - writes, 1);
+        scans++;
+    }
+    EXPECT_EQ(scans, 5 + 11 + 1);
+    EXPECT_TRUE(dynamic_macro_load());
+}
+
+TEST_F(DynamicMacro, does_not_save_the_free_part_of_the_buffer) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 2);
+    });
+    record(2, [](DynamicMacro& t) {
+        t.tap_key(3, 4);
+    });
+    save();
+    // 5 bytes of each macro at both ends of the 64 byte buffer
+    for (int i = 32 + 5 + 5; i < 32 + 5 + 64 - 5; i++) {
+        ASSERT_EQ(eeprom[i], 0xFF) << i;
+    }
+    dynamic_macro_test_reset();
+    ASSERT_TRUE(dynamic_macro_load());
+    play(2);
+    ASSERT_EQ(played.size(), 2);
+    EXPECT_EQ(played[0].substr(0, 4), "D3,4");
+}
+
+TEST_F(DynamicMacro, starts_the_save_over_when_recording_again) {
+    record(1, [](DynamicMacro& t) {
+        t.tap_key(1, 2);
+    });
+    matrix_scan_dynamic_macro();
+    tap(DYN_REC_START1);
+    EXPECT_FALSE(dynamic_macro_saving());
+    tap_key(5, 6);
+    key(DYN_REC_STOP, true);
+    key(DYN_REC_STOP, false);
+    save();
+    dynamic_macro_test_reset();
+    ASSERT_TRUE(dynamic_macro_load());
+    play(1);
+    ASSERT_EQ(played.size(), 2);
+    EXPECT_EQ(played[0].substr(0, 4), "D5,6");
+}
@@ -0,0 +1,11 @@
+/* Stands in for the leader_dictionary of a keymap */
+#include "process_leader.h"
+
+const leader_seq_t PROGMEM leader_dictionary[LEADER_COUNT] = {
+    LEADER_SEQ(KC_CAPS, KC_C),
+    LEADER_ACTION(KC_F, KC_D),
+    LEADER_ACTION(KC_F, KC_D, KC_S),
+    LEADER_SEQ(KC_MUTE, KC_F, KC_M),
+    LEADER_ACTION(KC_G, KC_I, KC_T, KC_P, KC_U),
+    LEADER_ACTION(KC_G, KC_I, KC_T, KC_S),
+};
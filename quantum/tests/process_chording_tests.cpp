@@ -0,0 +1,206 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <initializer_list>
+#include <set>
+#include <string>
+#include <vector>
+extern "C" {
+#include "process_chording.h"
+}
+
+using testing::ElementsAre;
+
+class ProcessChording : public ::testing::Test {
+public:
+    ProcessChording() {
+        Instance = this;
+    }
+
+    ~ProcessChording() {
+        // don't leave anything for the next test
+        type();
+        Instance = nullptr;
+    }
+
+    bool key(uint8_t steno_key, bool pressed) {
+        keyrecord_t record = {};
+        record.event.pressed = pressed;
+        return process_chording(CH(steno_key), &record);
+    }
+
+    void stroke(std::initializer_list<uint8_t> keys) {
+        for (uint8_t k : keys) key(k, true);
+        for (uint8_t k : keys) key(k, false);
+    }
+
+    /* scan until all is typed, what a host would see */
+    std::string type() {
+        int scans = 0;
+        while (chording_busy() && scans++ < 1000) {
+            matrix_scan_chording();
+        }
+        std::string ret = typed;
+        typed.clear();
+        return ret;
+    }
+
+    void send() {
+        reports++;
+        for (uint8_t k : keys) {
+            if (!last_keys.count(k)) {
+                typed += to_char(k, mods & MOD_BIT(KC_LSFT));
+            }
+        }
+        last_keys = keys;
+    }
+
+    static char to_char(uint8_t k, bool shift) {
+        if (k >= KC_A && k <= KC_Z) return (shift ? 'A' : 'a') + k - KC_A;
+        if (k == KC_1 && shift) return '!';
+        if (k == KC_SPC) return ' ';
+        if (k == KC_ENT) return '\n';
+        if (k == KC_BSPC) return '\b';
+        return '?';
+    }
+
+    std::set<uint8_t> keys, last_keys;
+    uint8_t mods = 0;
+    int reports = 0;
+    std::string typed;
+    std::vector<chord_t> user_chords;
+    bool user_handles = false;
+
+    static ProcessChording* Instance;
+};
+
+ProcessChording* ProcessChording::Instance = nullptr;
+
+extern "C" {
+    void add_key(uint8_t key) {
+        ProcessChording::Instance->keys.insert(key);
+    }
+
+    void del_key(uint8_t key) {
+        ProcessChording::Instance->keys.erase(key);
+    }
+
+    void add_weak_mods(uint8_t mods) {
+        ProcessChording::Instance->mods |= mods;
+    }
+
+    void del_weak_mods(uint8_t mods) {
+        ProcessChording::Instance->mods &= ~mods;
+    }
+
+    void send_keyboard_report(void) {
+        ProcessChording::Instance->send();
+    }
+
+    bool process_chord_user(chord_t chord) {
+        ProcessChording::Instance->user_chords.push_back(chord);
+        return !ProcessChording::Instance->user_handles;
+    }
+}
+
+TEST_F(ProcessChording, the_dictionary_is_sorted) {
+    for (int i = 1; i < CHORD_COUNT; i++) {
+        EXPECT_LT(chord_dictionary[i - 1].chord, chord_dictionary[i].chord) << i;
+    }
+}
+
+TEST_F(ProcessChording, types_a_stroke) {
+    stroke({STN_TL, STN_HL, STN_E});
+    EXPECT_EQ(type(), "the ");
+}
+
+TEST_F(ProcessChording, finds_every_entry) {
+    for (int i = 0; i < CHORD_COUNT; i++) {
+        for (uint8_t k = 0; k < STN_KEYS; k++) {
+            if (chord_dictionary[i].chord & CHORD_BIT(k)) key(k, true);
+        }
+        for (uint8_t k = 0; k < STN_KEYS; k++) {
+            if (chord_dictionary[i].chord & CHORD_BIT(k)) key(k, false);
+        }
+        EXPECT_EQ(type(), chord_dictionary[i].output) << i;
+    }
+}
+
+TEST_F(ProcessChording, takes_all_keys_pressed_until_the_last_release) {
+    // rolled: T and H released before E is pressed
+    key(STN_TL, true);
+    key(STN_HL, true);
+    key(STN_TL, false);
+    key(STN_E, true);
+    key(STN_HL, false);
+    EXPECT_EQ(type(), "");
+    key(STN_E, false);
+    EXPECT_EQ(type(), "the ");
+}
+
+TEST_F(ProcessChording, swallows_chord_keys_only) {
+    EXPECT_FALSE(key(STN_A, true));
+    EXPECT_FALSE(key(STN_A, false));
+    keyrecord_t record = {};
+    record.event.pressed = true;
+    EXPECT_TRUE(process_chording(KC_A, &record));
+    type();
+}
+
+TEST_F(ProcessChording, types_nothing_for_an_unknown_chord) {
+    stroke({STN_SL, STN_TL, STN_KL, STN_PL});
+    EXPECT_EQ(type(), "");
+    EXPECT_EQ(reports, 0);
+}
+
+TEST_F(ProcessChording, passes_strokes_to_the_user_first) {
+    user_handles = true;
+    stroke({STN_TL, STN_HL, STN_E});
+    EXPECT_THAT(user_chords, ElementsAre(STN(TL) | STN(HL) | STN(E)));
+    EXPECT_EQ(type(), "");
+}
+
+TEST_F(ProcessChording, releases_each_character_with_the_next_press) {
+    stroke({STN_TL, STN_HL, STN_E});
+    EXPECT_EQ(type(), "the ");
+    // one report per character and one to release the last,
+    // send_string would take eight
+    EXPECT_EQ(reports, 5);
+    EXPECT_TRUE(keys.empty());
+}
+
+TEST_F(ProcessChording, releases_before_repeating_a_key) {
+    stroke({STN_A, STN_PR, STN_LR});
+    EXPECT_EQ(type(), "apple ");
+    EXPECT_EQ(reports, 8);
+}
+
+TEST_F(ProcessChording, releases_before_changing_shift) {
+    stroke({STN_HL, STN_E, STN_LR});
+    EXPECT_EQ(type(), "Hello!");
+    EXPECT_EQ(mods, 0);
+}
+
+TEST_F(ProcessChording, types_control_characters) {
+    stroke({STN_RL, STN_RR});
+    stroke({STN_STAR});
+    EXPECT_EQ(type(), "\n\b");
+}
+
+TEST_F(ProcessChording, queues_strokes_typed_before_the_output) {
+    stroke({STN_STAR, STN_E, STN_U});
+    stroke({STN_WL, STN_A, STN_ZR});
+    matrix_scan_chording();
+    stroke({STN_TL, STN_O});
+    EXPECT_EQ(type(), "I was to ");
+}
+
+TEST_F(ProcessChording, drops_strokes_when_the_queue_is_full) {
+    for (int i = 0; i < CHORD_QUEUE_SIZE + 2; i++) {
+        stroke({STN_O, STN_FR});
+    }
+    std::string expected;
+    for (int i = 0; i < CHORD_QUEUE_SIZE; i++) {
+        expected += "of ";
+    }
+    EXPECT_EQ(type(), expected);
+}
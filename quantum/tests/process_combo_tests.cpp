@@ -0,0 +1,222 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <chrono>
+#include <string>
+#include <vector>
+extern "C" {
+#include "process_combo.h"
+#include "deadline.h"
+}
+
+using testing::ElementsAre;
+
+extern "C" {
+combo_t key_combos[COMBO_COUNT];
+}
+
+static const uint16_t PROGMEM no_keys[] = {COMBO_END};
+static const uint16_t PROGMEM ab_combo[] = {KC_A, KC_B, COMBO_END};
+static const uint16_t PROGMEM bc_combo[] = {KC_B, KC_C, COMBO_END};
+static const uint16_t PROGMEM abc_combo[] = {KC_A, KC_B, KC_C, COMBO_END};
+
+class ProcessCombo : public ::testing::Test {
+public:
+    ProcessCombo() {
+        Instance = this;
+        now = 1000;
+        deadline_clear();
+        set_combos({});
+    }
+
+    ~ProcessCombo() {
+        Instance = nullptr;
+    }
+
+    /* the rest of key_combos use no keys, like a shorter COMBO_COUNT */
+    void set_combos(std::vector<combo_t> combos) {
+        for (int i = 0; i < COMBO_COUNT; i++) {
+            key_combos[i] = combo_t{};
+            key_combos[i].keys = no_keys;
+        }
+        for (size_t i = 0; i < combos.size(); i++) {
+            key_combos[i] = combos[i];
+        }
+        process_combo_init();
+    }
+
+    bool key(uint16_t keycode, bool pressed) {
+        keyrecord_t record = {};
+        record.event.pressed = pressed;
+        record.event.time = now;
+        bool ret = process_combo(keycode, &record);
+        now += 1;
+        deadline_task();
+        return ret;
+    }
+
+    void log(const char* what, unsigned code) {
+        if (quiet) {
+            return;
+        }
+        char buf[16];
+        snprintf(buf, sizeof(buf), "%s%02X", what, code);
+        events.push_back(buf);
+    }
+
+    uint16_t now;
+    bool quiet = false;
+    std::vector<std::string> events;
+
+    static ProcessCombo* Instance;
+};
+
+ProcessCombo* ProcessCombo::Instance = nullptr;
+
+static combo_t combo(const uint16_t* keys, uint16_t keycode = 0) {
+    combo_t c = {};
+    c.keys = keys;
+    c.keycode = keycode;
+    return c;
+}
+
+extern "C" {
+    uint16_t timer_read(void) {
+        return ProcessCombo::Instance->now;
+    }
+
+    uint32_t timer_read32(void) {
+        return ProcessCombo::Instance->now;
+    }
+
+    uint16_t timer_elapsed(uint16_t last) {
+        return TIMER_DIFF_16(ProcessCombo::Instance->now, last);
+    }
+
+    void register_code16(uint16_t code) {
+        ProcessCombo::Instance->log("D", code);
+    }
+
+    void unregister_code16(uint16_t code) {
+        ProcessCombo::Instance->log("U", code);
+    }
+
+    void send_keyboard_report(void) {
+    }
+
+    void process_combo_event(uint8_t combo_index, bool pressed) {
+        ProcessCombo::Instance->log(pressed ? "E+" : "E-", combo_index);
+    }
+}
+
+TEST_F(ProcessCombo, sends_the_combo_keycode) {
+    set_combos({combo(ab_combo, KC_ESC)});
+    EXPECT_FALSE(key(KC_A, true));
+    EXPECT_FALSE(key(KC_B, true));
+    key(KC_A, false);
+    key(KC_B, false);
+    EXPECT_THAT(events, ElementsAre("D29", "U29"));
+}
+
+TEST_F(ProcessCombo, passes_other_keys_through) {
+    set_combos({combo(ab_combo, KC_ESC)});
+    EXPECT_TRUE(key(KC_X, true));
+    EXPECT_TRUE(key(KC_X, false));
+    EXPECT_TRUE(events.empty());
+}
+
+TEST_F(ProcessCombo, taps_a_lone_combo_key_on_release) {
+    set_combos({combo(ab_combo, KC_ESC)});
+    key(KC_A, true);
+    key(KC_A, false);
+    EXPECT_THAT(events, ElementsAre("D04", "U04"));
+}
+
+TEST_F(ProcessCombo, presses_a_held_combo_key_after_the_combo_term) {
+    set_combos({combo(ab_combo, KC_ESC)});
+    key(KC_A, true);
+    now += COMBO_TERM - 1;
+    deadline_task();
+    EXPECT_TRUE(events.empty());
+    now += 1;
+    deadline_task();
+    EXPECT_THAT(events, ElementsAre("U04", "D04"));
+    EXPECT_FALSE(deadline_pending(matrix_scan_combo));
+    // the combo is disabled until all its keys are released
+    EXPECT_TRUE(key(KC_B, true));
+}
+
+TEST_F(ProcessCombo, reports_combo_actions_by_index) {
+    set_combos({combo(ab_combo, KC_ESC), combo(bc_combo), combo(abc_combo)});
+    key(KC_B, true);
+    key(KC_C, true);
+    EXPECT_THAT(events, ElementsAre("E+01"));
+}
+
+TEST_F(ProcessCombo, sends_every_combo_that_completes) {
+    set_combos({combo(ab_combo, KC_ESC), combo(bc_combo), combo(abc_combo)});
+    key(KC_A, true);
+    key(KC_B, true);
+    key(KC_C, true);
+    EXPECT_THAT(events, ElementsAre("D29", "E+01", "E+02"));
+}
+
+TEST_F(ProcessCombo, uses_combos_at_the_end_of_a_large_table) {
+    std::vector<combo_t> combos(COMBO_COUNT, combo(no_keys));
+    combos[COMBO_COUNT - 1] = combo(ab_combo, KC_ESC);
+    set_combos(combos);
+    key(KC_A, true);
+    key(KC_B, true);
+    EXPECT_THAT(events, ElementsAre("D29"));
+}
+
+TEST_F(ProcessCombo, works_when_the_combos_do_not_fit_the_index) {
+    // more different keycodes than COMBO_INDEX_KEYS
+    static uint16_t keys[COMBO_COUNT][3];
+    std::vector<combo_t> combos;
+    for (int i = 0; i < COMBO_COUNT; i++) {
+        keys[i][0] = 0x1000 + 2 * i;
+        keys[i][1] = 0x1001 + 2 * i;
+        keys[i][2] = COMBO_END;
+        combos.push_back(combo(keys[i], KC_ESC));
+    }
+    set_combos(combos);
+    key(0x1000 + 2 * 100, true);
+    key(0x1001 + 2 * 100, true);
+    EXPECT_THAT(events, ElementsAre("D29"));
+}
+
+/* Time per key event with growing numbers of two key combos, spread
+ * over a layout with more keys the more combos there are, like a steno
+ * layout. The rest of key_combos is empty.
+ */
+TEST_F(ProcessCombo, benchmark) {
+    static uint16_t keys[COMBO_COUNT][3];
+    const int events_per_run = 200000;
+
+    for (int count : {15, 60, 120, COMBO_COUNT}) {
+        int key_count = count / 5 < 8 ? 8 : count / 5;
+        std::vector<combo_t> combos;
+        for (int i = 0; i < count; i++) {
+            keys[i][0] = KC_A + i % key_count;
+            keys[i][1] = KC_A + (i / key_count + 1 + i) % key_count;
+            keys[i][2] = COMBO_END;
+            combos.push_back(combo(keys[i], KC_ESC));
+        }
+        set_combos(combos);
+        quiet = true;
+
+        uint32_t seed = 1;
+        auto start = std::chrono::steady_clock::now();
+        for (int i = 0; i < events_per_run / 2; i++) {
+            seed = seed * 1103515245 + 12345;
+            uint16_t k = KC_A + (seed >> 16) % key_count;
+            key(k, true);
+            key(k, false);
+        }
+        auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            std::chrono::steady_clock::now() - start).count();
+        printf("%3d combos, %2d keys: %6.1f ns per key event\n",
+            count, key_count, (double)ns / events_per_run);
+        quiet = false;
+    }
+}
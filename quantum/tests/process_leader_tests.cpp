@@ -0,0 +1,213 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <vector>
+extern "C" {
+#include "process_leader.h"
+#include "deadline.h"
+LEADER_EXTERNS();
+}
+
+using testing::ElementsAre;
+
+enum {
+    FD = 1,
+    FDS = 2,
+    GITPU = 4,
+    GITS = 5,
+};
+
+class ProcessLeader : public ::testing::Test {
+public:
+    ProcessLeader() {
+        Instance = this;
+        now = 1000;
+        deadline_clear();
+        leading = false;
+    }
+
+    ~ProcessLeader() {
+        Instance = nullptr;
+    }
+
+    bool press(uint16_t keycode) {
+        keyrecord_t record = {};
+        record.event.pressed = true;
+        record.event.time = now;
+        bool ret = process_leader(keycode, &record);
+        record.event.pressed = false;
+        process_leader(keycode, &record);
+        now += 10;
+        deadline_task();
+        return ret;
+    }
+
+    void type(std::vector<uint16_t> keys) {
+        for (uint16_t key : keys) {
+            press(key);
+        }
+    }
+
+    void wait(uint16_t ms) {
+        while (ms--) {
+            now++;
+            deadline_task();
+        }
+    }
+
+    uint16_t now;
+    unsigned ends = 0;
+    std::vector<uint16_t> taps;
+    std::vector<uint8_t> events;
+
+    static ProcessLeader* Instance;
+};
+
+ProcessLeader* ProcessLeader::Instance = nullptr;
+
+extern "C" {
+    uint16_t timer_read(void) {
+        return ProcessLeader::Instance->now;
+    }
+
+    uint32_t timer_read32(void) {
+        return ProcessLeader::Instance->now;
+    }
+
+    uint16_t timer_elapsed(uint16_t last) {
+        return TIMER_DIFF_16(ProcessLeader::Instance->now, last);
+    }
+
+    void register_code16(uint16_t code) {
+        ProcessLeader::Instance->taps.push_back(code);
+    }
+
+    void unregister_code16(uint16_t code) {
+    }
+
+    void leader_end(void) {
+        ProcessLeader::Instance->ends++;
+    }
+
+    void process_leader_event(uint8_t index) {
+        ProcessLeader::Instance->events.push_back(index);
+    }
+}
+
+TEST_F(ProcessLeader, passes_keys_through_when_not_leading) {
+    EXPECT_TRUE(press(KC_A));
+    EXPECT_FALSE(leading);
+}
+
+TEST_F(ProcessLeader, swallows_the_keys_of_a_sequence) {
+    EXPECT_FALSE(press(KC_LEAD));
+    EXPECT_FALSE(press(KC_G));
+    EXPECT_TRUE(leading);
+}
+
+TEST_F(ProcessLeader, fires_as_soon_as_the_sequence_is_unambiguous) {
+    type({KC_LEAD, KC_C});
+    EXPECT_THAT(taps, ElementsAre(KC_CAPS));
+    EXPECT_FALSE(leading);
+    EXPECT_EQ(ends, 1);
+}
+
+TEST_F(ProcessLeader, fires_long_sequences_before_the_timeout) {
+    type({KC_LEAD, KC_G, KC_I, KC_T, KC_P, KC_U});
+    EXPECT_THAT(events, ElementsAre(GITPU));
+    EXPECT_FALSE(leading);
+}
+
+TEST_F(ProcessLeader, picks_between_sequences_sharing_a_prefix) {
+    type({KC_LEAD, KC_G, KC_I, KC_T, KC_S});
+    type({KC_LEAD, KC_F, KC_M});
+    EXPECT_THAT(events, ElementsAre(GITS));
+    EXPECT_THAT(taps, ElementsAre(KC_MUTE));
+}
+
+TEST_F(ProcessLeader, waits_for_the_timeout_when_a_longer_sequence_exists) {
+    type({KC_LEAD, KC_F, KC_D});
+    EXPECT_TRUE(events.empty());
+    EXPECT_TRUE(leading);
+    wait(LEADER_TIMEOUT);
+    EXPECT_THAT(events, ElementsAre(FD));
+    EXPECT_FALSE(leading);
+    EXPECT_EQ(ends, 1);
+}
+
+TEST_F(ProcessLeader, the_longer_sequence_wins_when_typed_in_time) {
+    type({KC_LEAD, KC_F, KC_D, KC_S});
+    EXPECT_THAT(events, ElementsAre(FDS));
+    wait(LEADER_TIMEOUT);
+    EXPECT_THAT(events, ElementsAre(FDS));
+}
+
+TEST_F(ProcessLeader, aborts_on_a_dead_end) {
+    type({KC_LEAD, KC_G, KC_X});
+    EXPECT_FALSE(leading);
+    EXPECT_EQ(ends, 1);
+    EXPECT_TRUE(press(KC_Y));
+    wait(LEADER_TIMEOUT);
+    EXPECT_TRUE(events.empty());
+    EXPECT_TRUE(taps.empty());
+}
+
+TEST_F(ProcessLeader, aborts_on_an_unknown_first_key) {
+    type({KC_LEAD, KC_Z});
+    EXPECT_FALSE(leading);
+    EXPECT_EQ(leader_sequence_size, 1);
+    EXPECT_EQ(leader_sequence[0], KC_Z);
+}
+
+TEST_F(ProcessLeader, an_incomplete_sequence_times_out_without_firing) {
+    type({KC_LEAD, KC_G, KC_I});
+    wait(LEADER_TIMEOUT);
+    EXPECT_FALSE(leading);
+    EXPECT_TRUE(events.empty());
+    EXPECT_EQ(ends, 1);
+}
+
+TEST_F(ProcessLeader, times_out_exactly_after_leader_timeout) {
+    // each key takes 10ms
+    type({KC_LEAD, KC_F, KC_D});
+    wait(LEADER_TIMEOUT - 30);
+    EXPECT_TRUE(leading);
+    wait(1);
+    EXPECT_FALSE(leading);
+    EXPECT_THAT(events, ElementsAre(FD));
+}
+
+TEST_F(ProcessLeader, does_not_wait_for_a_deadline_after_firing) {
+    type({KC_LEAD, KC_C});
+    EXPECT_FALSE(deadline_pending(matrix_scan_leader));
+}
+
+TEST_F(ProcessLeader, leader_alone_times_out) {
+    type({KC_LEAD});
+    wait(LEADER_TIMEOUT);
+    EXPECT_FALSE(leading);
+    EXPECT_TRUE(events.empty());
+    EXPECT_TRUE(taps.empty());
+}
+
+TEST_F(ProcessLeader, keys_after_the_timeout_pass_through) {
+    press(KC_LEAD);
+    now += LEADER_TIMEOUT + 1;
+    EXPECT_TRUE(press(KC_A));
+    EXPECT_FALSE(leading);
+}
+
+TEST_F(ProcessLeader, never_overflows_the_sequence_buffer) {
+    type({KC_LEAD, KC_G, KC_I, KC_T, KC_P});
+    for (int i = 0; i < 10; i++) {
+        press(KC_U);
+    }
+    EXPECT_EQ(leader_sequence_size, LEADER_MAX_LENGTH);
+}
+
+TEST_F(ProcessLeader, keeps_the_legacy_sequence_buffer) {
+    type({KC_LEAD, KC_F, KC_D});
+    EXPECT_EQ(leader_sequence_size, 2);
+    EXPECT_EQ(leader_sequence[0], KC_F);
+    EXPECT_EQ(leader_sequence[1], KC_D);
+    EXPECT_EQ(leader_sequence[2], 0);
+}
@@ -0,0 +1,146 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <initializer_list>
+#include <vector>
+extern "C" {
+#include "process_chording.h"
+#include "process_steno.h"
+}
+
+using testing::ElementsAre;
+using testing::ElementsAreArray;
+
+typedef std::vector<uint8_t> packet_t;
+
+class ProcessSteno : public ::testing::Test {
+public:
+    ProcessSteno() {
+        Instance = this;
+        steno_set_mode(STENO_MODE_GEMINI);
+    }
+
+    ~ProcessSteno() {
+        Instance = nullptr;
+    }
+
+    void stroke(std::initializer_list<uint8_t> keys) {
+        keyrecord_t record = {};
+        record.event.pressed = true;
+        for (uint8_t k : keys) process_chording(CH(k), &record);
+        record.event.pressed = false;
+        for (uint8_t k : keys) process_chording(CH(k), &record);
+    }
+
+    static packet_t gemini(chord_t chord) {
+        uint8_t packet[GEMINI_PACKET_SIZE];
+        uint8_t length = steno_gemini_packet(chord, packet);
+        return packet_t(packet, packet + length);
+    }
+
+    static packet_t bolt(chord_t chord) {
+        uint8_t packet[BOLT_PACKET_SIZE];
+        uint8_t length = steno_bolt_packet(chord, packet);
+        return packet_t(packet, packet + length);
+    }
+
+    std::vector<packet_t> sent;
+    int reports = 0;
+
+    static ProcessSteno* Instance;
+};
+
+ProcessSteno* ProcessSteno::Instance = nullptr;
+
+extern "C" {
+    void virtser_send_packet(const uint8_t *data, uint8_t length) {
+        ProcessSteno::Instance->sent.push_back(packet_t(data, data + length));
+    }
+
+    void add_key(uint8_t key) {}
+    void del_key(uint8_t key) {}
+    void add_weak_mods(uint8_t mods) {}
+    void del_weak_mods(uint8_t mods) {}
+
+    void send_keyboard_report(void) {
+        ProcessSteno::Instance->reports++;
+    }
+}
+
+TEST_F(ProcessSteno, encodes_an_empty_gemini_packet) {
+    EXPECT_THAT(gemini(0), ElementsAre(0x80, 0, 0, 0, 0, 0));
+}
+
+TEST_F(ProcessSteno, encodes_gemini_packets) {
+    EXPECT_THAT(gemini(STN(TL) | STN(HL) | STN(E)), ElementsAre(0x80, 0x11, 0x00, 0x08, 0x00, 0x00));
+    EXPECT_THAT(gemini(STN(NUM) | STN(SL) | STN(ZR)), ElementsAre(0xA0, 0x40, 0x00, 0x00, 0x00, 0x01));
+    EXPECT_THAT(gemini(STN(A) | STN(O) | STN(STAR) | STN(U) | STN(FR)), ElementsAre(0x80, 0x00, 0x38, 0x06, 0x00, 0x00));
+    EXPECT_THAT(gemini(STN(PR) | STN(DR)), ElementsAre(0x80, 0x00, 0x00, 0x00, 0x41, 0x00));
+}
+
+TEST_F(ProcessSteno, gives_every_key_its_own_gemini_bit) {
+    chord_t all = 0;
+    std::vector<int> seen(GEMINI_PACKET_SIZE * 8);
+    for (int k = 0; k < STN_KEYS; k++) {
+        packet_t p = gemini(CHORD_BIT(k));
+        EXPECT_EQ(p[0] & 0x80, 0x80);
+        for (int i = 1; i < GEMINI_PACKET_SIZE; i++) {
+            EXPECT_EQ(p[i] & 0x80, 0) << k;
+        }
+        int bits = 0;
+        for (int i = 0; i < GEMINI_PACKET_SIZE; i++) {
+            for (int b = 0; b < 7; b++) {
+                if (p[i] & (1 << b)) {
+                    bits++;
+                    seen[i * 8 + b]++;
+                }
+            }
+        }
+        EXPECT_EQ(bits, 1) << k;
+        all |= CHORD_BIT(k);
+    }
+    for (int n : seen) {
+        EXPECT_LE(n, 1);
+    }
+    EXPECT_THAT(gemini(all), ElementsAre(0xA0, 0x5F, 0x78, 0x0F, 0x7F, 0x01));
+}
+
+TEST_F(ProcessSteno, encodes_bolt_packets) {
+    // the codes of the ergodox ez steno keymap
+    EXPECT_THAT(bolt(STN(TL) | STN(HL) | STN(E)), ElementsAre(0x22, 0x50, 0x00));
+    EXPECT_THAT(bolt(STN(SL)), ElementsAre(0x01, 0x00));
+    EXPECT_THAT(bolt(STN(RL) | STN(U)), ElementsAre(0x61, 0x00));
+    EXPECT_THAT(bolt(STN(FR) | STN(GR)), ElementsAre(0xA1, 0x00));
+    EXPECT_THAT(bolt(STN(TR) | STN(ZR) | STN(NUM)), ElementsAre(0xD9, 0x00));
+}
+
+TEST_F(ProcessSteno, encodes_all_bolt_keys) {
+    chord_t all = 0;
+    for (int k = 0; k < STN_KEYS; k++) all |= CHORD_BIT(k);
+    packet_t p = bolt(all);
+    EXPECT_THAT(p, ElementsAre(0x3F, 0x7F, 0xBF, 0xDF, 0x00));
+    EXPECT_EQ(p.size(), (size_t)BOLT_PACKET_SIZE);
+}
+
+TEST_F(ProcessSteno, sends_one_packet_per_stroke) {
+    stroke({STN_TL, STN_HL, STN_E});
+    stroke({STN_O, STN_FR});
+    ASSERT_EQ(sent.size(), 2u);
+    EXPECT_THAT(sent[0], ElementsAreArray(gemini(STN(TL) | STN(HL) | STN(E))));
+    EXPECT_THAT(sent[1], ElementsAreArray(gemini(STN(O) | STN(FR))));
+    EXPECT_FALSE(chording_busy());
+}
+
+TEST_F(ProcessSteno, sends_tx_bolt_in_bolt_mode) {
+    steno_set_mode(STENO_MODE_BOLT);
+    stroke({STN_TL, STN_HL, STN_E});
+    ASSERT_EQ(sent.size(), 1u);
+    EXPECT_THAT(sent[0], ElementsAre(0x22, 0x50, 0x00));
+}
+
+TEST_F(ProcessSteno, types_from_the_dictionary_in_dictionary_mode) {
+    steno_set_mode(STENO_MODE_DICTIONARY);
+    stroke({STN_TL, STN_HL, STN_E});
+    EXPECT_TRUE(sent.empty());
+    while (chording_busy()) matrix_scan_chording();
+    EXPECT_EQ(reports, 5);
+}
@@ -0,0 +1,181 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string.h>
+#include <vector>
+extern "C" {
+#include "progmem.h"
+#include "timer.h"
+#include "rgblight.h"
+#include "led_tables.h"
+}
+
+typedef std::vector<LED_TYPE> frame_t;
+
+static uint16_t now;
+static std::vector<frame_t> sent;
+
+extern "C" {
+    rgblight_config_t rgblight_config;
+    LED_TYPE led[RGBLED_NUM];
+
+    const uint8_t RGBLED_BREATHING_INTERVALS[] = {30, 20, 10, 5};
+    const uint8_t RGBLED_RAINBOW_MOOD_INTERVALS[] = {120, 60, 30};
+    const uint8_t RGBLED_RAINBOW_SWIRL_INTERVALS[] = {100, 50, 20};
+    const uint8_t RGBLED_SNAKE_INTERVALS[] = {100, 50, 20};
+    const uint8_t RGBLED_KNIGHT_INTERVALS[] = {100, 50, 20};
+
+    uint16_t timer_read(void) {
+        return now;
+    }
+
+    uint16_t timer_elapsed(uint16_t last) {
+        return TIMER_DIFF_16(now, last);
+    }
+
+    /* not a color, but easy to check: hue in r and the top bit of g,
+     * value in b, and off is black */
+    void sethsv(uint16_t hue, uint8_t sat, uint8_t val, LED_TYPE *led1) {
+        if (!val) {
+            memset(led1, 0, sizeof(*led1));
+            return;
+        }
+        led1->r = hue & 0xFF;
+        led1->g = (sat & 0xFE) | (hue >> 8);
+        led1->b = val;
+    }
+
+    void rgblight_set(void) {
+        rgblight_effects_invalidate();
+        sent.push_back(frame_t(led, led + RGBLED_NUM));
+    }
+}
+
+static uint16_t hue_of(const LED_TYPE& l) {
+    return l.r | ((l.g & 1) << 8);
+}
+
+class RgblightEffects : public ::testing::Test {
+public:
+    RgblightEffects() {
+        now = 1000;
+        sent.clear();
+        memset(led, 0, sizeof(led));
+        rgblight_config.raw = 0;
+        rgblight_config.enable = 1;
+        rgblight_config.mode = 1;
+        rgblight_config.hue = 100;
+        rgblight_config.sat = 254;
+        rgblight_config.val = 200;
+        rgblight_effects_init();
+    }
+
+    /* the main loop, once per ms */
+    void run(int ms) {
+        for (int i = 0; i < ms; i++) {
+            rgblight_effects_task();
+            now++;
+        }
+    }
+
+};
+
+TEST_F(RgblightEffects, does_nothing_in_static_mode) {
+    run(1000);
+    EXPECT_TRUE(sent.empty());
+}
+
+TEST_F(RgblightEffects, draws_the_first_frame_right_away) {
+    rgblight_config.mode = 6;
+    rgblight_effects_task();
+    ASSERT_EQ(sent.size(), 1u);
+    for (auto& l : sent[0]) {
+        EXPECT_EQ(hue_of(l), 0);
+        EXPECT_EQ(l.b, 200);
+    }
+}
+
+TEST_F(RgblightEffects, steps_at_the_frame_interval_of_the_mode) {
+    rgblight_config.mode = 7;  // rainbow mood, 60ms
+    run(60 * 5);
+    ASSERT_EQ(sent.size(), 5u);
+    for (int i = 0; i < 5; i++) {
+        EXPECT_EQ(hue_of(sent[i][0]), i);
+    }
+}
+
+TEST_F(RgblightEffects, picks_the_interval_by_variant) {
+    rgblight_config.mode = 17;  // snake, second speed
+    run(50 * 4);
+    EXPECT_EQ(sent.size(), 4u);
+}
+
+TEST_F(RgblightEffects, spreads_the_rainbow_swirl_over_the_leds) {
+    rgblight_config.mode = 9;
+    run(1);
+    run(99);
+    run(1);
+    ASSERT_EQ(sent.size(), 2u);
+    for (int i = 0; i < RGBLED_NUM; i++) {
+        EXPECT_EQ(hue_of(sent[0][i]), 360 / RGBLED_NUM * i);
+        EXPECT_EQ(hue_of(sent[1][i]), (359 + 360 / RGBLED_NUM * i) % 360);
+    }
+}
+
+TEST_F(RgblightEffects, draws_the_snake_fading_out) {
+    rgblight_config.mode = 15;
+    run(1);
+    ASSERT_EQ(sent.size(), 1u);
+    for (int i = 0; i < RGBLIGHT_EFFECT_SNAKE_LENGTH; i++) {
+        EXPECT_EQ(sent[0][i].b, 200 * (RGBLIGHT_EFFECT_SNAKE_LENGTH - i) / RGBLIGHT_EFFECT_SNAKE_LENGTH);
+    }
+    EXPECT_EQ(sent[0][RGBLED_NUM - 1].b, 0);
+}
+
+TEST_F(RgblightEffects, sends_only_frames_that_changed) {
+    rgblight_config.mode = 5;  // breathing, 5ms
+    run(5 * 256);
+    size_t changes = 1;
+    for (int i = 1; i < 256; i++) {
+        if (pgm_read_byte(&LED_BREATHING_TABLE[i]) != pgm_read_byte(&LED_BREATHING_TABLE[i - 1])) {
+            changes++;
+        }
+    }
+    EXPECT_EQ(sent.size(), changes);
+    EXPECT_LT(sent.size(), 256u);
+}
+
+TEST_F(RgblightEffects, sends_a_dark_snake_once) {
+    rgblight_config.mode = 19;
+    rgblight_config.val = 0;
+    run(1000);
+    EXPECT_EQ(sent.size(), 1u);
+}
+
+TEST_F(RgblightEffects, sends_the_frame_again_after_the_strip_changed) {
+    rgblight_config.mode = 19;
+    rgblight_config.val = 0;
+    run(20);
+    rgblight_effects_invalidate();
+    run(20);
+    EXPECT_EQ(sent.size(), 2u);
+}
+
+TEST_F(RgblightEffects, restarts_on_a_mode_change) {
+    rgblight_config.mode = 6;
+    run(120 * 3);
+    EXPECT_EQ(hue_of(sent.back()[0]), 2);
+    rgblight_config.mode = 24;
+    run(1);
+    rgblight_config.mode = 6;
+    run(1);
+    EXPECT_EQ(hue_of(sent.back()[0]), 0);
+}
+
+TEST_F(RgblightEffects, alternates_christmas_colors) {
+    rgblight_config.mode = 24;
+    run(RGBLIGHT_EFFECT_CHRISTMAS_INTERVAL + 1);
+    ASSERT_EQ(sent.size(), 2u);
+    EXPECT_EQ(hue_of(sent[0][0]), 120);
+    EXPECT_EQ(hue_of(sent[0][RGBLIGHT_EFFECT_CHRISTMAS_STEP]), 0);
+    EXPECT_EQ(hue_of(sent[1][0]), 0);
+}
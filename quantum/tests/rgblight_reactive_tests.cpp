@@ -0,0 +1,181 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string.h>
+#include <string>
+#include <vector>
+extern "C" {
+#include "progmem.h"
+#include "timer.h"
+#include "rgblight.h"
+}
+
+using testing::ElementsAre;
+
+static uint16_t now;
+static std::vector<std::string> sent;
+
+/* one char per LED from the blue channel, which the mock sethsv sets to
+ * the value: '.' off, '0' to '9' dim to full */
+static std::string render(const LED_TYPE* leds) {
+    std::string s;
+    for (int i = 0; i < RGBLED_NUM; i++) {
+        s += leds[i].b ? '0' + leds[i].b * 10 / 256 : '.';
+    }
+    return s;
+}
+
+extern "C" {
+    rgblight_config_t rgblight_config;
+    LED_TYPE led[RGBLED_NUM];
+
+    extern const uint8_t PROGMEM rgblight_reactive_map[MATRIX_ROWS][MATRIX_COLS] = {
+        {0, 1, 2, 3, 4, 5},
+        {6, 7, 8, 9, 10, RGBLIGHT_REACTIVE_NO_LED},
+    };
+
+    uint16_t timer_read(void) {
+        return now;
+    }
+
+    uint16_t timer_elapsed(uint16_t last) {
+        return TIMER_DIFF_16(now, last);
+    }
+
+    void sethsv(uint16_t hue, uint8_t sat, uint8_t val, LED_TYPE *led1) {
+        led1->r = hue & 0xFF;
+        led1->g = 0;
+        led1->b = val;
+    }
+
+    void rgblight_set(void) {
+        rgblight_effects_invalidate();
+        sent.push_back(render(led));
+    }
+}
+
+struct key_event_t {
+    uint16_t time;
+    uint8_t row;
+    uint8_t col;
+    bool pressed;
+};
+
+class RgblightReactive : public ::testing::Test {
+public:
+    RgblightReactive() {
+        now = 0;
+        sent.clear();
+        memset(led, 0, sizeof(led));
+        rgblight_config.raw = 0;
+        rgblight_config.enable = 1;
+        rgblight_config.mode = 1;
+        rgblight_config.hue = 100;
+        rgblight_config.val = 255;
+        rgblight_reactive_init();
+    }
+
+    /* plays the trace up to end, the task runs every
+     * RGBLIGHT_REACTIVE_INTERVAL ms like the main loop would run it */
+    void play(std::vector<key_event_t> trace, uint16_t end) {
+        size_t next = 0;
+        for (; now < end; now++) {
+            while (next < trace.size() && trace[next].time == now) {
+                rgblight_reactive_key(trace[next].row, trace[next].col, trace[next].pressed);
+                next++;
+            }
+            if (now % RGBLIGHT_REACTIVE_INTERVAL == 0) {
+                rgblight_reactive_task();
+            }
+        }
+    }
+};
+
+TEST_F(RgblightReactive, sends_nothing_without_keys) {
+    play({}, 1000);
+    EXPECT_TRUE(sent.empty());
+}
+
+TEST_F(RgblightReactive, lights_the_pressed_key_and_splashes) {
+    play({{0, 0, 3, true}}, 1);
+    EXPECT_THAT(sent, ElementsAre("...9........"));
+    play({}, 100);
+    // a frame each time the splash moves, the held key doesn't change
+    EXPECT_THAT(sent, ElementsAre(
+        "...9........",
+        "..494.......",
+        ".24942......"));
+}
+
+TEST_F(RgblightReactive, fades_out_after_the_release) {
+    play({{0, 1, 3, true}, {96, 1, 3, false}}, 97);
+    EXPECT_EQ(sent.back(), ".......24942");
+    play({}, 96 + RGBLIGHT_REACTIVE_FADE / 2 + 1);
+    EXPECT_EQ(sent.back(), ".......12521");
+    play({}, 2000);
+    EXPECT_EQ(sent.back(), "............");
+    size_t count = sent.size();
+    play({}, 3000);
+    EXPECT_EQ(sent.size(), count);
+}
+
+TEST_F(RgblightReactive, keeps_the_frame_of_the_mode) {
+    for (auto& l : led) {
+        l.b = 26;
+    }
+    play({{0, 0, 0, true}, {50, 0, 0, false}}, 100);
+    EXPECT_EQ(sent.back(), "953111111111");
+    EXPECT_EQ(render(led), "111111111111");
+    play({}, 1000);
+    EXPECT_EQ(sent.back(), "111111111111");
+}
+
+TEST_F(RgblightReactive, adds_up_neighbouring_keys) {
+    rgblight_config.val = 200;
+    play({{0, 0, 4, true}, {0, 0, 5, true}}, 1);
+    EXPECT_EQ(sent.back(), "....77......");
+    play({}, 100);
+    EXPECT_EQ(sent.back(), "..159951....");
+}
+
+TEST_F(RgblightReactive, ignores_keys_without_an_led) {
+    play({{0, 1, 5, true}, {10, 1, 5, false}}, 100);
+    EXPECT_TRUE(sent.empty());
+}
+
+TEST_F(RgblightReactive, draws_nothing_when_disabled) {
+    rgblight_config.enable = 0;
+    play({{0, 0, 0, true}}, 100);
+    for (auto& frame : sent) {
+        EXPECT_EQ(frame, "............");
+    }
+}
+
+TEST_F(RgblightReactive, replaces_the_dimmest_released_key) {
+    // LEDs 0, 3, 6 and 9 pressed and released in turn, 0 is the dimmest
+    std::vector<key_event_t> trace;
+    for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_KEYS; i++) {
+        trace.push_back({uint16_t(i * 16), uint8_t(i * 3 / 6), uint8_t(i * 3 % 6), true});
+        trace.push_back({uint16_t(i * 16 + 5), uint8_t(i * 3 / 6), uint8_t(i * 3 % 6), false});
+    }
+    play(trace, 64);
+    EXPECT_NE(sent.back()[0], '.');
+    rgblight_reactive_led(11, true);
+    play({}, 65);
+    EXPECT_EQ(sent.back()[0], '.');
+    EXPECT_EQ(sent.back()[11], '9');
+}
+
+TEST_F(RgblightReactive, does_not_replace_held_keys) {
+    std::vector<key_event_t> trace;
+    for (uint8_t i = 0; i < RGBLIGHT_REACTIVE_KEYS; i++) {
+        trace.push_back({0, uint8_t(i / 6), uint8_t(i % 6), true});
+    }
+    trace.push_back({0, 1, 4, true});
+    play(trace, 1);
+    EXPECT_EQ(sent.back(), std::string(RGBLIGHT_REACTIVE_KEYS, '9') + std::string(RGBLED_NUM - RGBLIGHT_REACTIVE_KEYS, '.'));
+}
+
+TEST_F(RgblightReactive, restarts_a_key_pressed_again) {
+    play({{0, 0, 0, true}, {10, 0, 0, false}, {304, 0, 0, true}}, 305);
+    EXPECT_EQ(sent.back()[0], '9');
+}
@@ -0,0 +1,161 @@
+QUANTUM_TEST_INC := $(QUANTUM_PATH) $(TMK_PATH)/common
+QUANTUM_TEST_DEFS := -DNO_PRINT -DNO_DEBUG
+
+quantum_dynamic_macro_SRC :=\
+	$(QUANTUM_PATH)/tests/dynamic_macro_tests.cpp \
+	$(QUANTUM_PATH)/tests/dynamic_macro_keymap.c
+quantum_dynamic_macro_INC := $(QUANTUM_TEST_INC)
+quantum_dynamic_macro_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DDYNAMIC_MACRO_TIMING \
+	-DDYNAMIC_MACRO_EEPROM \
+	-DDYNAMIC_MACRO_BYTES=64
+
+quantum_process_leader_SRC :=\
+	$(QUANTUM_PATH)/tests/process_leader_tests.cpp \
+	$(QUANTUM_PATH)/tests/leader_dictionary.c \
+	$(QUANTUM_PATH)/process_keycode/process_leader.c \
+	$(TMK_PATH)/common/deadline.c
+quantum_process_leader_INC := $(QUANTUM_TEST_INC) \
+	$(QUANTUM_PATH)/process_keycode \
+	$(QUANTUM_PATH)/keymap_extras
+quantum_process_leader_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DMATRIX_ROWS=4 \
+	-DMATRIX_COLS=4 \
+	-DLEADER_COUNT=6
+
+QUANTUM_COMBO_TEST_SRC :=\
+	$(QUANTUM_PATH)/tests/process_combo_tests.cpp \
+	$(QUANTUM_PATH)/process_keycode/process_combo.c \
+	$(TMK_PATH)/common/deadline.c
+QUANTUM_COMBO_TEST_INC := $(QUANTUM_TEST_INC) \
+	$(QUANTUM_PATH)/process_keycode \
+	$(QUANTUM_PATH)/keymap_extras
+QUANTUM_COMBO_TEST_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DMATRIX_ROWS=4 \
+	-DMATRIX_COLS=4 \
+	-DCOMBO_COUNT=240 \
+	-DCOMBO_TERM=50
+
+quantum_process_combo_SRC := $(QUANTUM_COMBO_TEST_SRC)
+quantum_process_combo_INC := $(QUANTUM_COMBO_TEST_INC)
+quantum_process_combo_DEFS := $(QUANTUM_COMBO_TEST_DEFS)
+
+# The same tests and benchmark without the index, every combo sees every key
+quantum_process_combo_linear_SRC := $(QUANTUM_COMBO_TEST_SRC)
+quantum_process_combo_linear_INC := $(QUANTUM_COMBO_TEST_INC)
+quantum_process_combo_linear_DEFS := $(QUANTUM_COMBO_TEST_DEFS) \
+	-DCOMBO_INDEX_SIZE=0
+
+quantum_process_chording_SRC :=\
+	$(QUANTUM_PATH)/tests/process_chording_tests.cpp \
+	$(QUANTUM_PATH)/tests/chord_dictionary.c \
+	$(QUANTUM_PATH)/process_keycode/process_chording.c
+quantum_process_chording_INC := $(QUANTUM_TEST_INC) \
+	$(QUANTUM_PATH)/process_keycode \
+	$(QUANTUM_PATH)/keymap_extras
+quantum_process_chording_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DMATRIX_ROWS=4 \
+	-DMATRIX_COLS=4 \
+	-DCHORDING_ENABLE \
+	-DCHORD_COUNT=15
+
+quantum_process_steno_SRC :=\
+	$(QUANTUM_PATH)/tests/process_steno_tests.cpp \
+	$(QUANTUM_PATH)/tests/chord_dictionary.c \
+	$(QUANTUM_PATH)/process_keycode/process_steno.c \
+	$(QUANTUM_PATH)/process_keycode/process_chording.c
+quantum_process_steno_INC := $(quantum_process_chording_INC)
+quantum_process_steno_DEFS := $(quantum_process_chording_DEFS) \
+	-DSTENO_ENABLE
+
+quantum_color_SRC :=\
+	$(QUANTUM_PATH)/tests/color_tests.cpp \
+	$(QUANTUM_PATH)/color.c
+quantum_color_INC := $(QUANTUM_TEST_INC)
+quantum_color_DEFS := $(QUANTUM_TEST_DEFS)
+
+quantum_rgblight_effects_SRC :=\
+	$(QUANTUM_PATH)/tests/rgblight_effects_tests.cpp \
+	$(QUANTUM_PATH)/rgblight_effects.c \
+	$(QUANTUM_PATH)/led_tables.c
+quantum_rgblight_effects_INC := $(QUANTUM_TEST_INC)
+quantum_rgblight_effects_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DRGBLED_NUM=8 \
+	-DRGBLIGHT_ANIMATIONS \
+	-DUSE_LED_BREATHING_TABLE
+
+quantum_ws2812_encode_SRC :=\
+	$(QUANTUM_PATH)/tests/ws2812_encode_tests.cpp \
+	$(QUANTUM_PATH)/ws2812_encode.c
+quantum_ws2812_encode_INC := $(QUANTUM_TEST_INC)
+quantum_ws2812_encode_DEFS := $(QUANTUM_TEST_DEFS)
+
+quantum_rgblight_reactive_SRC :=\
+	$(QUANTUM_PATH)/tests/rgblight_reactive_tests.cpp \
+	$(QUANTUM_PATH)/rgblight_reactive.c \
+	$(QUANTUM_PATH)/rgblight_effects.c
+quantum_rgblight_reactive_INC := $(QUANTUM_TEST_INC)
+quantum_rgblight_reactive_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DRGBLED_NUM=12 \
+	-DMATRIX_ROWS=2 \
+	-DMATRIX_COLS=6 \
+	-DRGBLIGHT_REACTIVE \
+	-DRGBLIGHT_REACTIVE_KEYS=4
+
+quantum_backlight_pwm_SRC :=\
+	$(QUANTUM_PATH)/tests/backlight_pwm_tests.cpp \
+	$(QUANTUM_PATH)/backlight_pwm.c \
+	$(QUANTUM_PATH)/led_tables.c
+quantum_backlight_pwm_INC := $(QUANTUM_TEST_INC)
+quantum_backlight_pwm_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DUSE_CIE1931_CURVE
+
+quantum_audio_synth_SRC :=\
+	$(QUANTUM_PATH)/tests/audio_synth_tests.cpp \
+	$(QUANTUM_PATH)/audio/synth.c
+quantum_audio_synth_INC := $(QUANTUM_TEST_INC) $(QUANTUM_PATH)/audio
+quantum_audio_synth_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DF_CPU=16000000
+
+quantum_audio_mixer_SRC :=\
+	$(QUANTUM_PATH)/tests/audio_mixer_tests.cpp \
+	$(QUANTUM_PATH)/audio/mixer.c \
+	$(QUANTUM_PATH)/audio/synth.c
+quantum_audio_mixer_INC := $(QUANTUM_TEST_INC) $(QUANTUM_PATH)/audio
+quantum_audio_mixer_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DF_CPU=16000000 \
+	-DMIXER_RENDER
+
+quantum_audio_song_SRC :=\
+	$(QUANTUM_PATH)/tests/audio_song_tests.cpp \
+	$(QUANTUM_PATH)/audio/song.c \
+	$(QUANTUM_PATH)/audio/synth.c
+quantum_audio_song_INC := $(QUANTUM_TEST_INC) $(QUANTUM_PATH)/audio
+quantum_audio_song_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DF_CPU=16000000
+
+quantum_audio_render_SRC :=\
+	$(QUANTUM_PATH)/tests/audio_render_tests.cpp \
+	$(QUANTUM_PATH)/audio/audio.c \
+	$(QUANTUM_PATH)/audio/audio_host.c \
+	$(QUANTUM_PATH)/audio/voices.c \
+	$(QUANTUM_PATH)/audio/synth.c \
+	$(QUANTUM_PATH)/audio/mixer.c \
+	$(QUANTUM_PATH)/audio/song.c \
+	$(QUANTUM_PATH)/audio/sample.c \
+	$(QUANTUM_PATH)/audio/adpcm.c
+quantum_audio_render_INC := $(QUANTUM_TEST_INC) $(QUANTUM_PATH)/audio
+quantum_audio_render_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DF_CPU=16000000 \
+	-DMATRIX_ROWS=4 \
+	-DMATRIX_COLS=4 \
+	-DAUDIO_ENABLE \
+	-DAUDIO_HOST
+
+quantum_audio_sample_SRC :=\
+	$(QUANTUM_PATH)/tests/audio_sample_tests.cpp \
+	$(QUANTUM_PATH)/audio/sample.c \
+	$(QUANTUM_PATH)/audio/adpcm.c
+quantum_audio_sample_INC := $(QUANTUM_TEST_INC) $(QUANTUM_PATH)/audio
+quantum_audio_sample_DEFS := $(QUANTUM_TEST_DEFS) \
+	-DF_CPU=16000000
@@ -0,0 +1,17 @@
+TEST_LIST +=\
+	quantum_dynamic_macro \
+	quantum_process_leader \
+	quantum_process_combo \
+	quantum_process_combo_linear \
+	quantum_process_chording \
+	quantum_process_steno \
+	quantum_color \
+	quantum_rgblight_effects \
+	quantum_ws2812_encode \
+	quantum_rgblight_reactive \
+	quantum_backlight_pwm \
+	quantum_audio_synth \
+	quantum_audio_mixer \
+	quantum_audio_song \
+	quantum_audio_render \
+	quantum_audio_sample
@@ -0,0 +1,176 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <vector>
+extern "C" {
+#include "ws2812_encode.h"
+}
+
+using testing::ElementsAre;
+
+/* SPI bits as the line level over time, one entry per SPI bit */
+static std::vector<bool> waveform(const std::vector<uint8_t>& spi) {
+    std::vector<bool> line;
+    for (uint8_t b : spi) {
+        for (int i = 7; i >= 0; i--) {
+            line.push_back(b & (1 << i));
+        }
+    }
+    return line;
+}
+
+/* what a WS2812 reads: every rising edge starts a bit, it is a 1 when
+ * the pulse is longer than 625ns */
+static std::vector<uint8_t> decode(const std::vector<bool>& line, std::vector<int>* highs = nullptr) {
+    const int ns = 1000000000 / WS2812_SPI_CLOCK;
+    std::vector<uint8_t> bytes;
+    uint8_t byte = 0;
+    int bits = 0;
+    for (size_t i = 0; i < line.size(); i++) {
+        if (!line[i] || (i > 0 && line[i - 1])) continue;
+        size_t j = i;
+        while (j < line.size() && line[j]) j++;
+        int high = (j - i) * ns;
+        if (highs) highs->push_back(high);
+        byte = (byte << 1) | (high > 625);
+        if (++bits == 8) {
+            bytes.push_back(byte);
+            byte = 0;
+            bits = 0;
+        }
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t> encode(const std::vector<uint8_t>& data) {
+    std::vector<uint8_t> out(data.size() * WS2812_SPI_BYTES);
+    uint16_t length = ws2812_encode(data.data(), data.size(), out.data());
+    out.resize(length);
+    return out;
+}
+
+TEST(Ws2812Encode, encodes_a_byte_msb_first) {
+    uint8_t out[WS2812_SPI_BYTES];
+    ws2812_encode_byte(0xA5, out);
+    // 10 10 01 01
+    EXPECT_THAT(out, ElementsAre(0xE8, 0xE8, 0x8E, 0x8E));
+    ws2812_encode_byte(0x00, out);
+    EXPECT_THAT(out, ElementsAre(0x88, 0x88, 0x88, 0x88));
+    ws2812_encode_byte(0xFF, out);
+    EXPECT_THAT(out, ElementsAre(0xEE, 0xEE, 0xEE, 0xEE));
+}
+
+TEST(Ws2812Encode, uses_four_spi_bytes_per_byte) {
+    EXPECT_EQ(encode({1, 2, 3}).size(), 3u * WS2812_SPI_BYTES);
+    EXPECT_TRUE(encode({}).empty());
+}
+
+TEST(Ws2812Encode, round_trips_every_byte) {
+    std::vector<uint8_t> data;
+    for (int i = 0; i < 256; i++) data.push_back(i);
+    EXPECT_EQ(decode(waveform(encode(data))), data);
+}
+
+TEST(Ws2812Encode, keeps_the_pulses_within_ws2812_timing) {
+    std::vector<int> highs;
+    std::vector<bool> line = waveform(encode({0x0F, 0xF0, 0x55}));
+    decode(line, &highs);
+    ASSERT_EQ(highs.size(), 24u);
+    for (int high : highs) {
+        // T0H 200-500ns, T1H 550-850ns
+        EXPECT_TRUE((high >= 200 && high <= 500) || (high >= 550 && high <= 850)) << high;
+    }
+    // one WS2812 bit per 1.0us, within 1.25us +-600ns
+    EXPECT_EQ(line.size() * (1000000000 / WS2812_SPI_CLOCK), 24u * 1000);
+}
+
+TEST(Ws2812Encode, ends_every_spi_byte_low) {
+    // so gaps between SPI bytes can't be taken for a pulse
+    for (uint8_t b : encode({0x00, 0xFF, 0x5A, 0xC3})) {
+        EXPECT_EQ(b & 1, 0);
+    }
+}
+
+TEST(Ws2812Encode, encodes_a_strip_in_order) {
+    // g, r, b like struct cRGB
+    std::vector<uint8_t> strip = {0x10, 0x20, 0x30, 0xFF, 0x00, 0x80};
+    EXPECT_EQ(decode(waveform(encode(strip))), strip);
+}
+
+/* bit by bit */
+static void reference_transpose(const uint8_t in[8], uint8_t out[8]) {
+    for (int i = 0; i < 8; i++) {
+        out[i] = 0;
+        for (int n = 0; n < 8; n++) {
+            if (in[n] & (0x80 >> i)) out[i] |= 1 << n;
+        }
+    }
+}
+
+TEST(Ws2812Transpose, transposes_single_bits) {
+    uint8_t in[8] = {0x80, 0, 0, 0, 0, 0, 0, 0x01};
+    uint8_t out[8];
+    ws2812_transpose(in, out);
+    // strip 0 sends a 1 first, strip 7 last
+    EXPECT_THAT(out, ElementsAre(0x01, 0, 0, 0, 0, 0, 0, 0x80));
+}
+
+TEST(Ws2812Transpose, matches_the_bitwise_transpose) {
+    uint32_t seed = 1;
+    for (int run = 0; run < 10000; run++) {
+        uint8_t in[8], out[8], want[8];
+        for (auto& b : in) {
+            seed = seed * 1103515245 + 12345;
+            b = seed >> 16;
+        }
+        ws2812_transpose(in, out);
+        reference_transpose(in, want);
+        ASSERT_THAT(out, testing::ElementsAreArray(want)) << run;
+    }
+}
+
+TEST(Ws2812Transpose, drives_each_strip_with_its_own_bytes) {
+    const uint8_t a[] = {0xFF, 0x00, 0xA5};
+    const uint8_t b[] = {0x0F, 0xC3, 0x3C, 0x81, 0x7E, 0x99};
+    ws2812_strip_t strips[] = {{a, sizeof(a), 2}, {b, sizeof(b), 5}};
+
+    // what the strip on each pin sees over the whole frame
+    std::vector<uint8_t> seen[8];
+    for (uint16_t index = 0; index < sizeof(b); index++) {
+        uint8_t slices[8];
+        uint8_t active = ws2812_parallel_slices(strips, 2, index, slices);
+        EXPECT_EQ(active, index < sizeof(a) ? 0x24 : 0x20);
+        for (int pin = 0; pin < 8; pin++) {
+            if (!(active & (1 << pin))) continue;
+            uint8_t byte = 0;
+            for (int i = 0; i < 8; i++) {
+                byte = (byte << 1) | ((slices[i] >> pin) & 1);
+            }
+            seen[pin].push_back(byte);
+        }
+    }
+    EXPECT_THAT(seen[2], ElementsAre(0xFF, 0x00, 0xA5));
+    EXPECT_THAT(seen[5], ElementsAre(0x0F, 0xC3, 0x3C, 0x81, 0x7E, 0x99));
+    for (int pin : {0, 1, 3, 4, 6, 7}) {
+        EXPECT_TRUE(seen[pin].empty());
+    }
+}
+
+TEST(Ws2812Transpose, transposes_the_frame_into_records) {
+    const uint8_t a[] = {0xFF, 0x00, 0xA5};
+    const uint8_t b[] = {0x0F, 0xC3, 0x3C, 0x81, 0x7E, 0x99};
+    ws2812_strip_t strips[] = {{a, sizeof(a), 2}, {b, sizeof(b), 5}};
+
+    uint8_t frame[8 * WS2812_PARALLEL_RECORD];
+    ASSERT_EQ(ws2812_parallel_frame(strips, 2, frame, 8), sizeof(b));
+    for (uint16_t index = 0; index < sizeof(b); index++) {
+        uint8_t slices[8];
+        uint8_t active = ws2812_parallel_slices(strips, 2, index, slices);
+        const uint8_t *record = &frame[index * WS2812_PARALLEL_RECORD];
+        EXPECT_EQ(record[0], active);
+        EXPECT_THAT(std::vector<uint8_t>(record + 1, record + WS2812_PARALLEL_RECORD), testing::ElementsAreArray(slices));
+    }
+
+    // longer strips are cut at max_bytes
+    EXPECT_EQ(ws2812_parallel_frame(strips, 2, frame, 4), 4);
+    EXPECT_EQ(ws2812_parallel_frame(strips, 0, frame, 8), 0);
+}
@@ -0,0 +1,72 @@
+#include "ws2812_encode.h"
+
+/* two data bits per SPI byte */
+static const uint8_t bit_pairs[4] = {
+  (WS2812_SPI_ZERO << 4) | WS2812_SPI_ZERO,
+  (WS2812_SPI_ZERO << 4) | WS2812_SPI_ONE,
+  (WS2812_SPI_ONE << 4) | WS2812_SPI_ZERO,
+  (WS2812_SPI_ONE << 4) | WS2812_SPI_ONE,
+};
+
+void ws2812_encode_byte(uint8_t byte, uint8_t *out) {
+  out[0] = bit_pairs[byte >> 6];
+  out[1] = bit_pairs[(byte >> 4) & 3];
+  out[2] = bit_pairs[(byte >> 2) & 3];
+  out[3] = bit_pairs[byte & 3];
+}
+
+uint16_t ws2812_encode(const uint8_t *data, uint16_t length, uint8_t *out) {
+  for (uint16_t i = 0; i < length; i++) {
+    ws2812_encode_byte(data[i], out);
+    out += WS2812_SPI_BYTES;
+  }
+  return length * WS2812_SPI_BYTES;
+}
+
+/* the 8x8 bit matrix transpose from Hacker's Delight, with in[] taken
+ * in reverse so bit n of a slice is strip n */
+void ws2812_transpose(const uint8_t in[8], uint8_t out[8]) {
+  uint32_t x = ((uint32_t)in[7] << 24) | ((uint32_t)in[6] << 16) | ((uint32_t)in[5] << 8) | in[4];
+  uint32_t y = ((uint32_t)in[3] << 24) | ((uint32_t)in[2] << 16) | ((uint32_t)in[1] << 8) | in[0];
+  uint32_t t;
+
+  t = (x ^ (x >> 7)) & 0x00AA00AA;  x = x ^ t ^ (t << 7);
+  t = (y ^ (y >> 7)) & 0x00AA00AA;  y = y ^ t ^ (t << 7);
+  t = (x ^ (x >> 14)) & 0x0000CCCC; x = x ^ t ^ (t << 14);
+  t = (y ^ (y >> 14)) & 0x0000CCCC; y = y ^ t ^ (t << 14);
+  t = (x & 0xF0F0F0F0) | ((y >> 4) & 0x0F0F0F0F);
+  y = ((x << 4) & 0xF0F0F0F0) | (y & 0x0F0F0F0F);
+  x = t;
+
+  out[0] = x >> 24; out[1] = x >> 16; out[2] = x >> 8; out[3] = x;
+  out[4] = y >> 24; out[5] = y >> 16; out[6] = y >> 8; out[7] = y;
+}
+
+uint8_t ws2812_parallel_slices(const ws2812_strip_t *strips, uint8_t count, uint16_t index, uint8_t slices[8]) {
+  uint8_t bytes[8] = { 0 };
+  uint8_t active = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    if (index < strips[i].length) {
+      bytes[strips[i].pin] = strips[i].data[index];
+      active |= 1 << strips[i].pin;
+    }
+  }
+  ws2812_transpose(bytes, slices);
+  return active;
+}
+
+uint16_t ws2812_parallel_frame(const ws2812_strip_t *strips, uint8_t count, uint8_t *frame, uint16_t max_bytes) {
+  uint16_t longest = 0;
+
+  for (uint8_t i = 0; i < count; i++) {
+    if (strips[i].length > longest) longest = strips[i].length;
+  }
+  if (longest > max_bytes) longest = max_bytes;
+
+  for (uint16_t index = 0; index < longest; index++) {
+    frame[0] = ws2812_parallel_slices(strips, count, index, frame + 1);
+    frame += WS2812_PARALLEL_RECORD;
+  }
+  return longest;
+}
@@ -0,0 +1,51 @@
+#ifndef WS2812_ENCODE_H
+#define WS2812_ENCODE_H
+
+#include <stdint.h>
+
+/* WS2812 bits as SPI bits, for sending the strip from the SPI peripheral
+ * instead of bit-banging it with interrupts off. At 4MHz an SPI bit is
+ * 250ns, and a WS2812 bit is four of them:
+ *
+ *   0: 1000  250ns high, 750ns low
+ *   1: 1110  750ns high, 250ns low
+ *
+ * Every pattern ends low, so gaps between SPI bytes only stretch a low
+ * phase, which the LEDs tolerate up to their reset time.
+ */
+#define WS2812_SPI_CLOCK 4000000
+#define WS2812_SPI_BITS  4
+#define WS2812_SPI_ZERO  0x8
+#define WS2812_SPI_ONE   0xE
+/* SPI bytes per data byte */
+#define WS2812_SPI_BYTES (WS2812_SPI_BITS)
+
+/* out gets WS2812_SPI_BYTES bytes, MSB first like the LEDs */
+void ws2812_encode_byte(uint8_t byte, uint8_t *out);
+/* length data bytes, returns the number of bytes written to out */
+uint16_t ws2812_encode(const uint8_t *data, uint16_t length, uint8_t *out);
+
+
+/* Strips on pins of the same port, sent at the same time: every
+ * WS2812 bit is one write of the whole port, a "slice" with bit n for
+ * the strip on pin n.
+ */
+typedef struct {
+  const uint8_t *data;  // g, r, b bytes like LED_TYPE
+  uint16_t length;      // in bytes
+  uint8_t pin;          // bit on the port, 0-7
+} ws2812_strip_t;
+
+/* out[i] has bit n set when bit 7 - i of in[n] is set */
+void ws2812_transpose(const uint8_t in[8], uint8_t out[8]);
+/* the 8 slices for byte index of the strips, returns the pins of the
+ * strips that are still sending at index */
+uint8_t ws2812_parallel_slices(const ws2812_strip_t *strips, uint8_t count, uint16_t index, uint8_t slices[8]);
+
+/* bytes of a frame record: the pins still sending, then the 8 slices */
+#define WS2812_PARALLEL_RECORD 9
+/* records for the first max_bytes byte indexes of the strips, so the
+ * sender only loads bytes, returns the number of records */
+uint16_t ws2812_parallel_frame(const ws2812_strip_t *strips, uint8_t count, uint8_t *frame, uint16_t max_bytes);
+
+#endif
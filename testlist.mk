@@ -1,4 +1,9 @@
 include $(ROOT_DIR)/quantum/serial_link/tests/testlist.mk
+include $(ROOT_DIR)/tmk_core/common/tests/testlist.mk
+include $(ROOT_DIR)/tmk_core/protocol/vusb/tests/testlist.mk
+include $(ROOT_DIR)/tmk_core/protocol/midi/tests/testlist.mk
+include $(ROOT_DIR)/quantum/tests/testlist.mk
+include $(ROOT_DIR)/keyboards/ergodox/infinity/drivers/gdisp/IS31FL3731C/tests/testlist.mk
 
 define VALIDATE_TEST_LIST
     ifneq ($1,)
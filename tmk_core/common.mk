@@ -16,6 +16,8 @@ TMK_COMMON_SRC +=	$(COMMON_DIR)/host.c \
 	$(COMMON_DIR)/debug.c \
 	$(COMMON_DIR)/util.c \
 	$(COMMON_DIR)/eeconfig.c \
+	$(COMMON_DIR)/deadline.c \
+	$(COMMON_DIR)/scheduler.c \
 	$(PLATFORM_COMMON_DIR)/suspend.c \
 	$(PLATFORM_COMMON_DIR)/timer.c \
 	$(PLATFORM_COMMON_DIR)/bootloader.c \
@@ -66,6 +68,11 @@ ifeq ($(strip $(COMMAND_ENABLE)), yes)
     TMK_COMMON_DEFS += -DCOMMAND_ENABLE
 endif
 
+ifeq ($(strip $(PERF_COUNTER_ENABLE)), yes)
+    TMK_COMMON_SRC += $(COMMON_DIR)/perf_counter.c
+    TMK_COMMON_DEFS += -DPERF_COUNTER_ENABLE
+endif
+
 ifeq ($(strip $(NKRO_ENABLE)), yes)
     TMK_COMMON_DEFS += -DNKRO_ENABLE
 endif
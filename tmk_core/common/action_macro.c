@@ -14,9 +14,11 @@ GNU General Public License for more details.
 You should have received a copy of the GNU General Public License
 along with this program.  If not, see <http://www.gnu.org/licenses/>.
 */
+#include <stddef.h>
 #include "action.h"
 #include "action_util.h"
 #include "action_macro.h"
+#include "timer.h"
 #include "wait.h"
 
 #ifdef DEBUG_ACTION
@@ -28,14 +30,41 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 
 #ifndef NO_ACTION_MACRO
 
-#define MACRO_READ()  (macro = MACRO_GET(macro_p++))
-void action_macro_play(const macro_t *macro_p)
+/*
+ * Macros are played from the main loop instead of blocking in wait_ms().
+ * Each player keeps its program counter and the deadline of its next step,
+ * deadlines advance by the WAIT/INTERVAL time so steps don't drift.
+ * Macros started while all players are busy are queued and start in order
+ * when a player ends.
+ */
+typedef struct {
+    const macro_t *pc;
+    uint16_t deadline;
+    uint8_t interval;
+    uint8_t seq;
+} macro_player_t;
+
+static macro_player_t players[ACTION_MACRO_PLAYERS];
+static uint8_t player_seq = 0;
+
+/* macros waiting for a free player, oldest first */
+static const macro_t *queue[ACTION_MACRO_QUEUE];
+static uint8_t queue_head = 0;
+static uint8_t queue_count = 0;
+
+static bool macro_due(uint16_t deadline)
+{
+    return (int16_t)(timer_read() - deadline) >= 0;
+}
+
+/* run steps until the player has to wait, returns false once it has ended */
+#define MACRO_READ()  (macro = MACRO_GET(p->pc++))
+static bool macro_run(macro_player_t *p)
 {
     macro_t macro = END;
-    uint8_t interval = 0;
 
-    if (!macro_p) return;
-    while (true) {
+    while (macro_due(p->deadline)) {
+        uint8_t delay = 0;
         switch (MACRO_READ()) {
             case KEY_DOWN:
                 MACRO_READ();
@@ -60,11 +89,11 @@ void action_macro_play(const macro_t *macro_p)
             case WAIT:
                 MACRO_READ();
                 dprintf("WAIT(%u)\n", macro);
-                { uint8_t ms = macro; while (ms--) wait_ms(1); }
+                delay = macro;
                 break;
             case INTERVAL:
-                interval = MACRO_READ();
-                dprintf("INTERVAL(%u)\n", interval);
+                p->interval = MACRO_READ();
+                dprintf("INTERVAL(%u)\n", p->interval);
                 break;
             case 0x04 ... 0x73:
                 dprintf("DOWN(%02X)\n", macro);
@@ -76,10 +105,91 @@ void action_macro_play(const macro_t *macro_p)
                 break;
             case END:
             default:
-                return;
+                p->pc = NULL;
+                return false;
         }
         // interval
-        { uint8_t ms = interval; while (ms--) wait_ms(1); }
+        uint16_t wait = delay + p->interval;
+        if (wait) {
+            p->deadline += wait;
+            // fell behind by more than a whole step, don't squeeze steps
+            // together to catch up
+            if ((int16_t)(timer_read() - p->deadline) > 0) {
+                p->deadline = timer_read() + wait;
+            }
+        }
+    }
+    return true;
+}
+
+static void macro_finish(macro_player_t *p)
+{
+    while (macro_run(p)) {
+        wait_ms(1);
+    }
+}
+
+static void macro_start(macro_player_t *p, const macro_t *macro_p)
+{
+    p->pc = macro_p;
+    p->deadline = timer_read();
+    p->interval = 0;
+    p->seq = player_seq++;
+    // steps up to the first wait run right away
+    macro_run(p);
+}
+
+/* hands queued macros to an idle player until one of them has to wait */
+static void macro_next(macro_player_t *p)
+{
+    while (!p->pc && queue_count) {
+        const macro_t *macro_p = queue[queue_head];
+        queue_head = (queue_head + 1) % ACTION_MACRO_QUEUE;
+        queue_count--;
+        macro_start(p, macro_p);
+    }
+}
+
+void action_macro_play(const macro_t *macro_p)
+{
+    if (!macro_p) return;
+
+    if (queue_count == ACTION_MACRO_QUEUE) {
+        // queue full, so every player is busy: play the oldest one out to
+        // make room, the order macros were started in is kept
+        macro_player_t *p = &players[0];
+        for (uint8_t i = 1; i < ACTION_MACRO_PLAYERS; i++) {
+            if ((uint8_t)(player_seq - players[i].seq) > (uint8_t)(player_seq - p->seq)) {
+                p = &players[i];
+            }
+        }
+        dprint("macro: queue full\n");
+        macro_finish(p);
+        macro_next(p);
+    }
+
+    queue[(queue_head + queue_count) % ACTION_MACRO_QUEUE] = macro_p;
+    queue_count++;
+    for (uint8_t i = 0; i < ACTION_MACRO_PLAYERS; i++) {
+        macro_next(&players[i]);
+    }
+}
+
+void action_macro_task(void)
+{
+    for (uint8_t i = 0; i < ACTION_MACRO_PLAYERS; i++) {
+        if (players[i].pc) {
+            macro_run(&players[i]);
+        }
+        macro_next(&players[i]);
+    }
+}
+
+bool action_macro_is_playing(void)
+{
+    for (uint8_t i = 0; i < ACTION_MACRO_PLAYERS; i++) {
+        if (players[i].pc) return true;
     }
+    return queue_count > 0;
 }
 #endif
@@ -17,6 +17,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #ifndef ACTION_MACRO_H
 #define ACTION_MACRO_H
 #include <stdint.h>
+#include <stdbool.h>
 #include "progmem.h"
 
 
@@ -49,10 +50,36 @@ typedef uint8_t macro_t;
      
 
 
+/*
+ * Number of macros that can be playing at the same time. Macros started
+ * while every player is busy wait in a FIFO of ACTION_MACRO_QUEUE entries
+ * and start once a player has ended, so by default they play one after
+ * another.
+ *
+ * Setting ACTION_MACRO_PLAYERS above 1 lets macros play concurrently, but
+ * they share the keyboard report: a D(LSFT) in one macro also shifts the
+ * taps of the other, and a U(LSFT) releases the shift the other one holds.
+ * Only do that when the macros that overlap don't touch modifiers.
+ */
+#ifndef ACTION_MACRO_PLAYERS
+#define ACTION_MACRO_PLAYERS 1
+#endif
+#ifndef ACTION_MACRO_QUEUE
+#define ACTION_MACRO_QUEUE 4
+#endif
+#if ACTION_MACRO_PLAYERS < 1 || ACTION_MACRO_QUEUE < 1
+#error "ACTION_MACRO_PLAYERS and ACTION_MACRO_QUEUE must be at least 1"
+#endif
+
 #ifndef NO_ACTION_MACRO
+/* starts or queues a macro, steps after a WAIT or INTERVAL are run from action_macro_task */
 void action_macro_play(const macro_t *macro_p);
+void action_macro_task(void);
+bool action_macro_is_playing(void);
 #else
 #define action_macro_play(macro)
+#define action_macro_task()
+#define action_macro_is_playing() false
 #endif
 
 
@@ -40,6 +40,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "mousekey.h"
 #endif
 
+#ifdef PERF_COUNTER_ENABLE
+#include "perf_counter.h"
+#include "scheduler.h"
+#endif
+
 #ifdef PROTOCOL_PJRC
 	#include "usb_keyboard.h"
 		#ifdef EXTRAKEY_ENABLE
@@ -170,6 +175,10 @@ static void command_common_help(void)
 #ifdef SLEEP_LED_ENABLE
 		STR(MAGIC_KEY_SLEEP_LED   ) ":	Sleep LED Test\n"
 #endif
+
+#ifdef PERF_COUNTER_ENABLE
+		STR(MAGIC_KEY_PERF        ) ":	Print Performance Counters and Task Stats\n"
+#endif
     );
 }
 
@@ -322,6 +331,17 @@ static bool command_common(uint8_t code)
             break;
 #endif
 
+#ifdef PERF_COUNTER_ENABLE
+
+		// print scan rate and latency counters
+        case MAGIC_KC(MAGIC_KEY_PERF):
+            perf_counters_print();
+            perf_counters_clear();
+            scheduler_print_stats();
+            scheduler_clear_stats();
+            break;
+#endif
+
 #ifdef BOOTMAGIC_ENABLE
 
 		// print stored eeprom config
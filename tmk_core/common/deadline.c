@@ -0,0 +1,120 @@
+#include "deadline.h"
+#include "timer.h"
+#include "debug.h"
+
+typedef struct {
+    uint32_t time;
+    deadline_fn_t fn;
+} deadline_t;
+
+static deadline_t heap[DEADLINE_SLOTS];
+static uint8_t heap_size = 0;
+
+/* works across timer_read32() wraparound */
+#define DEADLINE_BEFORE(a, b) ((int32_t)((a) - (b)) < 0)
+
+static void swap(uint8_t i, uint8_t j)
+{
+    deadline_t t = heap[i];
+    heap[i] = heap[j];
+    heap[j] = t;
+}
+
+static void sift_up(uint8_t i)
+{
+    while (i > 0) {
+        uint8_t parent = (i - 1) / 2;
+        if (!DEADLINE_BEFORE(heap[i].time, heap[parent].time)) break;
+        swap(i, parent);
+        i = parent;
+    }
+}
+
+static void sift_down(uint8_t i)
+{
+    for (;;) {
+        uint8_t first = i;
+        uint8_t left = 2 * i + 1;
+        uint8_t right = left + 1;
+        if (left < heap_size && DEADLINE_BEFORE(heap[left].time, heap[first].time)) first = left;
+        if (right < heap_size && DEADLINE_BEFORE(heap[right].time, heap[first].time)) first = right;
+        if (first == i) break;
+        swap(i, first);
+        i = first;
+    }
+}
+
+static void remove_at(uint8_t i)
+{
+    heap_size--;
+    if (i == heap_size) return;
+    heap[i] = heap[heap_size];
+    sift_down(i);
+    sift_up(i);
+}
+
+/* there are only a few entries, one per feature */
+static int8_t find(deadline_fn_t fn)
+{
+    for (uint8_t i = 0; i < heap_size; i++) {
+        if (heap[i].fn == fn) return i;
+    }
+    return -1;
+}
+
+bool deadline_set(deadline_fn_t fn, uint32_t time)
+{
+    int8_t i = find(fn);
+    if (i < 0) {
+        if (heap_size == DEADLINE_SLOTS) {
+            dprintf("deadline: no free slot, see DEADLINE_SLOTS\n");
+            return false;
+        }
+        i = heap_size++;
+    }
+    heap[i].fn = fn;
+    heap[i].time = time;
+    sift_down(i);
+    sift_up(i);
+    return true;
+}
+
+bool deadline_in(deadline_fn_t fn, uint32_t ms)
+{
+    return deadline_set(fn, timer_read32() + ms);
+}
+
+void deadline_cancel(deadline_fn_t fn)
+{
+    int8_t i = find(fn);
+    if (i >= 0) remove_at(i);
+}
+
+bool deadline_pending(deadline_fn_t fn)
+{
+    return find(fn) >= 0;
+}
+
+void deadline_clear(void)
+{
+    heap_size = 0;
+}
+
+void deadline_task(void)
+{
+    if (heap_size == 0) return;
+
+    uint32_t now = timer_read32();
+    deadline_fn_t due[DEADLINE_SLOTS];
+    uint8_t count = 0;
+
+    /* take them all out first, a function scheduling itself for now
+     * runs again on the next call instead of looping here */
+    while (heap_size && !DEADLINE_BEFORE(now, heap[0].time)) {
+        due[count++] = heap[0].fn;
+        remove_at(0);
+    }
+    for (uint8_t i = 0; i < count; i++) {
+        due[i]();
+    }
+}
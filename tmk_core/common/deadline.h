@@ -0,0 +1,39 @@
+#ifndef DEADLINE_H
+#define DEADLINE_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Features waiting for a timeout register a function and the
+ * timer_read32() time it should run at, instead of checking their own
+ * timer on every scan. deadline_task() only looks at the earliest entry
+ * unless it is due, entries are kept in a min-heap.
+ */
+#ifndef DEADLINE_SLOTS
+#define DEADLINE_SLOTS 8
+#endif
+
+typedef void (*deadline_fn_t)(void);
+
+/* schedule fn at time, replacing an earlier time for the same fn.
+ * false if all DEADLINE_SLOTS are taken */
+bool deadline_set(deadline_fn_t fn, uint32_t time);
+/* same, ms from now */
+bool deadline_in(deadline_fn_t fn, uint32_t ms);
+void deadline_cancel(deadline_fn_t fn);
+bool deadline_pending(deadline_fn_t fn);
+void deadline_clear(void);
+
+/* runs the functions that are due, they may schedule themselves again */
+void deadline_task(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -21,15 +21,32 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "host.h"
 #include "util.h"
 #include "debug.h"
+#include "perf_counter.h"
 
 static host_driver_t *driver;
 static uint16_t last_system_report = 0;
 static uint16_t last_consumer_report = 0;
 
+/* Mouse motion not yet handed to the driver. Deltas from several calls to
+ * host_mouse_send() are summed here while the endpoint is busy, so nothing
+ * is lost when the host polls slower than the reports are generated. */
+typedef struct {
+    int16_t x;
+    int16_t y;
+    int16_t v;
+    int16_t h;
+    uint8_t buttons;
+} mouse_pending_t;
+
+static mouse_pending_t mouse_pending = {};
+static uint8_t last_mouse_buttons = 0;
+
 
 void host_set_driver(host_driver_t *d)
 {
     driver = d;
+    mouse_pending = (mouse_pending_t){};
+    last_mouse_buttons = 0;
 }
 
 host_driver_t *host_get_driver(void)
@@ -47,6 +64,7 @@ void host_keyboard_send(report_keyboard_t *report)
 {
     if (!driver) return;
     (*driver->send_keyboard)(report);
+    perf_report_sent();
 
     if (debug_keyboard) {
         dprint("keyboard_report: ");
@@ -57,10 +75,74 @@ void host_keyboard_send(report_keyboard_t *report)
     }
 }
 
+static int16_t mouse_accum(int16_t acc, int8_t delta)
+{
+    acc += delta;
+    if (acc > MOUSE_REPORT_ACCUM_MAX) return MOUSE_REPORT_ACCUM_MAX;
+    if (acc < -MOUSE_REPORT_ACCUM_MAX) return -MOUSE_REPORT_ACCUM_MAX;
+    return acc;
+}
+
+/* take at most one report's worth (+-127) out of the accumulator */
+static int8_t mouse_take(int16_t *acc)
+{
+    int8_t d;
+    if (*acc > 127) d = 127;
+    else if (*acc < -127) d = -127;
+    else d = *acc;
+    *acc -= d;
+    return d;
+}
+
+static void mouse_send_pending(void)
+{
+    /* static: some drivers transmit the buffer asynchronously */
+    static report_mouse_t report;
+    report = (report_mouse_t){
+        .buttons = mouse_pending.buttons,
+        .x = mouse_take(&mouse_pending.x),
+        .y = mouse_take(&mouse_pending.y),
+        .v = mouse_take(&mouse_pending.v),
+        .h = mouse_take(&mouse_pending.h),
+    };
+    last_mouse_buttons = report.buttons;
+    (*driver->send_mouse)(&report);
+}
+
 void host_mouse_send(report_mouse_t *report)
 {
     if (!driver) return;
-    (*driver->send_mouse)(report);
+
+    /* A second button change can't be merged into one still waiting for
+     * the endpoint without losing a click, so push the first one out. */
+    if (mouse_pending.buttons != last_mouse_buttons &&
+        mouse_pending.buttons != report->buttons) {
+        mouse_send_pending();
+    }
+
+    mouse_pending.x = mouse_accum(mouse_pending.x, report->x);
+    mouse_pending.y = mouse_accum(mouse_pending.y, report->y);
+    mouse_pending.v = mouse_accum(mouse_pending.v, report->v);
+    mouse_pending.h = mouse_accum(mouse_pending.h, report->h);
+    mouse_pending.buttons = report->buttons;
+    host_mouse_flush();
+}
+
+bool host_mouse_pending(void)
+{
+    return mouse_pending.x || mouse_pending.y || mouse_pending.v || mouse_pending.h ||
+           mouse_pending.buttons != last_mouse_buttons;
+}
+
+void host_mouse_flush(void)
+{
+    if (!driver) return;
+    /* nothing moved and buttons unchanged: an all-zero report is redundant */
+    if (!host_mouse_pending()) return;
+    /* endpoint still busy with the previous report, keep accumulating */
+    if (driver->mouse_ready && !(*driver->mouse_ready)()) return;
+
+    mouse_send_pending();
 }
 
 void host_system_send(uint16_t report)
@@ -28,6 +28,11 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 extern "C" {
 #endif
 
+/* Largest motion, per axis, held back while the mouse endpoint is busy */
+#ifndef MOUSE_REPORT_ACCUM_MAX
+#define MOUSE_REPORT_ACCUM_MAX 1024
+#endif
+
 extern uint8_t keyboard_idle;
 extern uint8_t keyboard_protocol;
 
@@ -40,6 +45,8 @@ host_driver_t *host_get_driver(void);
 uint8_t host_keyboard_leds(void);
 void host_keyboard_send(report_keyboard_t *report);
 void host_mouse_send(report_mouse_t *report);
+void host_mouse_flush(void);
+bool host_mouse_pending(void);
 void host_system_send(uint16_t data);
 void host_consumer_send(uint16_t data);
 
@@ -35,6 +35,8 @@ typedef struct {
     void (*usb_get_midi)(MidiDevice *);
     void (*midi_usb_init)(MidiDevice *);
 #endif
+    /* optional: returns non-zero when the mouse endpoint can take a report */
+    uint8_t (*mouse_ready)(void);
 } host_driver_t;
 
 #endif
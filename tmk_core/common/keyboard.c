@@ -31,6 +31,8 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "eeconfig.h"
 #include "backlight.h"
 #include "action_layer.h"
+#include "perf_counter.h"
+#include "deadline.h"
 #ifdef BOOTMAGIC_ENABLE
 #   include "bootmagic.h"
 #else
@@ -147,21 +149,17 @@ void keyboard_init(void) {
 #endif
 }
 
-/*
- * Do keyboard routine jobs: scan mantrix, light LEDs, ...
- * This is repeatedly called as fast as possible.
- */
-void keyboard_task(void)
+static matrix_row_t matrix_prev[MATRIX_ROWS];
+
+/* process at most one matrix change, or a TICK when nothing changed */
+static void keyboard_process_matrix(void)
 {
-    static matrix_row_t matrix_prev[MATRIX_ROWS];
 #ifdef MATRIX_HAS_GHOST
   //  static matrix_row_t matrix_ghost[MATRIX_ROWS];
 #endif
-    static uint8_t led_status = 0;
     matrix_row_t matrix_row = 0;
     matrix_row_t matrix_change = 0;
 
-    matrix_scan();
     for (uint8_t r = 0; r < MATRIX_ROWS; r++) {
         matrix_row = matrix_get_row(r);
         matrix_change = matrix_row ^ matrix_prev[r];
@@ -183,6 +181,7 @@ void keyboard_task(void)
             if (debug_matrix) matrix_print();
             for (uint8_t c = 0; c < MATRIX_COLS; c++) {
                 if (matrix_change & ((matrix_row_t)1<<c)) {
+                    perf_key_event();
                     action_exec((keyevent_t){
                         .key = (keypos_t){ .row = r, .col = c },
                         .pressed = (matrix_row & ((matrix_row_t)1<<c)),
@@ -191,15 +190,21 @@ void keyboard_task(void)
                     // record a processed key
                     matrix_prev[r] ^= ((matrix_row_t)1<<c);
                     // process a key per task call
-                    goto MATRIX_LOOP_END;
+                    return;
                 }
             }
         }
     }
     // call with pseudo tick event when no real key event.
     action_exec(TICK);
+}
 
-MATRIX_LOOP_END:
+static void keyboard_peripherals_task(void)
+{
+    static uint8_t led_status = 0;
+
+    // advance macros waiting on WAIT/INTERVAL
+    action_macro_task();
 
 #ifdef MOUSEKEY_ENABLE
     // mousekey repeat & acceleration
@@ -218,6 +223,11 @@ MATRIX_LOOP_END:
     adb_mouse_task();
 #endif
 
+#ifdef MOUSE_ENABLE
+    // send motion held back while the mouse endpoint was busy
+    host_mouse_flush();
+#endif
+
 #ifdef SERIAL_LINK_ENABLE
 	serial_link_update();
 #endif
@@ -233,6 +243,50 @@ MATRIX_LOOP_END:
     }
 }
 
+/*
+ * Run the next step of the keyboard routine. A full keyboard_task() is split
+ * into scan, process and peripheral steps so protocols with hard service
+ * deadlines (V-USB) can do their own work in between.
+ * Returns true when the last step of a cycle has been run.
+ */
+bool keyboard_task_step(void)
+{
+    static enum {
+        KEYBOARD_STEP_SCAN,
+        KEYBOARD_STEP_PROCESS,
+        KEYBOARD_STEP_PERIPHERALS,
+    } step = KEYBOARD_STEP_SCAN;
+
+    switch (step) {
+        case KEYBOARD_STEP_SCAN:
+            perf_task_begin();
+            // timeouts expire before the events of this scan
+            deadline_task();
+            matrix_scan();
+            step = KEYBOARD_STEP_PROCESS;
+            return false;
+        case KEYBOARD_STEP_PROCESS:
+            keyboard_process_matrix();
+            step = KEYBOARD_STEP_PERIPHERALS;
+            return false;
+        case KEYBOARD_STEP_PERIPHERALS:
+        default:
+            keyboard_peripherals_task();
+            perf_task_end();
+            step = KEYBOARD_STEP_SCAN;
+            return true;
+    }
+}
+
+/*
+ * Do keyboard routine jobs: scan mantrix, light LEDs, ...
+ * This is repeatedly called as fast as possible.
+ */
+void keyboard_task(void)
+{
+    while (!keyboard_task_step());
+}
+
 void keyboard_set_leds(uint8_t leds)
 {
     if (debug_keyboard) { debug("keyboard_set_led: "); debug_hex8(leds); debug("\n"); }
@@ -63,6 +63,8 @@ void keyboard_setup(void);
 void keyboard_init(void);
 /* it runs repeatedly in main loop */
 void keyboard_task(void);
+/* runs one bounded step of keyboard_task, returns true at the end of a cycle */
+bool keyboard_task_step(void);
 /* it runs when host LED status is updated */
 void keyboard_set_leds(uint8_t leds);
 
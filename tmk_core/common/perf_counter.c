@@ -0,0 +1,134 @@
+#include <string.h>
+#include "perf_counter.h"
+#include "timer.h"
+#include "print.h"
+
+
+static perf_counters_t counters;
+
+static bool running = false;
+static uint16_t task_start = 0;
+static uint16_t second_start = 0;
+static uint16_t scan_count = 0;
+static uint16_t report_count = 0;
+static bool edge_pending = false;
+static uint16_t edge_time = 0;
+
+static inline void count_saturated(uint16_t *c)
+{
+    if (*c < UINT16_MAX) (*c)++;
+}
+
+static uint8_t scan_bucket(uint16_t period)
+{
+    uint8_t b = 0;
+    while (period && b < PERF_SCAN_BUCKETS - 1) {
+        period >>= 1;
+        b++;
+    }
+    return b;
+}
+
+void perf_task_begin(void)
+{
+    uint16_t now = timer_read();
+
+    if (running) {
+        count_saturated(&counters.scan_period[scan_bucket(TIMER_DIFF_16(now, task_start))]);
+    } else {
+        running = true;
+        second_start = now;
+    }
+    task_start = now;
+
+    if (TIMER_DIFF_16(now, second_start) >= 1000) {
+        counters.scans_per_sec = scan_count;
+        counters.reports_per_sec = report_count;
+        scan_count = 0;
+        report_count = 0;
+        second_start = now;
+    }
+    count_saturated(&scan_count);
+}
+
+void perf_task_end(void)
+{
+    uint16_t now = timer_read();
+    uint16_t duration = TIMER_DIFF_16(now, task_start);
+
+    if (duration > counters.task_max) {
+        counters.task_max = duration;
+    }
+    // the edge didn't change the report, e.g. a layer key
+    if (edge_pending && TIMER_DIFF_16(now, edge_time) > PERF_LATENCY_TIMEOUT) {
+        edge_pending = false;
+    }
+}
+
+void perf_key_event(void)
+{
+    // keep the oldest edge not reported yet, the event was found by the
+    // matrix scan at the start of this task
+    if (!edge_pending) {
+        edge_pending = true;
+        edge_time = task_start;
+    }
+}
+
+void perf_report_sent(void)
+{
+    count_saturated(&report_count);
+    if (edge_pending) {
+        edge_pending = false;
+        counters.latency_last = TIMER_DIFF_16(timer_read(), edge_time);
+        if (counters.latency_last > counters.latency_max) {
+            counters.latency_max = counters.latency_last;
+        }
+    }
+}
+
+void perf_counters_clear(void)
+{
+    memset(&counters, 0, sizeof(counters));
+    running = false;
+    scan_count = 0;
+    report_count = 0;
+    edge_pending = false;
+}
+
+const perf_counters_t *perf_counters_get(void)
+{
+    return &counters;
+}
+
+void perf_counters_print(void)
+{
+#if !defined(NO_PRINT) && !defined(USER_PRINT)
+    print("\n\t- Performance -\n");
+    print("scan period(ms):\n");
+    for (uint8_t i = 0; i < PERF_SCAN_BUCKETS; i++) {
+        xprintf("  >=%u: %u\n", i ? 1 << (i - 1) : 0, counters.scan_period[i]);
+    }
+    xprintf("scans/s: %u\n", counters.scans_per_sec);
+    xprintf("reports/s: %u\n", counters.reports_per_sec);
+    xprintf("task max(ms): %u\n", counters.task_max);
+    xprintf("latency(ms): %u max: %u\n", counters.latency_last, counters.latency_max);
+#endif
+}
+
+bool perf_counters_raw_hid(uint8_t *data, uint8_t length)
+{
+    if (length < 1 || data[0] != PERF_COUNTER_RAW_HID_ID) {
+        return false;
+    }
+    // reply: id, then the counters as little endian uint16_t
+    const uint16_t *src = (const uint16_t *)&counters;
+    uint8_t n = sizeof(counters) / sizeof(uint16_t);
+    uint8_t i = 1;
+    for (uint8_t j = 0; j < n && i + 1 < length; j++) {
+        data[i++] = src[j] & 0xFF;
+        data[i++] = src[j] >> 8;
+    }
+    memset(data + i, 0, length - i);
+    return true;
+}
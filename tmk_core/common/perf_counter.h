@@ -0,0 +1,62 @@
+#ifndef PERF_COUNTER_H
+#define PERF_COUNTER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Scan period histogram buckets(ms):
+ * 0, 1, 2-3, 4-7, 8-15, 16-31, 32-
+ */
+#define PERF_SCAN_BUCKETS 7
+
+/* key edges not followed by a report within this time(ms) are dropped */
+#ifndef PERF_LATENCY_TIMEOUT
+#define PERF_LATENCY_TIMEOUT 1000
+#endif
+
+/* first byte of a raw HID packet asking for the counters */
+#ifndef PERF_COUNTER_RAW_HID_ID
+#define PERF_COUNTER_RAW_HID_ID 0xF0
+#endif
+
+typedef struct {
+    uint16_t scan_period[PERF_SCAN_BUCKETS];
+    uint16_t task_max;          // worst keyboard_task duration(ms)
+    uint16_t latency_last;      // key edge to keyboard report(ms)
+    uint16_t latency_max;
+    uint16_t scans_per_sec;     // during the last complete second
+    uint16_t reports_per_sec;
+} perf_counters_t;
+
+#ifdef PERF_COUNTER_ENABLE
+
+void perf_task_begin(void);
+void perf_task_end(void);
+void perf_key_event(void);
+void perf_report_sent(void);
+
+void perf_counters_clear(void);
+const perf_counters_t *perf_counters_get(void);
+void perf_counters_print(void);
+/* answer a raw HID request in place, returns false if it isn't one */
+bool perf_counters_raw_hid(uint8_t *data, uint8_t length);
+
+#else
+
+#define perf_task_begin()
+#define perf_task_end()
+#define perf_key_event()
+#define perf_report_sent()
+
+#endif
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
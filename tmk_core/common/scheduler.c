@@ -0,0 +1,99 @@
+#include <stddef.h>
+#include "scheduler.h"
+#include "timer.h"
+#include "print.h"
+
+static scheduler_task_t *tasks = NULL;
+/* first task to try after the scan, set when a pass ran out of time */
+static scheduler_task_t *resume = NULL;
+static uint16_t pass_start;
+
+void scheduler_register(scheduler_task_t *task)
+{
+    scheduler_task_t **p = &tasks;
+    while (*p && (*p)->priority <= task->priority) {
+        p = &(*p)->next;
+    }
+    task->next = *p;
+    *p = task;
+}
+
+void scheduler_clear(void)
+{
+    tasks = NULL;
+    resume = NULL;
+}
+
+static void run_task(scheduler_task_t *task)
+{
+    uint16_t start = timer_read();
+    task->fn();
+    uint16_t time = timer_elapsed(start);
+
+    task->last_run = start;
+    if (task->stats.runs < UINT16_MAX) task->stats.runs++;
+    if (time > task->stats.max_time) task->stats.max_time = time;
+    if (task->budget && time > task->budget && task->stats.overruns < UINT16_MAX) {
+        task->stats.overruns++;
+    }
+}
+
+static bool is_due(scheduler_task_t *task)
+{
+    return !task->period || timer_elapsed(task->last_run) >= task->period;
+}
+
+void scheduler_run(void)
+{
+    scheduler_task_t *first = tasks;
+    if (!first) return;
+
+    // the scan task is the head of the list
+    if (first->priority == TASK_PRIORITY_SCAN) {
+        if (is_due(first)) run_task(first);
+        first = first->next;
+        if (!first) return;
+    }
+
+    scheduler_task_t *start = resume ? resume : first;
+    scheduler_task_t *task = start;
+    bool ran = false;
+
+    resume = NULL;
+    pass_start = timer_read();
+    do {
+        if (is_due(task)) {
+            if (ran && scheduler_scan_due()) {
+                if (task->stats.deferred < UINT16_MAX) task->stats.deferred++;
+                if (!resume) resume = task;
+            } else {
+                run_task(task);
+                ran = true;
+            }
+        }
+        task = task->next ? task->next : first;
+    } while (task != start);
+}
+
+bool scheduler_scan_due(void)
+{
+    return timer_elapsed(pass_start) >= SCHEDULER_PASS_BUDGET;
+}
+
+void scheduler_clear_stats(void)
+{
+    for (scheduler_task_t *task = tasks; task; task = task->next) {
+        task->stats = (task_stats_t){ 0 };
+    }
+}
+
+void scheduler_print_stats(void)
+{
+    print("\n\t- Tasks -\n");
+    print("pri runs  max(ms) overruns deferred\n");
+    for (scheduler_task_t *task = tasks; task; task = task->next) {
+        xprintf("%3u %5u %7u %8u %8u\n",
+                task->priority, task->stats.runs, task->stats.max_time,
+                task->stats.overruns, task->stats.deferred);
+    }
+}
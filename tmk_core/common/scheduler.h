@@ -0,0 +1,65 @@
+#ifndef SCHEDULER_H
+#define SCHEDULER_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Cooperative main loop scheduler.
+ *
+ * Each pass of scheduler_run() first runs the matrix scan task, then the
+ * other due tasks in priority order. Once the tasks after the scan have
+ * taken SCHEDULER_PASS_BUDGET ms the rest are deferred to the next pass,
+ * which picks up at the first deferred task, so a slow LED update can't
+ * hold back the next scan. At least one task runs per pass.
+ */
+#ifndef SCHEDULER_PASS_BUDGET
+#define SCHEDULER_PASS_BUDGET 2
+#endif
+
+/* lower runs first, the scan task always comes first */
+#define TASK_PRIORITY_SCAN  0
+#define TASK_PRIORITY_USB   1
+#define TASK_PRIORITY_HIGH  2
+#define TASK_PRIORITY_LOW   8
+
+typedef struct {
+    uint16_t runs;
+    uint16_t max_time;  // longest run(ms)
+    uint16_t overruns;  // runs longer than budget
+    uint16_t deferred;  // passes it was due but had to wait
+} task_stats_t;
+
+typedef struct scheduler_task {
+    void (*fn)(void);
+    uint8_t priority;
+    uint16_t period;    // ms between runs, 0: every pass
+    uint16_t budget;    // ms a run is expected to take
+    /* used by the scheduler */
+    uint16_t last_run;
+    task_stats_t stats;
+    struct scheduler_task *next;
+} scheduler_task_t;
+
+#define SCHEDULER_TASK(fn, priority, period, budget) { fn, priority, period, budget, 0, { 0 }, 0 }
+
+/* task has to stay around, usually a static */
+void scheduler_register(scheduler_task_t *task);
+/* forget all tasks */
+void scheduler_clear(void);
+void scheduler_run(void);
+/* true when a long running task should return and let the scan run */
+bool scheduler_scan_due(void);
+
+void scheduler_clear_stats(void);
+void scheduler_print_stats(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
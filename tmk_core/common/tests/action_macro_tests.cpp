@@ -0,0 +1,216 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string>
+#include <vector>
+extern "C" {
+#include "action.h"
+#include "action_util.h"
+#include "action_macro.h"
+}
+
+using testing::ElementsAre;
+
+class ActionMacro : public ::testing::Test {
+public:
+    ActionMacro() {
+        Instance = this;
+        now = 1000;
+    }
+
+    ~ActionMacro() {
+        // don't leak a half played macro into the next test
+        while (action_macro_is_playing()) {
+            tick(1);
+        }
+        Instance = nullptr;
+    }
+
+    void log(const char* what, uint8_t code) {
+        char buf[32];
+        snprintf(buf, sizeof(buf), "%u:%s%02X", (unsigned)(uint16_t)(now - 1000), what, code);
+        events.push_back(buf);
+    }
+
+    /* advance the virtual clock, running the main loop once per ms */
+    void tick(uint16_t ms) {
+        while (ms--) {
+            now++;
+            action_macro_task();
+        }
+    }
+
+    uint16_t now;
+    std::vector<std::string> events;
+    std::vector<uint32_t> waits;
+
+    static ActionMacro* Instance;
+};
+
+ActionMacro* ActionMacro::Instance = nullptr;
+
+extern "C" {
+    uint16_t timer_read(void) {
+        return ActionMacro::Instance->now;
+    }
+
+    void wait_ms(uint32_t ms) {
+        ActionMacro::Instance->waits.push_back(ms);
+        ActionMacro::Instance->now += ms;
+    }
+
+    void register_code(uint8_t code) {
+        ActionMacro::Instance->log("D", code);
+    }
+
+    void unregister_code(uint8_t code) {
+        ActionMacro::Instance->log("U", code);
+    }
+
+    void add_macro_mods(uint8_t mods) {
+        ActionMacro::Instance->log("M+", mods);
+    }
+
+    void del_macro_mods(uint8_t mods) {
+        ActionMacro::Instance->log("M-", mods);
+    }
+
+    void send_keyboard_report(void) {
+    }
+}
+
+static const macro_t no_waits[] = { D(LSFT), T(A), U(LSFT), END };
+static const macro_t with_wait[] = { T(A), W(20), T(B), END };
+static const macro_t with_interval[] = { I(5), T(A), T(B), END };
+static const macro_t long_wait[] = { T(A), W(200), W(200), T(B), END };
+static const macro_t short_codes[] = { KC_A, KC_A | 0x80, END };
+
+TEST_F(ActionMacro, plays_a_macro_without_waits_immediately) {
+    action_macro_play(no_waits);
+    EXPECT_THAT(events, ElementsAre("0:M+02", "0:D04", "0:U04", "0:M-02"));
+    EXPECT_FALSE(action_macro_is_playing());
+}
+
+TEST_F(ActionMacro, supports_single_byte_key_commands) {
+    action_macro_play(short_codes);
+    EXPECT_THAT(events, ElementsAre("0:D04", "0:U04"));
+}
+
+TEST_F(ActionMacro, ignores_a_null_macro) {
+    action_macro_play(MACRO_NONE);
+    EXPECT_FALSE(action_macro_is_playing());
+}
+
+TEST_F(ActionMacro, does_not_block_on_wait) {
+    action_macro_play(with_wait);
+    EXPECT_THAT(events, ElementsAre("0:D04", "0:U04"));
+    EXPECT_TRUE(action_macro_is_playing());
+    EXPECT_TRUE(waits.empty());
+    tick(19);
+    EXPECT_EQ(events.size(), 2);
+    tick(1);
+    EXPECT_THAT(events, ElementsAre("0:D04", "0:U04", "20:D05", "20:U05"));
+    EXPECT_FALSE(action_macro_is_playing());
+}
+
+TEST_F(ActionMacro, waits_interval_between_steps) {
+    action_macro_play(with_interval);
+    tick(30);
+    EXPECT_THAT(events, ElementsAre("5:D04", "10:U04", "15:D05", "20:U05"));
+    EXPECT_TRUE(waits.empty());
+}
+
+TEST_F(ActionMacro, keeps_exact_timing_when_the_loop_is_slow) {
+    action_macro_play(with_interval);
+    // the main loop only comes around every 3ms, steps stay on the 5ms grid
+    for (int i = 0; i < 10; i++) {
+        now += 3;
+        action_macro_task();
+    }
+    EXPECT_THAT(events, ElementsAre("6:D04", "12:U04", "15:D05", "21:U05"));
+}
+
+TEST_F(ActionMacro, does_not_catch_up_after_a_long_stall) {
+    action_macro_play(with_interval);
+    now += 17;
+    action_macro_task();
+    tick(10);
+    EXPECT_THAT(events, ElementsAre("17:D04", "22:U04", "27:D05"));
+}
+
+TEST_F(ActionMacro, waits_longer_than_255ms_add_up) {
+    action_macro_play(long_wait);
+    tick(399);
+    EXPECT_EQ(events.size(), 2);
+    tick(1);
+    EXPECT_THAT(events, ElementsAre("0:D04", "0:U04", "400:D05", "400:U05"));
+}
+
+#if ACTION_MACRO_PLAYERS == 1
+TEST_F(ActionMacro, queues_a_macro_until_the_running_one_ends) {
+    action_macro_play(with_wait);
+    tick(10);
+    action_macro_play(with_interval);
+    EXPECT_THAT(events, ElementsAre("0:D04", "0:U04"));
+    tick(30);
+    EXPECT_THAT(events, ElementsAre(
+        "0:D04", "0:U04", "20:D05", "20:U05",
+        "25:D04", "30:U04", "35:D05", "40:U05"));
+    EXPECT_TRUE(waits.empty());
+}
+
+TEST_F(ActionMacro, does_not_mix_modifiers_into_the_running_macro) {
+    action_macro_play(with_wait);
+    action_macro_play(no_waits);
+    EXPECT_THAT(events, ElementsAre("0:D04", "0:U04"));
+    EXPECT_TRUE(action_macro_is_playing());
+    tick(20);
+    EXPECT_THAT(events, ElementsAre(
+        "0:D04", "0:U04", "20:D05", "20:U05",
+        "20:M+02", "20:D04", "20:U04", "20:M-02"));
+    EXPECT_FALSE(action_macro_is_playing());
+}
+#else
+TEST_F(ActionMacro, plays_macros_concurrently) {
+    action_macro_play(with_wait);
+    tick(10);
+    action_macro_play(with_interval);
+    tick(20);
+    EXPECT_THAT(events, ElementsAre(
+        "0:D04", "0:U04",
+        "15:D04", "20:D05", "20:U05", "20:U04", "25:D05", "30:U05"));
+    EXPECT_TRUE(waits.empty());
+}
+#endif
+
+TEST_F(ActionMacro, plays_out_the_oldest_macro_when_the_queue_is_full) {
+    for (int i = 0; i < ACTION_MACRO_PLAYERS; i++) {
+        action_macro_play(with_wait);
+        tick(1);
+    }
+    for (int i = 0; i < ACTION_MACRO_QUEUE; i++) {
+        action_macro_play(short_codes);
+    }
+    events.clear();
+    action_macro_play(no_waits);
+    // the first macro was played out with blocking waits, then the queue
+    // in order
+    EXPECT_FALSE(waits.empty());
+    ASSERT_EQ(events.size(), 2 + 2 * ACTION_MACRO_QUEUE + 4);
+    EXPECT_EQ(events[0], "20:D05");
+    EXPECT_EQ(events[1], "20:U05");
+    EXPECT_EQ(events[2], "20:D04");
+    EXPECT_THAT(std::vector<std::string>(events.end() - 4, events.end()),
+        ElementsAre("20:M+02", "20:D04", "20:U04", "20:M-02"));
+}
+
+TEST_F(ActionMacro, handles_timer_wraparound) {
+    now = UINT16_MAX - 5;
+    action_macro_play(with_wait);
+    events.clear();
+    uint16_t start = now;
+    while (action_macro_is_playing()) {
+        now++;
+        action_macro_task();
+    }
+    EXPECT_EQ((uint16_t)(now - start), 20);
+}
@@ -0,0 +1,166 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string>
+#include <vector>
+extern "C" {
+#include "deadline.h"
+}
+
+using testing::ElementsAre;
+
+static uint32_t now;
+static std::vector<std::string> ran;
+
+extern "C" {
+    uint32_t timer_read32(void) {
+        return now;
+    }
+}
+
+static void a(void) { ran.push_back("a"); }
+static void b(void) { ran.push_back("b"); }
+static void c(void) { ran.push_back("c"); }
+
+class Deadline : public ::testing::Test {
+public:
+    Deadline() {
+        now = 1000;
+        ran.clear();
+        deadline_clear();
+    }
+
+    /* advance the virtual clock, running the main loop once per ms */
+    void tick(uint32_t ms) {
+        while (ms--) {
+            now++;
+            deadline_task();
+        }
+    }
+};
+
+TEST_F(Deadline, runs_nothing_when_empty) {
+    deadline_task();
+    EXPECT_TRUE(ran.empty());
+}
+
+TEST_F(Deadline, runs_a_function_when_it_is_due) {
+    deadline_in(a, 10);
+    EXPECT_TRUE(deadline_pending(a));
+    tick(9);
+    EXPECT_TRUE(ran.empty());
+    tick(1);
+    EXPECT_THAT(ran, ElementsAre("a"));
+    EXPECT_FALSE(deadline_pending(a));
+    tick(100);
+    EXPECT_THAT(ran, ElementsAre("a"));
+}
+
+TEST_F(Deadline, runs_overdue_functions_on_the_next_call) {
+    deadline_in(a, 10);
+    now += 50;
+    deadline_task();
+    EXPECT_THAT(ran, ElementsAre("a"));
+}
+
+TEST_F(Deadline, runs_functions_in_time_order) {
+    deadline_in(a, 30);
+    deadline_in(b, 10);
+    deadline_in(c, 20);
+    tick(30);
+    EXPECT_THAT(ran, ElementsAre("b", "c", "a"));
+}
+
+TEST_F(Deadline, runs_everything_due_in_one_call) {
+    deadline_in(a, 5);
+    deadline_in(b, 5);
+    now += 5;
+    deadline_task();
+    EXPECT_EQ(ran.size(), 2);
+}
+
+TEST_F(Deadline, setting_again_moves_the_deadline) {
+    deadline_in(a, 10);
+    deadline_in(b, 15);
+    deadline_in(a, 20);
+    tick(30);
+    EXPECT_THAT(ran, ElementsAre("b", "a"));
+    deadline_in(a, 20);
+    deadline_in(a, 5);
+    tick(5);
+    EXPECT_THAT(ran, ElementsAre("b", "a", "a"));
+}
+
+TEST_F(Deadline, cancels) {
+    deadline_in(a, 10);
+    deadline_in(b, 10);
+    deadline_cancel(a);
+    deadline_cancel(c);
+    tick(10);
+    EXPECT_THAT(ran, ElementsAre("b"));
+}
+
+/* distinct functions, each logging its number */
+static std::vector<int> order;
+#define FN(n) [](void) { order.push_back(n); }
+static deadline_fn_t numbered[] = {FN(0), FN(1), FN(2), FN(3), FN(4), FN(5), FN(6), FN(7), FN(8)};
+#undef FN
+
+TEST_F(Deadline, refuses_more_than_the_slots) {
+    static_assert(DEADLINE_SLOTS < sizeof(numbered) / sizeof(numbered[0]), "");
+    order.clear();
+    for (int i = 0; i < DEADLINE_SLOTS; i++) {
+        EXPECT_TRUE(deadline_in(numbered[i], 1));
+    }
+    EXPECT_FALSE(deadline_in(numbered[DEADLINE_SLOTS], 1));
+    // moving one that is already there still works
+    EXPECT_TRUE(deadline_in(numbered[0], 2));
+    tick(2);
+    EXPECT_EQ(order.size(), DEADLINE_SLOTS);
+    EXPECT_EQ(order.back(), 0);
+}
+
+TEST_F(Deadline, keeps_heap_order_with_many_changes) {
+    uint32_t seed = 7;
+    uint32_t when[8];
+    for (int round = 0; round < 50; round++) {
+        for (int i = 0; i < 8; i++) {
+            seed = seed * 1103515245 + 12345;
+            when[i] = (seed >> 16) % 100 + 1;
+            deadline_in(numbered[i], when[i]);
+        }
+        seed = seed * 1103515245 + 12345;
+        deadline_cancel(numbered[(seed >> 16) % 8]);
+        order.clear();
+        tick(101);
+        for (size_t i = 1; i < order.size(); i++) {
+            EXPECT_LE(when[order[i - 1]], when[order[i]]);
+        }
+        EXPECT_EQ(order.size(), 7);
+    }
+}
+
+static void again(void) {
+    ran.push_back("again");
+    deadline_in(again, 0);
+}
+
+TEST_F(Deadline, a_function_rescheduling_itself_now_runs_once_per_call) {
+    deadline_in(again, 1);
+    tick(1);
+    EXPECT_EQ(ran.size(), 1);
+    deadline_task();
+    EXPECT_EQ(ran.size(), 2);
+    deadline_cancel(again);
+}
+
+TEST_F(Deadline, handles_timer_wraparound) {
+    now = UINT32_MAX - 5;
+    deadline_in(a, 10);
+    deadline_in(b, 3);
+    tick(3);
+    EXPECT_THAT(ran, ElementsAre("b"));
+    tick(6);
+    EXPECT_THAT(ran, ElementsAre("b"));
+    tick(1);
+    EXPECT_THAT(ran, ElementsAre("b", "a"));
+}
@@ -0,0 +1,179 @@
+#include "gtest/gtest.h"
+#include <vector>
+extern "C" {
+#include "host.h"
+}
+
+class HostMouse : public ::testing::Test {
+public:
+    HostMouse() {
+        Instance = this;
+        ready = true;
+        host_set_driver(&driver);
+    }
+
+    ~HostMouse() {
+        host_set_driver(nullptr);
+        Instance = nullptr;
+    }
+
+    void send(uint8_t buttons, int8_t x, int8_t y, int8_t v = 0, int8_t h = 0) {
+        report_mouse_t r = {buttons, x, y, v, h};
+        host_mouse_send(&r);
+    }
+
+    static void send_mouse(report_mouse_t* report) {
+        Instance->sent.push_back(*report);
+    }
+
+    static uint8_t mouse_ready(void) {
+        return Instance->ready;
+    }
+
+    static void send_system(uint16_t report) {
+        Instance->system.push_back(report);
+    }
+
+    static void send_consumer(uint16_t report) {
+        Instance->consumer.push_back(report);
+    }
+
+    std::vector<report_mouse_t> sent;
+    std::vector<uint16_t> system;
+    std::vector<uint16_t> consumer;
+    bool ready;
+    host_driver_t driver = {
+        nullptr,
+        nullptr,
+        send_mouse,
+        send_system,
+        send_consumer,
+#ifdef MIDI_ENABLE
+        nullptr,
+        nullptr,
+        nullptr,
+#endif
+        mouse_ready
+    };
+
+    static HostMouse* Instance;
+};
+
+HostMouse* HostMouse::Instance = nullptr;
+
+TEST_F(HostMouse, sends_a_report_when_the_endpoint_is_ready) {
+    send(0, 5, -3);
+    ASSERT_EQ(sent.size(), 1);
+    EXPECT_EQ(sent[0].x, 5);
+    EXPECT_EQ(sent[0].y, -3);
+    EXPECT_FALSE(host_mouse_pending());
+}
+
+TEST_F(HostMouse, suppresses_all_zero_reports) {
+    send(0, 0, 0);
+    send(0, 0, 0);
+    EXPECT_EQ(sent.size(), 0);
+}
+
+TEST_F(HostMouse, suppresses_repeated_zero_reports_after_a_release) {
+    send(MOUSE_BTN1, 0, 0);
+    send(0, 0, 0);
+    send(0, 0, 0);
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent[0].buttons, MOUSE_BTN1);
+    EXPECT_EQ(sent[1].buttons, 0);
+}
+
+TEST_F(HostMouse, sends_button_changes_without_motion) {
+    send(MOUSE_BTN1, 0, 0);
+    send(MOUSE_BTN1 | MOUSE_BTN2, 0, 0);
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent[1].buttons, MOUSE_BTN1 | MOUSE_BTN2);
+}
+
+TEST_F(HostMouse, accumulates_motion_while_the_endpoint_is_busy) {
+    ready = false;
+    send(0, 10, 1, 1, 0);
+    send(0, 10, -2, 1, -1);
+    send(0, -5, 0, 0, -1);
+    EXPECT_EQ(sent.size(), 0);
+    EXPECT_TRUE(host_mouse_pending());
+    ready = true;
+    host_mouse_flush();
+    ASSERT_EQ(sent.size(), 1);
+    EXPECT_EQ(sent[0].x, 15);
+    EXPECT_EQ(sent[0].y, -1);
+    EXPECT_EQ(sent[0].v, 2);
+    EXPECT_EQ(sent[0].h, -2);
+    host_mouse_flush();
+    EXPECT_EQ(sent.size(), 1);
+}
+
+TEST_F(HostMouse, saturates_at_127_and_carries_the_remainder) {
+    ready = false;
+    send(0, 100, -100);
+    send(0, 100, -100);
+    ready = true;
+    host_mouse_flush();
+    ASSERT_EQ(sent.size(), 1);
+    EXPECT_EQ(sent[0].x, 127);
+    EXPECT_EQ(sent[0].y, -127);
+    host_mouse_flush();
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent[1].x, 73);
+    EXPECT_EQ(sent[1].y, -73);
+    EXPECT_FALSE(host_mouse_pending());
+}
+
+TEST_F(HostMouse, never_sends_minus_128) {
+    send(0, -128, -128);
+    ASSERT_EQ(sent.size(), 1);
+    EXPECT_EQ(sent[0].x, -127);
+    host_mouse_flush();
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent[1].x, -1);
+}
+
+TEST_F(HostMouse, bounds_the_accumulated_motion) {
+    ready = false;
+    for (int i = 0; i < 100; i++) {
+        send(0, 127, 0);
+    }
+    ready = true;
+    int total = 0;
+    while (host_mouse_pending()) {
+        host_mouse_flush();
+        total += sent.back().x;
+    }
+    EXPECT_EQ(total, MOUSE_REPORT_ACCUM_MAX);
+}
+
+TEST_F(HostMouse, does_not_lose_a_click_while_busy) {
+    ready = false;
+    send(MOUSE_BTN1, 1, 0);
+    EXPECT_EQ(sent.size(), 0);
+    send(0, 1, 0);
+    ASSERT_EQ(sent.size(), 1);
+    EXPECT_EQ(sent[0].buttons, MOUSE_BTN1);
+    EXPECT_EQ(sent[0].x, 1);
+    ready = true;
+    host_mouse_flush();
+    ASSERT_EQ(sent.size(), 2);
+    EXPECT_EQ(sent[1].buttons, 0);
+    EXPECT_EQ(sent[1].x, 1);
+}
+
+TEST_F(HostMouse, sends_system_and_consumer_reports_once_per_change) {
+    host_system_send(0x82);
+    host_system_send(0x82);
+    host_consumer_send(0xE9);
+    host_consumer_send(0xE9);
+    EXPECT_EQ(host_last_system_report(), 0x82);
+    EXPECT_EQ(host_last_consumer_report(), 0xE9);
+    host_system_send(0);
+    host_consumer_send(0);
+    EXPECT_EQ(system, std::vector<uint16_t>({0x82, 0}));
+    EXPECT_EQ(consumer, std::vector<uint16_t>({0xE9, 0}));
+    EXPECT_EQ(host_last_system_report(), 0);
+    EXPECT_EQ(host_last_consumer_report(), 0);
+}
@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+extern "C" {
+#include "perf_counter.h"
+#include "timer.h"
+}
+
+static uint16_t now;
+
+extern "C" {
+    uint16_t timer_read(void) {
+        return now;
+    }
+}
+
+class PerfCounter : public ::testing::Test {
+public:
+    PerfCounter() {
+        now = 100;
+        perf_counters_clear();
+    }
+
+    /* one keyboard_task taking duration ms, followed by idle ms */
+    void task(uint16_t duration, uint16_t idle = 0, bool key = false, bool report = false) {
+        perf_task_begin();
+        if (key) perf_key_event();
+        now += duration;
+        if (report) perf_report_sent();
+        perf_task_end();
+        now += idle;
+    }
+
+    const perf_counters_t* c() { return perf_counters_get(); }
+};
+
+TEST_F(PerfCounter, starts_cleared) {
+    for (int i = 0; i < PERF_SCAN_BUCKETS; i++) {
+        EXPECT_EQ(c()->scan_period[i], 0);
+    }
+    EXPECT_EQ(c()->task_max, 0);
+    EXPECT_EQ(c()->latency_max, 0);
+}
+
+TEST_F(PerfCounter, the_first_scan_has_no_period) {
+    task(0);
+    for (int i = 0; i < PERF_SCAN_BUCKETS; i++) {
+        EXPECT_EQ(c()->scan_period[i], 0);
+    }
+}
+
+TEST_F(PerfCounter, puts_scan_periods_into_log2_buckets) {
+    task(0);        // no period yet
+    task(0);        // 0
+    task(1);        // 0
+    task(0, 3);     // 1
+    task(5);        // 3
+    task(0, 40);    // 5
+    task(0);        // 40
+    EXPECT_EQ(c()->scan_period[0], 2);
+    EXPECT_EQ(c()->scan_period[1], 1);
+    EXPECT_EQ(c()->scan_period[2], 1);
+    EXPECT_EQ(c()->scan_period[3], 1);
+    EXPECT_EQ(c()->scan_period[4], 0);
+    EXPECT_EQ(c()->scan_period[5], 0);
+    EXPECT_EQ(c()->scan_period[6], 1);
+}
+
+TEST_F(PerfCounter, saturates_the_histogram) {
+    for (uint32_t i = 0; i < 70000; i++) {
+        task(0);
+    }
+    EXPECT_EQ(c()->scan_period[0], UINT16_MAX);
+}
+
+TEST_F(PerfCounter, tracks_the_worst_task_duration) {
+    task(2);
+    task(7);
+    task(3);
+    EXPECT_EQ(c()->task_max, 7);
+}
+
+TEST_F(PerfCounter, measures_latency_from_edge_to_report) {
+    task(1, 0, true);
+    task(1);
+    task(2, 0, false, true);
+    EXPECT_EQ(c()->latency_last, 4);
+    task(1, 0, true, true);
+    EXPECT_EQ(c()->latency_last, 1);
+    EXPECT_EQ(c()->latency_max, 4);
+}
+
+TEST_F(PerfCounter, reports_without_an_edge_do_not_change_latency) {
+    task(1, 0, true, true);
+    task(5, 0, false, true);
+    EXPECT_EQ(c()->latency_last, 1);
+    EXPECT_EQ(c()->latency_max, 1);
+}
+
+TEST_F(PerfCounter, drops_edges_that_never_produce_a_report) {
+    task(0, PERF_LATENCY_TIMEOUT + 1, true);
+    task(0);
+    task(0, 0, false, true);
+    EXPECT_EQ(c()->latency_max, 0);
+}
+
+TEST_F(PerfCounter, counts_scans_and_reports_per_second) {
+    for (int i = 0; i < 500; i++) {
+        task(0, 2, false, i % 10 == 0);
+    }
+    task(0);
+    EXPECT_EQ(c()->scans_per_sec, 500);
+    EXPECT_EQ(c()->reports_per_sec, 50);
+}
+
+TEST_F(PerfCounter, handles_timer_wraparound) {
+    now = UINT16_MAX - 1;
+    task(0, 3);
+    task(0);
+    EXPECT_EQ(c()->scan_period[2], 1);
+}
+
+TEST_F(PerfCounter, ignores_other_raw_hid_packets) {
+    uint8_t data[32] = {0x01};
+    EXPECT_FALSE(perf_counters_raw_hid(data, sizeof(data)));
+    EXPECT_EQ(data[1], 0);
+}
+
+TEST_F(PerfCounter, answers_raw_hid_requests) {
+    task(0);
+    task(0, 0, true);
+    task(300, 0, false, true);
+    uint8_t data[32] = {PERF_COUNTER_RAW_HID_ID, 0xAA, 0xBB};
+    ASSERT_TRUE(perf_counters_raw_hid(data, sizeof(data)));
+    EXPECT_EQ(data[0], PERF_COUNTER_RAW_HID_ID);
+    // scan_period[0] == 2
+    EXPECT_EQ(data[1], 2);
+    EXPECT_EQ(data[2], 0);
+    // task_max == 300
+    uint8_t offset = 1 + 2 * PERF_SCAN_BUCKETS;
+    EXPECT_EQ(data[offset], 300 & 0xFF);
+    EXPECT_EQ(data[offset + 1], 300 >> 8);
+    EXPECT_EQ(data[31], 0);
+}
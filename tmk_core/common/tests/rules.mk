@@ -0,0 +1,37 @@
+TMK_COMMON_TEST_INC := $(TMK_PATH)/common
+TMK_COMMON_TEST_DEFS := -DNO_PRINT -DNO_DEBUG
+
+tmk_common_host_mouse_SRC :=\
+	$(TMK_PATH)/common/tests/host_mouse_tests.cpp \
+	$(TMK_PATH)/common/host.c \
+	$(TMK_PATH)/common/debug.c
+tmk_common_host_mouse_INC := $(TMK_COMMON_TEST_INC)
+tmk_common_host_mouse_DEFS := $(TMK_COMMON_TEST_DEFS) -DMOUSE_ENABLE
+
+tmk_common_perf_counter_SRC :=\
+	$(TMK_PATH)/common/tests/perf_counter_tests.cpp \
+	$(TMK_PATH)/common/perf_counter.c
+tmk_common_perf_counter_INC := $(TMK_COMMON_TEST_INC)
+tmk_common_perf_counter_DEFS := $(TMK_COMMON_TEST_DEFS) -DPERF_COUNTER_ENABLE
+
+tmk_common_action_macro_SRC :=\
+	$(TMK_PATH)/common/tests/action_macro_tests.cpp \
+	$(TMK_PATH)/common/action_macro.c
+tmk_common_action_macro_INC := $(TMK_COMMON_TEST_INC)
+tmk_common_action_macro_DEFS := $(TMK_COMMON_TEST_DEFS)
+
+tmk_common_action_macro_concurrent_SRC := $(tmk_common_action_macro_SRC)
+tmk_common_action_macro_concurrent_INC := $(TMK_COMMON_TEST_INC)
+tmk_common_action_macro_concurrent_DEFS := $(TMK_COMMON_TEST_DEFS) -DACTION_MACRO_PLAYERS=2
+
+tmk_common_deadline_SRC :=\
+	$(TMK_PATH)/common/tests/deadline_tests.cpp \
+	$(TMK_PATH)/common/deadline.c
+tmk_common_deadline_INC := $(TMK_COMMON_TEST_INC)
+tmk_common_deadline_DEFS := $(TMK_COMMON_TEST_DEFS)
+
+tmk_common_scheduler_SRC :=\
+	$(TMK_PATH)/common/tests/scheduler_tests.cpp \
+	$(TMK_PATH)/common/scheduler.c
+tmk_common_scheduler_INC := $(TMK_COMMON_TEST_INC)
+tmk_common_scheduler_DEFS := $(TMK_COMMON_TEST_DEFS)
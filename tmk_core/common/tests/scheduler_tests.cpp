@@ -0,0 +1,159 @@
+#include "gtest/gtest.h"
+#include "gmock/gmock.h"
+#include <string>
+#include <vector>
+extern "C" {
+#include "scheduler.h"
+#include "timer.h"
+}
+
+using testing::ElementsAre;
+
+static uint16_t now;
+static std::vector<std::string> ran;
+/* ms each task takes */
+static uint16_t cost[4];
+
+extern "C" {
+    uint16_t timer_read(void) {
+        return now;
+    }
+
+    uint16_t timer_elapsed(uint16_t last) {
+        return TIMER_DIFF_16(now, last);
+    }
+}
+
+static void scan(void) { ran.push_back("scan"); now += cost[0]; }
+static void usb(void) { ran.push_back("usb"); now += cost[1]; }
+static void midi(void) { ran.push_back("midi"); now += cost[2]; }
+static void led(void) { ran.push_back("led"); now += cost[3]; }
+
+class Scheduler : public ::testing::Test {
+public:
+    Scheduler() {
+        now = 1000;
+        ran.clear();
+        for (auto& c : cost) c = 0;
+        scheduler_clear();
+    }
+
+    /* run passes of the main loop, 1ms apart when no task takes time */
+    void loop(int passes) {
+        while (passes--) {
+            uint16_t start = now;
+            scheduler_run();
+            if (now == start) now++;
+        }
+    }
+};
+
+TEST_F(Scheduler, runs_nothing_without_tasks) {
+    scheduler_run();
+    EXPECT_TRUE(ran.empty());
+}
+
+TEST_F(Scheduler, runs_the_scan_first_then_by_priority) {
+    static scheduler_task_t tasks[] = {
+        SCHEDULER_TASK(led, TASK_PRIORITY_LOW, 0, 1),
+        SCHEDULER_TASK(midi, TASK_PRIORITY_HIGH, 0, 1),
+        SCHEDULER_TASK(scan, TASK_PRIORITY_SCAN, 0, 2),
+        SCHEDULER_TASK(usb, TASK_PRIORITY_USB, 0, 1),
+    };
+    for (auto& t : tasks) scheduler_register(&t);
+    loop(2);
+    EXPECT_THAT(ran, ElementsAre("scan", "usb", "midi", "led", "scan", "usb", "midi", "led"));
+}
+
+TEST_F(Scheduler, keeps_registration_order_within_a_priority) {
+    static scheduler_task_t tasks[] = {
+        SCHEDULER_TASK(midi, TASK_PRIORITY_HIGH, 0, 1),
+        SCHEDULER_TASK(led, TASK_PRIORITY_HIGH, 0, 1),
+    };
+    for (auto& t : tasks) scheduler_register(&t);
+    loop(1);
+    EXPECT_THAT(ran, ElementsAre("midi", "led"));
+}
+
+TEST_F(Scheduler, runs_periodic_tasks_when_due) {
+    static scheduler_task_t tasks[] = {
+        SCHEDULER_TASK(scan, TASK_PRIORITY_SCAN, 0, 2),
+        SCHEDULER_TASK(led, TASK_PRIORITY_LOW, 3, 1),
+    };
+    for (auto& t : tasks) scheduler_register(&t);
+    tasks[1].last_run = now;
+    loop(7);
+    EXPECT_THAT(ran, ElementsAre("scan", "scan", "scan", "scan", "led", "scan", "scan", "scan", "led"));
+}
+
+TEST_F(Scheduler, defers_tasks_once_the_pass_budget_is_used) {
+    static scheduler_task_t tasks[] = {
+        SCHEDULER_TASK(scan, TASK_PRIORITY_SCAN, 0, 2),
+        SCHEDULER_TASK(usb, TASK_PRIORITY_USB, 0, 1),
+        SCHEDULER_TASK(midi, TASK_PRIORITY_HIGH, 0, 1),
+        SCHEDULER_TASK(led, TASK_PRIORITY_LOW, 0, 1),
+    };
+    for (auto& t : tasks) scheduler_register(&t);
+    cost[1] = SCHEDULER_PASS_BUDGET;
+    loop(1);
+    EXPECT_THAT(ran, ElementsAre("scan", "usb"));
+    EXPECT_EQ(tasks[2].stats.deferred, 1);
+    EXPECT_EQ(tasks[3].stats.deferred, 1);
+
+    // the next pass picks up where this one stopped
+    cost[1] = 0;
+    ran.clear();
+    loop(1);
+    EXPECT_THAT(ran, ElementsAre("scan", "midi", "led", "usb"));
+}
+
+TEST_F(Scheduler, does_not_starve_tasks_behind_a_slow_one) {
+    static scheduler_task_t tasks[] = {
+        SCHEDULER_TASK(scan, TASK_PRIORITY_SCAN, 0, 2),
+        SCHEDULER_TASK(usb, TASK_PRIORITY_USB, 0, 1),
+        SCHEDULER_TASK(led, TASK_PRIORITY_LOW, 0, 1),
+    };
+    for (auto& t : tasks) scheduler_register(&t);
+    cost[1] = 5;
+    cost[3] = 5;
+    loop(4);
+    // one task per pass, taking turns
+    EXPECT_THAT(ran, ElementsAre("scan", "usb", "scan", "led", "scan", "usb", "scan", "led"));
+}
+
+TEST_F(Scheduler, counts_runs_and_overruns) {
+    static scheduler_task_t tasks[] = {
+        SCHEDULER_TASK(scan, TASK_PRIORITY_SCAN, 0, 2),
+        SCHEDULER_TASK(led, TASK_PRIORITY_LOW, 0, 1),
+    };
+    for (auto& t : tasks) scheduler_register(&t);
+    loop(3);
+    cost[0] = 3;
+    cost[3] = 4;
+    loop(2);
+    EXPECT_EQ(tasks[0].stats.runs, 5);
+    EXPECT_EQ(tasks[0].stats.max_time, 3);
+    EXPECT_EQ(tasks[0].stats.overruns, 2);
+    EXPECT_EQ(tasks[1].stats.runs, 5);
+    EXPECT_EQ(tasks[1].stats.max_time, 4);
+    EXPECT_EQ(tasks[1].stats.overruns, 2);
+
+    scheduler_clear_stats();
+    EXPECT_EQ(tasks[0].stats.runs, 0);
+    EXPECT_EQ(tasks[1].stats.max_time, 0);
+}
+
+TEST_F(Scheduler, tells_long_tasks_when_the_scan_is_due) {
+    static bool due_before, due_after;
+    static scheduler_task_t tasks[] = {
+        SCHEDULER_TASK([] {
+            due_before = scheduler_scan_due();
+            now += SCHEDULER_PASS_BUDGET;
+            due_after = scheduler_scan_due();
+        }, TASK_PRIORITY_LOW, 0, 0),
+    };
+    for (auto& t : tasks) scheduler_register(&t);
+    loop(1);
+    EXPECT_FALSE(due_before);
+    EXPECT_TRUE(due_after);
+}
@@ -0,0 +1,7 @@
+TEST_LIST +=\
+	tmk_common_host_mouse\
+	tmk_common_perf_counter\
+	tmk_common_action_macro\
+	tmk_common_action_macro_concurrent\
+	tmk_common_deadline\
+	tmk_common_scheduler
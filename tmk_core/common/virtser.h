@@ -1,10 +1,15 @@
 #ifndef _VIRTSER_H_
 #define _VIRTSER_H_
 
+#include <stdint.h>
+
 /* Define this function in your code to process incoming bytes */
 void virtser_recv(const uint8_t ch);
 
 /* Call this to send a character over the Virtual Serial Device */
 void virtser_send(const uint8_t byte);
 
+/* Sends length bytes in as few transfers as the endpoint allows */
+void virtser_send_packet(const uint8_t *data, uint8_t length);
+
 #endif
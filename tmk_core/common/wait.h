@@ -15,6 +15,10 @@ extern "C" {
 #   define wait_us(us) chThdSleepMicroseconds(us)
 #elif defined(__arm__) /* __AVR__ */
 #   include "wait_api.h"
+#else /* native build for unit tests */
+#   include <stdint.h>
+void wait_ms(uint32_t ms);
+#   define wait_us(us) wait_ms((us) / 1000)
 #endif /* __AVR__ */
 
 #ifdef __cplusplus
@@ -42,6 +42,7 @@
 #include "visualizer/visualizer.h"
 #endif
 #include "suspend.h"
+#include "scheduler.h"
 
 
 /* -------------------------
@@ -55,6 +56,7 @@ void send_keyboard(report_keyboard_t *report);
 void send_mouse(report_mouse_t *report);
 void send_system(uint16_t data);
 void send_consumer(uint16_t data);
+uint8_t mouse_ready(void);
 
 /* host struct */
 host_driver_t chibios_driver = {
@@ -62,7 +64,8 @@ host_driver_t chibios_driver = {
   send_keyboard,
   send_mouse,
   send_system,
-  send_consumer
+  send_consumer,
+  mouse_ready
 };
 
 
@@ -148,6 +151,9 @@ int main(void) {
   sleep_led_init();
 #endif
 
+  static scheduler_task_t scan_task = SCHEDULER_TASK(keyboard_task, TASK_PRIORITY_SCAN, 0, 2);
+  scheduler_register(&scan_task);
+
   print("Keyboard start.\n");
 
   /* Main loop */
@@ -181,6 +187,6 @@ int main(void) {
 #endif
     }
 
-    keyboard_task();
+    scheduler_run();
   }
 }
@@ -1191,10 +1191,25 @@ void send_mouse(report_mouse_t *report) {
   osalSysUnlock();
 }
 
+/* the report buffer is handed to the endpoint asynchronously, so
+ * host.c must not queue another one before the last transfer is done */
+uint8_t mouse_ready(void) {
+  uint8_t ready;
+  osalSysLock();
+  ready = usbGetDriverStateI(&USB_DRIVER) != USB_ACTIVE ||
+          !usbGetTransmitStatusI(&USB_DRIVER, MOUSE_ENDPOINT);
+  osalSysUnlock();
+  return ready;
+}
+
 #else /* MOUSE_ENABLE */
 void send_mouse(report_mouse_t *report) {
   (void)report;
 }
+
+uint8_t mouse_ready(void) {
+  return 1;
+}
 #endif /* MOUSE_ENABLE */
 
 /* ---------------------------------------------------------
@@ -54,6 +54,7 @@
 #include "quantum.h"
 #include <util/atomic.h>
 #include "outputselect.h"
+#include "scheduler.h"
 
 #ifdef NKRO_ENABLE
   #include "keycode_config.h"
@@ -90,6 +91,10 @@
 	#include "raw_hid.h"
 #endif
 
+#ifdef PERF_COUNTER_ENABLE
+	#include "perf_counter.h"
+#endif
+
 uint8_t keyboard_idle = 0;
 /* 0: Boot Protocol, 1: Report Protocol(default) */
 uint8_t keyboard_protocol = 1;
@@ -109,6 +114,7 @@ static void send_keyboard(report_keyboard_t *report);
 static void send_mouse(report_mouse_t *report);
 static void send_system(uint16_t data);
 static void send_consumer(uint16_t data);
+static uint8_t mouse_ready(void);
 host_driver_t lufa_driver = {
     keyboard_leds,
     send_keyboard,
@@ -118,8 +124,9 @@ host_driver_t lufa_driver = {
 #ifdef MIDI_ENABLE
     usb_send_func,
     usb_get_midi,
-    midi_usb_init
+    midi_usb_init,
 #endif
+    mouse_ready
 };
 
 /*******************************************************************************
@@ -254,6 +261,13 @@ static void raw_hid_task(void)
 
 		if ( data_read )
 		{
+#ifdef PERF_COUNTER_ENABLE
+			if ( perf_counters_raw_hid( data, sizeof(data) ) )
+			{
+				raw_hid_send( data, sizeof(data) );
+				return;
+			}
+#endif
 			raw_hid_receive( data, sizeof(data) );
 		}
 	}
@@ -703,6 +717,23 @@ static void send_mouse(report_mouse_t *report)
 #endif
 }
 
+static uint8_t mouse_ready(void)
+{
+#ifdef MOUSE_ENABLE
+    uint8_t where = where_to_send();
+
+    if (where != OUTPUT_USB && where != OUTPUT_USB_AND_BT) {
+      return 1;
+    }
+
+    /* Let host.c accumulate motion instead of blocking in send_mouse() */
+    Endpoint_SelectEndpoint(MOUSE_IN_EPNUM);
+    return Endpoint_IsReadWriteAllowed();
+#else
+    return 1;
+#endif
+}
+
 static void send_system(uint16_t data)
 {
     uint8_t timeout = 255;
@@ -853,6 +884,38 @@ int8_t sendchar(uint8_t c)
  ******************************************************************************/
 
 #ifdef MIDI_ENABLE
+#if MIDI_TX_SIZE != MIDI_STREAM_EPSIZE
+#error "MIDI_TX_SIZE has to be the MIDI IN endpoint size"
+#endif
+
+static midi_tx_t midi_tx;
+
+/* sends the queued packets in one transfer, waiting for the endpoint only
+ * when asked to. They are dropped if the device is not configured */
+static void usb_midi_flush(bool wait) {
+  if (midi_tx.length == 0)
+    return;
+
+  if (USB_DeviceState != DEVICE_STATE_Configured) {
+    midi_tx.dropped += midi_tx.length / MIDI_TX_PACKET_SIZE;
+    midi_tx_sent(&midi_tx);
+    return;
+  }
+
+  uint8_t ep = Endpoint_GetCurrentEndpoint();
+  Endpoint_SelectEndpoint(MIDI_STREAM_IN_EPADDR);
+  if (Endpoint_IsINReady() || (wait && Endpoint_WaitUntilReady() == ENDPOINT_READYWAIT_NoError)) {
+    Endpoint_Write_Stream_LE(midi_tx.data, midi_tx.length, NULL);
+    Endpoint_ClearIN();
+    midi_tx_sent(&midi_tx);
+  }
+  Endpoint_SelectEndpoint(ep);
+}
+
+uint16_t midi_tx_dropped(void) {
+  return midi_tx.dropped;
+}
+
 static void usb_send_func(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint8_t byte1, uint8_t byte2) {
   MIDI_EventPacket_t event;
   event.Data1 = byte0;
@@ -904,13 +967,10 @@ static void usb_send_func(MidiDevice * device, uint16_t cnt, uint8_t byte0, uint
     }
   }
 
-// Endpoint_Write_Stream_LE(&event, sizeof(event), NULL);
-// Endpoint_ClearIN();
-
-  MIDI_Device_SendEventPacket(&USB_MIDI_Interface, &event);
-  MIDI_Device_Flush(&USB_MIDI_Interface);
-  MIDI_Device_USBTask(&USB_MIDI_Interface);
-  USB_USBTask();
+  // a burst like a sysex message goes out every 16 packets
+  if (midi_tx_full(&midi_tx))
+    usb_midi_flush(true);
+  midi_tx_push(&midi_tx, (const uint8_t *)&event);
 }
 
 static void usb_get_midi(MidiDevice * device) {
@@ -1050,7 +1110,11 @@ void virtser_task(void)
 }
 void virtser_send(const uint8_t byte)
 {
-  uint8_t timeout = 255;
+  virtser_send_packet(&byte, 1);
+}
+
+void virtser_send_packet(const uint8_t *data, uint8_t length)
+{
   uint8_t ep = Endpoint_GetCurrentEndpoint();
 
   if (cdc_device.State.ControlLineStates.HostToDevice & CDC_CONTROL_LINE_OUT_DTR)
@@ -1063,9 +1127,16 @@ void virtser_send(const uint8_t byte)
         return;
     }
 
-    while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
-
-    Endpoint_Write_8(byte);
+    for (uint8_t i = 0; i < length; i++) {
+      uint8_t timeout = 255;
+      if (i && !Endpoint_IsReadWriteAllowed()) {
+        /* bank full, send what we have */
+        CDC_Device_Flush(&cdc_device);
+      }
+      while (timeout-- && !Endpoint_IsReadWriteAllowed()) _delay_us(40);
+      Endpoint_Write_8(data[i]);
+    }
+    /* all in one transfer */
     CDC_Device_Flush(&cdc_device);
 
     if (Endpoint_IsINReady()) {
@@ -1122,9 +1193,56 @@ void setup_midi(void)
 	midi_device_init(&midi_device);
     midi_device_set_send_func(&midi_device, usb_send_func);
     midi_device_set_pre_input_process_func(&midi_device, usb_get_midi);
+    midi_tx_init(&midi_tx);
+}
+#endif
+
+#ifdef MIDI_ENABLE
+static void midi_process_task(void)
+{
+    midi_device_process(&midi_device);
+#ifdef MIDI_ADVANCED
+    midi_task();
+#endif
+    if (midi_tx_due(&midi_tx))
+        usb_midi_flush(false);
 }
 #endif
 
+#ifdef VIRTSER_ENABLE
+static void virtser_usb_task(void)
+{
+    virtser_task();
+    CDC_Device_USBTask(&cdc_device);
+}
+#endif
+
+/* main loop tasks, see scheduler.h */
+static scheduler_task_t main_tasks[] = {
+    SCHEDULER_TASK(keyboard_task, TASK_PRIORITY_SCAN, 0, 2),
+#if !defined(INTERRUPT_CONTROL_ENDPOINT)
+    SCHEDULER_TASK(USB_USBTask, TASK_PRIORITY_USB, 0, 1),
+#endif
+#ifdef MIDI_ENABLE
+    SCHEDULER_TASK(midi_process_task, TASK_PRIORITY_HIGH, 0, 1),
+#endif
+#ifdef MODULE_ADAFRUIT_BLE
+    SCHEDULER_TASK(adafruit_ble_task, TASK_PRIORITY_HIGH, 0, 1),
+#endif
+#ifdef VIRTSER_ENABLE
+    SCHEDULER_TASK(virtser_usb_task, TASK_PRIORITY_HIGH, 0, 1),
+#endif
+#ifdef RAW_ENABLE
+    SCHEDULER_TASK(raw_hid_task, TASK_PRIORITY_HIGH, 0, 1),
+#endif
+#if defined(RGBLIGHT_ANIMATIONS) & defined(RGBLIGHT_ENABLE)
+    SCHEDULER_TASK(rgblight_task, TASK_PRIORITY_LOW, 0, 1),
+#endif
+#if defined(RGBLIGHT_REACTIVE) & defined(RGBLIGHT_ENABLE)
+    SCHEDULER_TASK(rgblight_reactive_task, TASK_PRIORITY_LOW, RGBLIGHT_REACTIVE_INTERVAL, 1),
+#endif
+};
+
 int main(void)  __attribute__ ((weak));
 int main(void)
 {
@@ -1178,6 +1296,10 @@ int main(void)
     virtser_init();
 #endif
 
+    for (uint8_t i = 0; i < sizeof(main_tasks) / sizeof(main_tasks[0]); i++) {
+        scheduler_register(&main_tasks[i]);
+    }
+
     print("Keyboard start.\n");
     while (1) {
         #if !defined(BLUETOOTH_ENABLE)
@@ -1190,36 +1312,7 @@ int main(void)
         }
         #endif
 
-        keyboard_task();
-
-#ifdef MIDI_ENABLE
-        midi_device_process(&midi_device);
-#ifdef MIDI_ADVANCED
-        midi_task();
-#endif
-#endif
-
-#if defined(RGBLIGHT_ANIMATIONS) & defined(RGBLIGHT_ENABLE)
-        rgblight_task();
-#endif
-
-#ifdef MODULE_ADAFRUIT_BLE
-        adafruit_ble_task();
-#endif
-
-#ifdef VIRTSER_ENABLE
-        virtser_task();
-        CDC_Device_USBTask(&cdc_device);
-#endif
-
-#ifdef RAW_ENABLE
-        raw_hid_task();
-#endif
-
-#if !defined(INTERRUPT_CONTROL_ENDPOINT)
-        USB_USBTask();
-#endif
-
+        scheduler_run();
     }
 }
 
@@ -1252,7 +1345,12 @@ void cc_callback(MidiDevice * device,
 }
 
 #ifdef API_SYSEX_ENABLE
-uint8_t midi_buffer[MIDI_SYSEX_BUFFER] = {0};
+/* Messages are decoded as they arrive, only the decoded message is stored.
+ * The header and terminator are not stored to save a few bytes of precious ram */
+static uint8_t api_buffer[API_SYSEX_MAX_SIZE];
+static uint16_t api_length;
+static bool api_overflow;
+static sysex_decoder_t api_decoder;
 #endif
 
 void sysex_callback(MidiDevice * device, uint16_t start, uint8_t length, uint8_t * data) {
@@ -1262,25 +1360,26 @@ void sysex_callback(MidiDevice * device, uint16_t start, uint8_t length, uint8_t
         // SEND_STRING(": ");
         // Don't store the header
         int16_t pos = start - 4;
+        if (start == 0) {
+            sysex_decoder_init(&api_decoder);
+            api_length = 0;
+            api_overflow = false;
+        }
         for (uint8_t place = 0; place < length; place++) {
             // send_byte(*data);
             if (pos >= 0) {
                 if (*data == 0xF7) {
-                    // SEND_STRING("\nRD: ");
-                    // for (uint8_t i = 0; i < start + place + 1; i++){
-                    //     send_byte(midi_buffer[i]);
-                    // SEND_STRING(" ");
-                    // }
-                    const unsigned decoded_length = sysex_decoded_length(pos);
-                    uint8_t decoded[API_SYSEX_MAX_SIZE];
-                    sysex_decode(decoded, midi_buffer, pos);
-                    process_api(decoded_length, decoded);
+                    if (!api_overflow)
+                        process_api(api_length, api_buffer);
                     return;
                 }
-                else if (pos >= MIDI_SYSEX_BUFFER) {
-                    return;
+                uint8_t decoded;
+                if (sysex_decode_chunk(&api_decoder, &decoded, data, 1)) {
+                    if (api_length < API_SYSEX_MAX_SIZE)
+                        api_buffer[api_length++] = decoded;
+                    else
+                        api_overflow = true;
                 }
-                midi_buffer[pos] = *data;
             }
             // SEND_STRING(" ");
             data++;
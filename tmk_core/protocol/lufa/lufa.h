@@ -50,6 +50,7 @@
 #include "host.h"
 #ifdef MIDI_ENABLE
   #include "process_midi.h"
+  #include "midi_tx.h"
 #endif
 #ifdef __cplusplus
 extern "C" {
@@ -70,6 +71,8 @@ typedef struct {
 #ifdef MIDI_ENABLE
   void MIDI_Task(void);
   MidiDevice midi_device;
+  /* USB-MIDI packets lost because the host did not take them */
+  uint16_t midi_tx_dropped(void);
 #endif
 
 #ifdef API_ENABLE
@@ -78,9 +81,6 @@ typedef struct {
 
 #ifdef API_SYSEX_ENABLE
   #include "api_sysex.h"
-  // Allocate space for encoding overhead.
-  //The header and terminator are not stored to save a few bytes of precious ram
-  #define MIDI_SYSEX_BUFFER (API_SYSEX_MAX_SIZE + API_SYSEX_MAX_SIZE / 7 + (API_SYSEX_MAX_SIZE % 7 ? 1 : 0))
 #endif
 
 // #if LUFA_VERSION_INTEGER < 0x120730
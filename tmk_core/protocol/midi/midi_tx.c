@@ -0,0 +1,46 @@
+#include <string.h>
+#include "midi_tx.h"
+#include "timer.h"
+
+#if MIDI_TX_SIZE % MIDI_TX_PACKET_SIZE != 0 || MIDI_TX_SIZE > 255
+#error "MIDI_TX_SIZE has to be a multiple of 4 packet bytes below 256"
+#endif
+
+void midi_tx_init(midi_tx_t *tx)
+{
+    tx->length = 0;
+    tx->first = 0;
+    tx->dropped = 0;
+}
+
+bool midi_tx_push(midi_tx_t *tx, const uint8_t packet[MIDI_TX_PACKET_SIZE])
+{
+    if (midi_tx_full(tx)) {
+        tx->dropped++;
+        return false;
+    }
+    if (tx->length == 0) {
+        tx->first = timer_read();
+    }
+    memcpy(&tx->data[tx->length], packet, MIDI_TX_PACKET_SIZE);
+    tx->length += MIDI_TX_PACKET_SIZE;
+    return true;
+}
+
+bool midi_tx_full(const midi_tx_t *tx)
+{
+    return tx->length == MIDI_TX_SIZE;
+}
+
+bool midi_tx_due(const midi_tx_t *tx)
+{
+    if (tx->length == 0) {
+        return false;
+    }
+    return midi_tx_full(tx) || timer_elapsed(tx->first) >= MIDI_TX_DEADLINE;
+}
+
+void midi_tx_sent(midi_tx_t *tx)
+{
+    tx->length = 0;
+}
@@ -0,0 +1,54 @@
+#ifndef MIDI_TX_H
+#define MIDI_TX_H
+
+#include <stdint.h>
+#include <stdbool.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*
+ * Packs USB-MIDI event packets into one bulk transfer instead of sending
+ * each 4 byte packet on its own. The transfer goes out once it is full or
+ * once its first packet has waited MIDI_TX_DEADLINE ms, so a burst like a
+ * sysex message takes a transfer per 16 packets and a single note still
+ * leaves within a frame or two.
+ */
+
+/* code index byte and three MIDI bytes */
+#define MIDI_TX_PACKET_SIZE 4
+
+/* bytes in a transfer, the size of the IN endpoint */
+#ifndef MIDI_TX_SIZE
+#define MIDI_TX_SIZE 64
+#endif
+
+/* longest time(ms) a packet waits for the transfer to fill up */
+#ifndef MIDI_TX_DEADLINE
+#define MIDI_TX_DEADLINE 1
+#endif
+
+typedef struct {
+    uint8_t data[MIDI_TX_SIZE];
+    uint8_t length;
+    /* timer_read() when the first packet was queued */
+    uint16_t first;
+    /* packets that did not fit because the transfer could not go out */
+    uint16_t dropped;
+} midi_tx_t;
+
+void midi_tx_init(midi_tx_t *tx);
+/* false and counted in dropped if the transfer is full */
+bool midi_tx_push(midi_tx_t *tx, const uint8_t packet[MIDI_TX_PACKET_SIZE]);
+bool midi_tx_full(const midi_tx_t *tx);
+/* the transfer is full or has waited long enough */
+bool midi_tx_due(const midi_tx_t *tx);
+/* empties the transfer once its length bytes of data went out */
+void midi_tx_sent(midi_tx_t *tx);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
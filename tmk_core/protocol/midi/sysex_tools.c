@@ -97,3 +97,56 @@ uint16_t sysex_decode(uint8_t *decoded, const uint8_t *source, const uint16_t le
    }
 }
 
+
+void sysex_encoder_init(sysex_encoder_t *encoder){
+   encoder->group[0] = 0;
+   encoder->count = 0;
+}
+
+uint16_t sysex_encode_chunk(sysex_encoder_t *encoder, uint8_t *encoded, const uint8_t *source, const uint16_t length){
+   uint16_t written = 0;
+   uint16_t i,j;
+
+   for(i = 0; i < length; i++) {
+      uint8_t current = source[i];
+      encoder->group[0] |= (0x80 & current) >> (1 + encoder->count);
+      encoder->group[1 + encoder->count] = 0x7F & current;
+      if (++encoder->count == 7) {
+         for(j = 0; j < 8; j++)
+            encoded[written++] = encoder->group[j];
+         sysex_encoder_init(encoder);
+      }
+   }
+   return written;
+}
+
+uint8_t sysex_encode_finish(sysex_encoder_t *encoder, uint8_t *encoded){
+   uint8_t length = encoder->count ? encoder->count + 1 : 0;
+   uint8_t j;
+
+   for(j = 0; j < length; j++)
+      encoded[j] = encoder->group[j];
+   sysex_encoder_init(encoder);
+   return length;
+}
+
+void sysex_decoder_init(sysex_decoder_t *decoder){
+   decoder->msbs = 0;
+   decoder->position = 0;
+}
+
+uint16_t sysex_decode_chunk(sysex_decoder_t *decoder, uint8_t *decoded, const uint8_t *source, const uint16_t length){
+   uint16_t written = 0;
+   uint16_t i;
+
+   for(i = 0; i < length; i++) {
+      if (decoder->position == 0) {
+         //the top bits of the next 7 bytes
+         decoder->msbs = source[i];
+      } else {
+         decoded[written++] = (0x7F & source[i]) | (0x80 & (decoder->msbs << decoder->position));
+      }
+      decoder->position = (decoder->position + 1) % 8;
+   }
+   return written;
+}
@@ -86,6 +86,76 @@ uint16_t sysex_encode(uint8_t *encoded, const uint8_t *source, uint16_t length);
  */
 uint16_t sysex_decode(uint8_t *decoded, const uint8_t *source, uint16_t length);
 
+/**
+ * @brief State of a message that is encoded a chunk at a time.
+ *
+ * The group of up to 7 bytes that is not complete yet is kept in its encoded
+ * form, so the memory used does not depend on the length of the message.
+ */
+typedef struct {
+   uint8_t group[8];
+   uint8_t count;
+} sysex_encoder_t;
+
+/**
+ * @brief State of a message that is decoded a chunk at a time.
+ */
+typedef struct {
+   uint8_t msbs;
+   uint8_t position;
+} sysex_decoder_t;
+
+/**
+ * @brief Start encoding a new message.
+ */
+void sysex_encoder_init(sysex_encoder_t *encoder);
+
+/**
+ * @brief Encode the next chunk of a message.
+ *
+ * Only complete groups of 8 bytes are written, the rest is kept for the next
+ * chunk. The chunks together give the same data as sysex_encode() on the whole
+ * message once sysex_encode_finish() has written the end.
+ *
+ * @param encoder The state of the message.
+ * @param encoded The output data buffer, 8 bytes hold the output of any chunk of up to 7 bytes.
+ * @param source The input buffer of data to be encoded.
+ * @param length The number of bytes from the input buffer to encode.
+ *
+ * @return number of bytes written to encoded.
+ */
+uint16_t sysex_encode_chunk(sysex_encoder_t *encoder, uint8_t *encoded, const uint8_t *source, uint16_t length);
+
+/**
+ * @brief Write the last incomplete group of a message.
+ *
+ * @param encoder The state of the message.
+ * @param encoded The output data buffer, at least 8 bytes long.
+ *
+ * @return number of bytes written to encoded, 0 if the groups were all complete.
+ */
+uint8_t sysex_encode_finish(sysex_encoder_t *encoder, uint8_t *encoded);
+
+/**
+ * @brief Start decoding a new message.
+ */
+void sysex_decoder_init(sysex_decoder_t *decoder);
+
+/**
+ * @brief Decode the next chunk of an encoded message.
+ *
+ * The chunks may split the groups of 8 bytes anywhere, together they give the
+ * same data as sysex_decode() on the whole message.
+ *
+ * @param decoder The state of the message.
+ * @param decoded The output data buffer, must be at least length bytes long.
+ * @param source The input buffer of data to be decoded.
+ * @param length The number of bytes from the input buffer to decode.
+ *
+ * @return number of bytes decoded.
+ */
+uint16_t sysex_decode_chunk(sysex_decoder_t *decoder, uint8_t *decoded, const uint8_t *source, uint16_t length);
+
 /**@}*/
 
 #ifdef __cplusplus
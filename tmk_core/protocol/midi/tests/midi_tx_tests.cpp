@@ -0,0 +1,99 @@
+#include "gtest/gtest.h"
+#include <vector>
+extern "C" {
+#include "midi_tx.h"
+#include "timer.h"
+}
+
+static uint16_t now;
+
+extern "C" {
+    uint16_t timer_read(void) {
+        return now;
+    }
+
+    uint16_t timer_elapsed(uint16_t last) {
+        return TIMER_DIFF_16(now, last);
+    }
+}
+
+class MidiTx : public ::testing::Test {
+public:
+    MidiTx() {
+        now = 1000;
+        midi_tx_init(&tx);
+    }
+
+    bool push(uint8_t n) {
+        uint8_t packet[MIDI_TX_PACKET_SIZE] = {0x09, 0x90, n, 0x7F};
+        return midi_tx_push(&tx, packet);
+    }
+
+    midi_tx_t tx;
+};
+
+TEST_F(MidiTx, starts_empty) {
+    EXPECT_EQ(tx.length, 0);
+    EXPECT_FALSE(midi_tx_due(&tx));
+    now += 100;
+    EXPECT_FALSE(midi_tx_due(&tx));
+}
+
+TEST_F(MidiTx, packs_packets_in_order) {
+    for (uint8_t n = 0; n < 3; n++) {
+        EXPECT_TRUE(push(n));
+    }
+    ASSERT_EQ(tx.length, 3 * MIDI_TX_PACKET_SIZE);
+    const uint8_t expected[] = {
+        0x09, 0x90, 0, 0x7F,
+        0x09, 0x90, 1, 0x7F,
+        0x09, 0x90, 2, 0x7F,
+    };
+    EXPECT_EQ(std::vector<uint8_t>(tx.data, tx.data + tx.length),
+              std::vector<uint8_t>(expected, expected + sizeof(expected)));
+}
+
+TEST_F(MidiTx, sends_after_the_deadline_of_the_first_packet) {
+    push(0);
+    EXPECT_FALSE(midi_tx_due(&tx));
+    now += MIDI_TX_DEADLINE - 1;
+    // later packets do not push the deadline out
+    push(1);
+    EXPECT_FALSE(midi_tx_due(&tx));
+    now += 1;
+    EXPECT_TRUE(midi_tx_due(&tx));
+
+    midi_tx_sent(&tx);
+    EXPECT_EQ(tx.length, 0);
+    EXPECT_FALSE(midi_tx_due(&tx));
+    now += 50;
+    push(2);
+    EXPECT_FALSE(midi_tx_due(&tx));
+}
+
+TEST_F(MidiTx, sends_a_full_transfer_at_once) {
+    for (uint8_t n = 0; n < MIDI_TX_SIZE / MIDI_TX_PACKET_SIZE; n++) {
+        EXPECT_FALSE(midi_tx_full(&tx));
+        EXPECT_FALSE(midi_tx_due(&tx));
+        EXPECT_TRUE(push(n));
+    }
+    EXPECT_TRUE(midi_tx_full(&tx));
+    EXPECT_TRUE(midi_tx_due(&tx));
+    EXPECT_EQ(tx.length, MIDI_TX_SIZE);
+}
+
+TEST_F(MidiTx, counts_packets_that_do_not_fit) {
+    for (uint8_t n = 0; n < MIDI_TX_SIZE / MIDI_TX_PACKET_SIZE; n++) {
+        push(n);
+    }
+    EXPECT_FALSE(push(100));
+    EXPECT_FALSE(push(101));
+    EXPECT_EQ(tx.dropped, 2);
+    // the queued packets are untouched
+    EXPECT_EQ(tx.data[MIDI_TX_SIZE - 2], MIDI_TX_SIZE / MIDI_TX_PACKET_SIZE - 1);
+
+    midi_tx_sent(&tx);
+    EXPECT_TRUE(push(102));
+    EXPECT_EQ(tx.data[2], 102);
+    EXPECT_EQ(tx.dropped, 2);
+}
@@ -0,0 +1,11 @@
+MIDI_PATH := $(TMK_PATH)/protocol/midi
+
+midi_tx_SRC :=\
+	$(MIDI_PATH)/tests/midi_tx_tests.cpp \
+	$(MIDI_PATH)/midi_tx.c
+midi_tx_INC := $(MIDI_PATH) $(TMK_PATH)/common
+
+sysex_tools_SRC :=\
+	$(MIDI_PATH)/tests/sysex_tools_tests.cpp \
+	$(MIDI_PATH)/sysex_tools.c
+sysex_tools_INC := $(MIDI_PATH)
@@ -0,0 +1,117 @@
+#include "gtest/gtest.h"
+#include <vector>
+extern "C" {
+#include "sysex_tools.h"
+}
+
+static std::vector<uint8_t> message(unsigned length) {
+    std::vector<uint8_t> bytes;
+    for (unsigned i = 0; i < length; i++) {
+        bytes.push_back(i * 37 + (i >> 3));
+    }
+    return bytes;
+}
+
+static std::vector<uint8_t> encode(const std::vector<uint8_t> &bytes) {
+    std::vector<uint8_t> encoded(sysex_encoded_length(bytes.size()));
+    encoded.resize(sysex_encode(encoded.data(), bytes.data(), bytes.size()));
+    return encoded;
+}
+
+/* encodes chunk bytes at a time into a buffer that only holds a group */
+static std::vector<uint8_t> encode_chunks(const std::vector<uint8_t> &bytes, unsigned chunk) {
+    sysex_encoder_t encoder;
+    sysex_encoder_init(&encoder);
+    std::vector<uint8_t> encoded;
+    uint8_t group[8];
+    for (size_t i = 0; i < bytes.size(); i += chunk) {
+        uint16_t length = std::min<size_t>(chunk, bytes.size() - i);
+        uint16_t written = sysex_encode_chunk(&encoder, group, &bytes[i], length);
+        EXPECT_TRUE(written == 0 || written == 8);
+        encoded.insert(encoded.end(), group, group + written);
+    }
+    uint8_t written = sysex_encode_finish(&encoder, group);
+    encoded.insert(encoded.end(), group, group + written);
+    return encoded;
+}
+
+static std::vector<uint8_t> decode_chunks(const std::vector<uint8_t> &encoded, unsigned chunk) {
+    sysex_decoder_t decoder;
+    sysex_decoder_init(&decoder);
+    std::vector<uint8_t> decoded;
+    for (size_t i = 0; i < encoded.size(); i += chunk) {
+        uint16_t length = std::min<size_t>(chunk, encoded.size() - i);
+        uint8_t out[16];
+        uint16_t written = sysex_decode_chunk(&decoder, out, &encoded[i], length);
+        EXPECT_LE(written, length);
+        decoded.insert(decoded.end(), out, out + written);
+    }
+    return decoded;
+}
+
+TEST(SysexTools, encodes_a_group_with_the_top_bits_first) {
+    const uint8_t bytes[] = {0x80, 0x01, 0xFF, 0x7F, 0x00, 0x00, 0x81};
+    sysex_encoder_t encoder;
+    sysex_encoder_init(&encoder);
+    uint8_t encoded[8];
+    ASSERT_EQ(sysex_encode_chunk(&encoder, encoded, bytes, sizeof(bytes)), 8);
+    const uint8_t expected[] = {0x51, 0x00, 0x01, 0x7F, 0x7F, 0x00, 0x00, 0x01};
+    EXPECT_EQ(std::vector<uint8_t>(encoded, encoded + 8), std::vector<uint8_t>(expected, expected + 8));
+    EXPECT_EQ(sysex_encode_finish(&encoder, encoded), 0);
+}
+
+TEST(SysexTools, chunks_encode_like_the_whole_message) {
+    for (unsigned length : {0, 1, 6, 7, 8, 13, 14, 15, 100, 1000}) {
+        std::vector<uint8_t> bytes = message(length);
+        for (unsigned chunk : {1, 2, 3, 7}) {
+            std::vector<uint8_t> encoded = encode_chunks(bytes, chunk);
+            ASSERT_EQ(encoded, encode(bytes)) << "length " << length << " chunk " << chunk;
+            for (uint8_t b : encoded) {
+                ASSERT_LT(b, 0x80);
+            }
+        }
+    }
+}
+
+TEST(SysexTools, chunks_decode_like_the_whole_message) {
+    for (unsigned length : {0, 1, 6, 7, 8, 13, 14, 15, 100, 1000}) {
+        std::vector<uint8_t> encoded = encode(message(length));
+        std::vector<uint8_t> decoded(sysex_decoded_length(encoded.size()));
+        decoded.resize(sysex_decode(decoded.data(), encoded.data(), encoded.size()));
+        for (unsigned chunk : {1, 3, 5, 8, 16}) {
+            ASSERT_EQ(decode_chunks(encoded, chunk), decoded) << "length " << length << " chunk " << chunk;
+        }
+    }
+}
+
+TEST(SysexTools, round_trips_in_chunks) {
+    for (unsigned length : {1, 2, 7, 20, 64, 1000, 4096}) {
+        std::vector<uint8_t> bytes = message(length);
+        std::vector<uint8_t> encoded = encode_chunks(bytes, 7);
+        EXPECT_EQ(encoded.size(), sysex_encoded_length(length));
+        // midi packets carry 3 bytes at a time
+        EXPECT_EQ(decode_chunks(encoded, 3), bytes) << "length " << length;
+    }
+}
+
+TEST(SysexTools, starts_over_after_init) {
+    sysex_encoder_t encoder;
+    sysex_encoder_init(&encoder);
+    uint8_t encoded[8];
+    const uint8_t bytes[] = {0xAA, 0xBB, 0xCC};
+    sysex_encode_chunk(&encoder, encoded, bytes, sizeof(bytes));
+    ASSERT_EQ(sysex_encode_finish(&encoder, encoded), 4);
+    // finish leaves the encoder ready for the next message
+    ASSERT_EQ(sysex_encode_chunk(&encoder, encoded, bytes, 1), 0);
+    ASSERT_EQ(sysex_encode_finish(&encoder, encoded), 2);
+    EXPECT_EQ(encoded[0], 0x40);
+    EXPECT_EQ(encoded[1], 0x2A);
+
+    sysex_decoder_t decoder;
+    sysex_decoder_init(&decoder);
+    uint8_t decoded[8];
+    ASSERT_EQ(sysex_decode_chunk(&decoder, decoded, encoded, 1), 0);
+    sysex_decoder_init(&decoder);
+    ASSERT_EQ(sysex_decode_chunk(&decoder, decoded, encoded, 2), 1);
+    EXPECT_EQ(decoded[0], 0xAA);
+}
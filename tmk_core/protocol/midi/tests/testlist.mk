@@ -0,0 +1,3 @@
+TEST_LIST +=\
+	midi_tx \
+	sysex_tools
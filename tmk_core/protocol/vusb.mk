@@ -4,6 +4,7 @@ OPT_DEFS += -DPROTOCOL_VUSB
 
 SRC +=	$(VUSB_DIR)/main.c \
 	$(VUSB_DIR)/vusb.c \
+	$(VUSB_DIR)/vusb_slice.c \
 	$(VUSB_DIR)/usbdrv/usbdrv.c \
 	$(VUSB_DIR)/usbdrv/usbdrvasm.S \
 	$(VUSB_DIR)/usbdrv/oddebug.c
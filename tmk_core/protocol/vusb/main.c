@@ -15,11 +15,13 @@
 #include "usbdrv.h"
 #include "oddebug.h"
 #include "vusb.h"
+#include "vusb_slice.h"
 #include "keyboard.h"
 #include "host.h"
 #include "timer.h"
 #include "uart.h"
 #include "debug.h"
+#include "scheduler.h"
 
 
 #define UART_BAUD_RATE 115200
@@ -41,6 +43,20 @@ static void initForUsbConnectivity(void)
     sei();
 }
 
+static void keyboard_slice_task(void)
+{
+    // TODO: configuration process is incosistent. it sometime fails.
+    // To prevent failing to configure NOT scan keyboard during configuration
+    if (usbConfiguration && usbInterruptIsReady()) {
+        vusb_keyboard_slice();
+    }
+}
+
+static scheduler_task_t main_tasks[] = {
+    SCHEDULER_TASK(keyboard_slice_task, TASK_PRIORITY_SCAN, 0, 2),
+    SCHEDULER_TASK(vusb_transfer_keyboard, TASK_PRIORITY_USB, 0, 1),
+};
+
 int main(void)
 {
     bool suspended = false;
@@ -59,6 +75,9 @@ int main(void)
 
     keyboard_init();
     host_set_driver(vusb_driver());
+    for (uint8_t i = 0; i < sizeof(main_tasks) / sizeof(main_tasks[0]); i++) {
+        scheduler_register(&main_tasks[i]);
+    }
 
     debug("initForUsbConnectivity()\n");
     initForUsbConnectivity();
@@ -91,14 +110,8 @@ int main(void)
         }
 #endif
         if (!suspended) {
-            usbPoll();
-
-            // TODO: configuration process is incosistent. it sometime fails.
-            // To prevent failing to configure NOT scan keyboard during configuration
-            if (usbConfiguration && usbInterruptIsReady()) {
-                keyboard_task();
-            }
-            vusb_transfer_keyboard();
+            vusb_poll();
+            scheduler_run();
         }
     }
 }
@@ -0,0 +1,7 @@
+VUSB_PATH := $(TMK_PATH)/protocol/vusb
+
+# tests/usbdrv.h stands in for the real driver header
+vusb_slice_SRC :=\
+	$(VUSB_PATH)/tests/vusb_slice_tests.cpp \
+	$(VUSB_PATH)/vusb_slice.c
+vusb_slice_INC := $(VUSB_PATH)/tests $(VUSB_PATH) $(TMK_PATH)/common
@@ -0,0 +1,14 @@
+#ifndef USBDRV_H
+#define USBDRV_H
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+void usbPoll(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
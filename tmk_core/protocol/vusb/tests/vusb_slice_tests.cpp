@@ -0,0 +1,111 @@
+#include "gtest/gtest.h"
+#include <vector>
+extern "C" {
+#include "vusb_slice.h"
+#include "timer.h"
+}
+
+class VusbSlice : public ::testing::Test {
+public:
+    VusbSlice() {
+        Instance = this;
+        now = 1000;
+        step = 0;
+        cycles = 0;
+        step_cost = {0, 0, 0};
+    }
+
+    ~VusbSlice() {
+        Instance = nullptr;
+    }
+
+    /* keyboard_task_step() has three steps: scan, process, peripherals */
+    bool keyboard_task_step() {
+        now += step_cost[step];
+        step = (step + 1) % 3;
+        if (step == 0) {
+            cycles++;
+            return true;
+        }
+        return false;
+    }
+
+    uint16_t now;
+    unsigned step;
+    unsigned cycles;
+    std::vector<uint16_t> step_cost;
+    std::vector<uint16_t> polls;
+
+    static VusbSlice* Instance;
+};
+
+VusbSlice* VusbSlice::Instance = nullptr;
+
+extern "C" {
+    void usbPoll(void) {
+        VusbSlice::Instance->polls.push_back(VusbSlice::Instance->now);
+    }
+
+    bool keyboard_task_step(void) {
+        return VusbSlice::Instance->keyboard_task_step();
+    }
+
+    uint16_t timer_read(void) {
+        return VusbSlice::Instance->now;
+    }
+
+    uint16_t timer_elapsed(uint16_t last) {
+        return TIMER_DIFF_16(VusbSlice::Instance->now, last);
+    }
+}
+
+TEST_F(VusbSlice, runs_a_whole_cheap_cycle_with_polls_between_steps) {
+    vusb_keyboard_slice();
+    EXPECT_EQ(cycles, 1);
+    EXPECT_EQ(step, 0);
+    EXPECT_EQ(polls.size(), 2);
+}
+
+TEST_F(VusbSlice, yields_when_the_budget_is_used_up) {
+    step_cost = {VUSB_SLICE_BUDGET, 0, 0};
+    vusb_keyboard_slice();
+    EXPECT_EQ(cycles, 0);
+    EXPECT_EQ(step, 1);
+    EXPECT_EQ(polls.size(), 1);
+    vusb_keyboard_slice();
+    EXPECT_EQ(cycles, 1);
+    EXPECT_EQ(step, 0);
+}
+
+TEST_F(VusbSlice, polls_right_after_an_expensive_step) {
+    step_cost = {0, 30, 30};
+    vusb_poll();
+    uint16_t missed = vusb_missed_polls();
+    vusb_keyboard_slice();
+    vusb_poll();
+    vusb_keyboard_slice();
+    ASSERT_EQ(polls.size(), 4);
+    for (size_t i = 1; i < polls.size(); i++) {
+        EXPECT_LE(polls[i] - polls[i - 1], VUSB_POLL_DEADLINE);
+    }
+    EXPECT_EQ(vusb_missed_polls(), missed);
+}
+
+TEST_F(VusbSlice, counts_missed_poll_windows) {
+    step_cost = {0, VUSB_POLL_DEADLINE + 1, 0};
+    vusb_poll();
+    uint16_t missed = vusb_missed_polls();
+    vusb_keyboard_slice();
+    EXPECT_EQ(vusb_missed_polls(), missed + 1);
+    vusb_poll();
+    EXPECT_EQ(vusb_missed_polls(), missed + 1);
+}
+
+TEST_F(VusbSlice, handles_timer_wraparound) {
+    now = UINT16_MAX - 1;
+    step_cost = {1, 2, 1};
+    vusb_poll();
+    vusb_keyboard_slice();
+    EXPECT_EQ(step, 2);
+    EXPECT_EQ(cycles, 0);
+}
@@ -25,6 +25,7 @@ along with this program.  If not, see <http://www.gnu.org/licenses/>.
 #include "print.h"
 #include "debug.h"
 #include "host_driver.h"
+#include "vusb_slice.h"
 #include "vusb.h"
 #include "bootloader.h"
 
@@ -71,13 +72,15 @@ static void send_keyboard(report_keyboard_t *report);
 static void send_mouse(report_mouse_t *report);
 static void send_system(uint16_t data);
 static void send_consumer(uint16_t data);
+static uint8_t mouse_ready(void);
 
 static host_driver_t driver = {
         keyboard_leds,
         send_keyboard,
         send_mouse,
         send_system,
-        send_consumer
+        send_consumer,
+        mouse_ready
 };
 
 host_driver_t *vusb_driver(void)
@@ -100,7 +103,7 @@ static void send_keyboard(report_keyboard_t *report)
     }
 
     // NOTE: send key strokes of Macro
-    usbPoll();
+    vusb_poll();
     vusb_transfer_keyboard();
 }
 
@@ -121,6 +124,11 @@ static void send_mouse(report_mouse_t *report)
     }
 }
 
+static uint8_t mouse_ready(void)
+{
+    return usbInterruptIsReady3();
+}
+
 
 typedef struct {
     uint8_t  report_id;
@@ -0,0 +1,38 @@
+#include <stdbool.h>
+#include "usbdrv.h"
+#include "keyboard.h"
+#include "timer.h"
+#include "vusb_slice.h"
+
+
+static bool polled = false;
+static uint16_t last_poll = 0;
+static uint16_t missed_polls = 0;
+
+void vusb_poll(void)
+{
+    if (polled && timer_elapsed(last_poll) > VUSB_POLL_DEADLINE) {
+        if (missed_polls < UINT16_MAX) missed_polls++;
+    }
+    usbPoll();
+    polled = true;
+    last_poll = timer_read();
+}
+
+void vusb_keyboard_slice(void)
+{
+    uint16_t start = timer_read();
+
+    while (!keyboard_task_step()) {
+        vusb_poll();
+        if (timer_elapsed(start) >= VUSB_SLICE_BUDGET) {
+            // resume where we left off on the next call
+            return;
+        }
+    }
+}
+
+uint16_t vusb_missed_polls(void)
+{
+    return missed_polls;
+}
@@ -0,0 +1,31 @@
+#ifndef VUSB_SLICE_H
+#define VUSB_SLICE_H
+
+#include <stdint.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* V-USB has to see usbPoll() at least this often(ms) */
+#ifndef VUSB_POLL_DEADLINE
+#define VUSB_POLL_DEADLINE 50
+#endif
+
+/* time(ms) keyboard work may take in one pass of the main loop */
+#ifndef VUSB_SLICE_BUDGET
+#define VUSB_SLICE_BUDGET 2
+#endif
+
+/* usbPoll() wrapper that counts missed poll windows */
+void vusb_poll(void);
+/* run keyboard_task steps with usbPoll() in between, until a cycle is done
+ * or the budget is used up */
+void vusb_keyboard_slice(void);
+uint16_t vusb_missed_polls(void);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif
@@ -0,0 +1,133 @@
+#!/usr/bin/env python3
+"""Converts a WAV file to a PROGMEM sample for play_sample().
+
+The sound is mixed down to mono, resampled to the AUDIO_SAMPLE_RATE of
+the keyboard and IMA-ADPCM encoded, or kept as 8 bit PCM with --pcm8.
+See quantum/audio/sample.h for the format:
+
+    util/sample_convert.py click.wav --name click > keyboards/<kb>/keymaps/<km>/click.h
+"""
+import argparse
+import os
+import re
+import struct
+import sys
+import wave
+
+STEPS = [
+    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45,
+    50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143, 157, 173, 190, 209, 230,
+    253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963,
+    1060, 1166, 1282, 1411, 1552, 1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327,
+    3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442,
+    11487, 12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794,
+    32767,
+]
+INDEX_CHANGES = [-1, -1, -1, -1, 2, 4, 6, 8]
+
+
+def read_wav(path):
+    """Mono samples from -32768 to 32767 and the rate of path."""
+    with wave.open(path, 'rb') as f:
+        channels, width, rate, count = f.getnchannels(), f.getsampwidth(), f.getframerate(), f.getnframes()
+        frames = f.readframes(count)
+    if width == 1:
+        values = [(b - 128) << 8 for b in frames]
+    elif width == 2:
+        values = list(struct.unpack('<%dh' % (len(frames) // 2), frames))
+    else:
+        raise ValueError('%s has %d bit samples, only 8 and 16 are supported' % (path, width * 8))
+    mono = [sum(values[i:i + channels]) // channels for i in range(0, len(values), channels)]
+    return mono, rate
+
+
+def resample(samples, rate, target):
+    """Linear interpolation to target samples a second."""
+    if rate == target or not samples:
+        return samples
+    count = len(samples) * target // rate
+    result = []
+    for i in range(count):
+        position = i * rate / target
+        j = int(position)
+        k = min(j + 1, len(samples) - 1)
+        result.append(round(samples[j] + (samples[k] - samples[j]) * (position - j)))
+    return result
+
+
+class Adpcm:
+    """IMA-ADPCM encoder keeping the state of the decoder in adpcm.c."""
+
+    def __init__(self):
+        self.predictor = 0
+        self.index = 0
+
+    def decode(self, code):
+        step = STEPS[self.index]
+        diff = step >> 3
+        if code & 4:
+            diff += step
+        if code & 2:
+            diff += step >> 1
+        if code & 1:
+            diff += step >> 2
+        self.predictor += -diff if code & 8 else diff
+        self.predictor = max(-32768, min(32767, self.predictor))
+        self.index = max(0, min(len(STEPS) - 1, self.index + INDEX_CHANGES[code & 7]))
+        return self.predictor
+
+    def encode(self, sample):
+        step = STEPS[self.index]
+        diff = sample - self.predictor
+        code = 0
+        if diff < 0:
+            code = 8
+            diff = -diff
+        for bit in (4, 2, 1):
+            if diff >= step:
+                code |= bit
+                diff -= step
+            step >>= 1
+        self.decode(code)
+        return code
+
+
+def encode_adpcm(samples):
+    adpcm = Adpcm()
+    codes = [adpcm.encode(s) for s in samples]
+    if len(codes) % 2:
+        codes.append(0)
+    return [codes[i] | codes[i + 1] << 4 for i in range(0, len(codes), 2)]
+
+
+def encode_pcm8(samples):
+    return [max(0, min(255, (s + 0x8000 + 0x80) >> 8)) for s in samples]
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('wav', help='WAV file of 8 or 16 bit samples')
+    parser.add_argument('--name', help='C name of the sample, the file name by default')
+    parser.add_argument('--rate', type=int, default=8000, help='AUDIO_SAMPLE_RATE of the keyboard')
+    parser.add_argument('--pcm8', action='store_true', help='8 bit PCM instead of IMA-ADPCM')
+    args = parser.parse_args()
+
+    name = args.name or re.sub(r'\W', '_', os.path.splitext(os.path.basename(args.wav))[0])
+    samples, rate = read_wav(args.wav)
+    samples = resample(samples, rate, args.rate)
+    data = encode_pcm8(samples) if args.pcm8 else encode_adpcm(samples)
+    format = 'SAMPLE_PCM8' if args.pcm8 else 'SAMPLE_ADPCM'
+
+    print('/* Generated by util/sample_convert.py from %s at %d Hz, do not edit */' % (os.path.basename(args.wav), args.rate))
+    print('static const uint8_t PROGMEM %s_data[] = {' % name)
+    for i in range(0, len(data), 12):
+        print('    ' + ', '.join('0x%02X' % b for b in data[i:i + 12]) + ',')
+    print('};')
+    print('static const audio_sample_t %s = SAMPLE(%s_data, %s, %d);' % (name, name, format, len(samples)))
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except (ValueError, wave.Error) as e:
+        sys.exit('sample_convert.py: %s' % e)
@@ -0,0 +1,148 @@
+#!/usr/bin/env python3
+"""Converts the float songs of song_list.h to the compact PROGMEM format.
+
+Every song macro in the input files becomes a NAME_DATA macro of bytes
+for SONG_DATA(NAME), see quantum/audio/song.h for the format:
+
+    util/song_convert.py quantum/audio/song_list.h > quantum/audio/song_data.h
+"""
+import argparse
+import math
+import os
+import re
+import sys
+
+HERE = os.path.dirname(os.path.abspath(__file__))
+NOTES_H = os.path.join(HERE, '..', 'quantum', 'audio', 'musical_notes.h')
+
+SAME_DURATION = 0x80
+A4 = 69
+
+
+def read_defines(path):
+    """Name to (parameters or None, body) of the #defines in path."""
+    defines = {}
+    with open(path) as f:
+        text = f.read()
+    text = re.sub(r'/\*.*?\*/', '', text, flags=re.S)
+    text = re.sub(r'//[^\n]*', '', text)
+    text = text.replace('\\\n', ' ')
+    for match in re.finditer(r'^\s*#define\s+(\w+)(\(([^)]*)\))?[ \t]*(.*)$', text, re.M):
+        name, has_params, params, body = match.groups()
+        if has_params:
+            params = [p.strip() for p in params.split(',')]
+        defines[name] = (params if has_params else None, body.strip())
+    return defines
+
+
+def split_args(text):
+    args, depth, current = [], 0, ''
+    for c in text:
+        if c == ',' and depth == 0:
+            args.append(current.strip())
+            current = ''
+            continue
+        depth += c == '('
+        depth -= c == ')'
+        current += c
+    args.append(current.strip())
+    return args
+
+
+def calls(body):
+    """(name, arguments) of the top level macro calls in body."""
+    pos = 0
+    while True:
+        match = re.compile(r'(\w+)\s*\(').search(body, pos)
+        if not match:
+            return
+        depth, end = 1, match.end()
+        while depth:
+            depth += {'(': 1, ')': -1}.get(body[end], 0)
+            end += 1
+        yield match.group(1), split_args(body[match.end():end - 1])
+        pos = end
+
+
+class Converter:
+    def __init__(self, defines):
+        self.defines = defines
+
+    def value(self, expression):
+        """Float value of an expression of numbers and defines."""
+        for _ in range(10):
+            expanded = re.sub(r'[A-Za-z_]\w*', lambda m: self.defines.get(m.group(0), (None, m.group(0)))[1], expression)
+            if expanded == expression:
+                break
+            expression = expanded
+        return float(eval(expression, {'__builtins__': {}}))
+
+    def note(self, name, duration):
+        frequency = self.value('NOTE' + name)
+        duration = int(self.value(duration))
+        if not 0 < duration < 256:
+            raise ValueError('duration %d of NOTE%s does not fit a byte' % (duration, name))
+        if frequency <= 0:
+            return 0, duration
+        midi = A4 + 12 * math.log2(frequency / 440)
+        if abs(midi - round(midi)) > 0.05 or not 0 < round(midi) < SAME_DURATION:
+            raise ValueError('NOTE%s is not a MIDI note' % name)
+        return round(midi), duration
+
+    def notes(self, body):
+        """(MIDI note, duration) of each note macro in body."""
+        for name, args in calls(body):
+            if name == 'MUSICAL_NOTE':
+                yield self.note(*args)
+                continue
+            if name not in self.defines or self.defines[name][0] is None:
+                raise ValueError('unknown note macro ' + name)
+            params, expansion = self.defines[name]
+            for param, arg in zip(params, args):
+                expansion = re.sub(r'\b%s\b' % param, arg, expansion)
+            yield from self.notes(expansion)
+
+
+def encode(notes):
+    data, last = [], None
+    for note, duration in notes:
+        if duration == last:
+            data.append(note | SAME_DURATION)
+        else:
+            data += [note, duration]
+            last = duration
+    return data
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument('songs', nargs='+', help='headers of song macros')
+    parser.add_argument('--notes', default=NOTES_H, help='musical_notes.h')
+    args = parser.parse_args()
+
+    note_defines = read_defines(args.notes)
+    print('/* Generated by util/song_convert.py from %s, do not edit */' % ', '.join(os.path.basename(s) for s in args.songs))
+    print('#ifndef SONG_DATA_H')
+    print('#define SONG_DATA_H')
+    done = set()
+    for path in args.songs:
+        song_defines = read_defines(path)
+        converter = Converter(dict(note_defines, **song_defines))
+        for name, (params, body) in song_defines.items():
+            if params is not None or name in done or '_NOTE(' not in body:
+                continue
+            data = encode(converter.notes(body))
+            print()
+            print('#define %s_DATA \\' % name)
+            lines = [', '.join('0x%02X' % b for b in data[i:i + 12]) for i in range(0, len(data), 12)]
+            print(',\\\n'.join('    ' + line for line in lines))
+            done.add(name)
+    print()
+    print('#endif')
+
+
+if __name__ == '__main__':
+    try:
+        main()
+    except ValueError as e:
+        sys.exit('song_convert.py: %s' % e)